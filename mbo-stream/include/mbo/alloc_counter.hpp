@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace mbo {
+
+// Opt-in heap allocation counting. Building with -DMBO_ALLOC_COUNT
+// (make ALLOC_COUNT=1) replaces the global operator new / delete with
+// versions that bump per-thread counters; otherwise kAllocCounting is false,
+// the counters always read zero and callers compile their bookkeeping away.
+#if defined(MBO_ALLOC_COUNT)
+constexpr bool kAllocCounting = true;
+#else
+constexpr bool kAllocCounting = false;
+#endif
+
+struct AllocCounts {
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;   // requested bytes (allocations only)
+};
+
+// Cumulative counts for the calling thread since it started.
+AllocCounts thread_alloc_counts();
+
+// Accumulates allocation deltas over a number of items (events, snapshots, ...).
+struct AllocTotals {
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;
+    uint64_t items = 0;
+
+    void add(const AllocCounts& begin, const AllocCounts& end, uint64_t n_items) {
+        allocs += end.allocs - begin.allocs;
+        frees += end.frees - begin.frees;
+        bytes += end.bytes - begin.bytes;
+        items += n_items;
+    }
+
+    double allocs_per_item() const { return items ? (double)allocs / (double)items : 0.0; }
+    double bytes_per_item() const { return items ? (double)bytes / (double)items : 0.0; }
+
+    // {"allocs":..,"frees":..,"bytes":..,"items":..,"allocs_per_item":..,"bytes_per_item":..}
+    std::string to_json() const;
+};
+
+} // namespace mbo
@@ -3,6 +3,7 @@
 #include <memory>
 #include <fstream>
 #include <string>
+#include <vector>
 
 struct AppConfig {
     // CLI
@@ -19,7 +20,83 @@ struct AppConfig {
     std::string feed_path;
 
     std::string bench_log_path;
+    // interval bench lines every N seconds while a session runs (0 => session summary only)
+    double bench_interval_s = 10.0;
     std::string pg_conninfo; // empty => disabled
+
+    // stop after N replay sessions (0 => run forever); used by bench tooling
+    int max_sessions = 0;
+
+    // hardware counters around sampled apply / every snapshot (perf_event_open)
+    bool perf_counters = false;
+    int perf_sample_every = 64;
+
+    // snapshot store implementation (see make_snapshot_store)
+    std::string snapshot_store = "shared_mutex";
+
+    // sampled TSC stage timers: time 1-in-N occurrences of each stage (0 => off)
+    int stage_sample_every = 16;
+
+    // catch-up mode (opt-in): enter above this many unread socket bytes (0 => signal off;
+    // the fixed-rate streamer writes each second as one burst, so set it above that) ...
+    int64_t catchup_backlog_bytes = 0;
+    // ... or when wall clock outruns event time by this much (real-time replay only; 0 => off)
+    int64_t catchup_lag_ms = 0;
+    // WS publish cadence while catching up (0 => nothing until caught up)
+    int catchup_publish_ms = 250;
+
+    // kernel software RX timestamps on the feed socket (recvmsg); sampled like the stage timers
+    bool rx_timestamps = true;
+
+    // per-symbol ts_recv/ts_event/ts_in_delta latency: rolling window in event time, seconds (0 => off)
+    double feed_latency_window_s = 60.0;
+
+    // thread placement (INGEST_CPUS / WS_CPUS / WRITER_CPUS lists like "2" or "4-7"; empty => unpinned)
+    std::vector<int> ingest_cpus;
+    std::vector<int> ws_cpus;
+    std::vector<int> writer_cpus;   // PG writer, bench log writer, /metrics listener
+    // SCHED_FIFO priority for the ingest thread (0 => default scheduling)
+    int ingest_rt_prio = 0;
+    // spin on a non-blocking feed socket instead of sleeping in read
+    bool busy_poll = false;
+    // SO_BUSY_POLL budget per empty read, microseconds (busy_poll only; 0 => not set)
+    int busy_poll_us = 50;
+
+    // book node arena sized for this many resting orders (0 => default heap)
+    int64_t book_arena_orders = 0;
+    std::string book_arena_pages = "thp";   // thp | hugetlb | 4k
+    bool book_arena_prefault = true;
+    bool book_arena_mlock = false;
+
+    // resume a dropped feed on the kept book ("RESUME <seq> <count>" handshake)
+    bool feed_resume = true;
+
+    // binary book checkpoint file (empty => off), written every interval by
+    // a forked child, and loaded at startup to resume instead of replaying
+    std::string checkpoint_path;
+    double checkpoint_interval_s = 60.0;
+    bool checkpoint_load = true;
+
+    // append-only journal of applied events (empty => off); replayed at
+    // startup on top of the checkpoint
+    std::string journal_dir;
+    int journal_segment_mb = 64;
+    bool journal_sync = true;
+    bool journal_recover = true;
+    // delete segments behind the oldest kept history checkpoint (needs
+    // CHECKPOINT_PATH and CHECKPOINT_KEEP > 0)
+    bool journal_prune = true;
+
+    // as-of queries: every periodic checkpoint is also kept in journal_dir
+    // (the newest checkpoint_keep of them) as a seek point for book-at-time-T
+    int checkpoint_keep = 24;
+    bool asof = true;
+
+    // Prometheus text endpoint (GET /metrics); 0 => disabled
+    int metrics_port = 0;
+
+    // latency histogram precision (significant decimal digits, 1..5)
+    int hist_digits = 3;
 };
 
 // prints usage
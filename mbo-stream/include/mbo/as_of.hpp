@@ -0,0 +1,112 @@
+#pragma once
+#include "mbo/book_checkpoint.hpp"
+#include "mbo/mbo_order_book.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mbo {
+
+// As-of reconstruction: the book as it was at time T, from the event journal
+// (JOURNAL_DIR) and the checkpoint history next to it.
+//
+// seek(T) picks the newest history checkpoint whose last record is at or
+// before T (headers only, see read_checkpoint_meta), decodes it and replays
+// the journal from its index up to the first record after T; reset markers
+// clear the book on the way, as they did live. Without a usable checkpoint it
+// replays from the start of the journal. The replay is bounded by the
+// checkpoint interval, so a query costs one decode plus at most
+// CHECKPOINT_INTERVAL_S of events.
+//
+// The reconstructed book is kept: a later seek() with T not earlier and no
+// newer checkpoint ahead of the kept book only replays the difference, so stepping forward through an incident is incremental.
+//
+// Times are ts_event. With several runs of the same feed in one journal
+// (the streamer replaying a file), T falls in the run of the chosen checkpoint.
+
+struct AsOfStats {
+    bool complete = false;        // stopped at a record after T: the book is exactly as of T
+    bool from_cache = false;      // continued from the previous seek
+    uint64_t checkpoint_index = CheckpointMeta::kNoJournalIndex;   // seek point (none: journal start)
+    uint64_t replayed = 0;        // journal records applied by this seek
+    uint64_t next_index = 0;      // first journal record not in the book
+    uint64_t last_seq = 0;        // last record in the book
+    int64_t last_ts_ns = 0;
+    double load_ms = 0;           // checkpoint pick + decode
+    double replay_ms = 0;
+};
+
+class BookAsOf {
+public:
+    explicit BookAsOf(std::string journal_dir) : dir_(std::move(journal_dir)) {}
+
+    // False + err if the journal can't be read or T predates everything kept.
+    bool seek(int64_t ts_ns, AsOfStats& st, std::string& err);
+
+    const MboOrderBook& book() const { return book_; }
+
+    // {"type":"asof","ts":..., <stats>, "book":<to_json(depth)>}
+    std::string to_json(int64_t ts_ns, int depth, const AsOfStats& st) const;
+
+private:
+    std::string dir_;
+    MboOrderBook book_;
+    bool valid_ = false;          // book_ is the journal replayed up to next_
+    uint64_t next_ = 0;
+    uint64_t last_seq_ = 0;
+    int64_t last_ts_ = 0;
+};
+
+// Parses a query time: ISO-8601 ("2025-09-24T19:30:00.123Z") or integer
+// epoch nanoseconds.
+bool parse_asof_time(const std::string& s, int64_t& ts_ns);
+
+// {"type":"asof_error","error":...}
+std::string asof_error_json(const std::string& err);
+
+// Engine side: queries run one at a time on their own thread ("mbo-asof"),
+// so neither the ingest thread nor the WS / metrics io threads replay. done()
+// gets the JSON reply on that thread (ok = false for asof_error replies); post
+// it back to the caller's executor.
+class AsOfService {
+public:
+    using Done = std::function<void(bool ok, std::string json)>;
+
+    AsOfService(std::string journal_dir, size_t max_queued = 8);
+    ~AsOfService();   // queries still queued get a "shutting down" error
+
+    AsOfService(const AsOfService&) = delete;
+    AsOfService& operator=(const AsOfService&) = delete;
+
+    // Queues a query; replies with an error at once if max_queued are waiting.
+    void submit(int64_t ts_ns, int depth, Done done);
+
+    std::thread::native_handle_type native_handle() { return thread_.native_handle(); }
+
+private:
+    struct Query {
+        int64_t ts_ns;
+        int depth;
+        Done done;
+    };
+    void run();
+
+    BookAsOf asof_;
+    size_t max_queued_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<Query> queue_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+// Process-wide service used by the WS and metrics listeners (null = off).
+void set_asof_service(AsOfService* svc);
+AsOfService* asof_service();
+
+} // namespace mbo
@@ -0,0 +1,68 @@
+#pragma once
+#include "mbo/jsonl_writer.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mbo {
+
+// JSONL appender that keeps file I/O off the caller's thread.
+//
+// write_line() appends to an in-memory batch under a short lock; a background
+// thread swaps the batch out and writes it with one ofstream write per wakeup.
+// If the batch grows past max_pending_bytes (disk stalled), new lines are
+// dropped and counted instead of blocking the caller.
+class AsyncJsonlWriter {
+public:
+    AsyncJsonlWriter() = default;
+    explicit AsyncJsonlWriter(const std::string& path, bool append = true);
+    ~AsyncJsonlWriter();
+
+    AsyncJsonlWriter(const AsyncJsonlWriter&) = delete;
+    AsyncJsonlWriter& operator=(const AsyncJsonlWriter&) = delete;
+
+    bool open(const std::string& path, bool append = true);
+    bool is_open() const { return running_; }
+    const std::string& path() const { return path_; }
+
+    // `line` is one JSON object without the trailing newline
+    void write_line(const std::string& line);
+    void write_bench(const BenchLine& b) { write_line(to_json(b)); }
+    void write_interval(const IntervalLine& l) { write_line(to_json(l)); }
+
+    // blocks until everything queued so far has been handed to the OS
+    void flush();
+
+    // flush + stop the writer thread (also done by the destructor)
+    void close();
+
+    uint64_t dropped_lines() const;
+
+    // the writer thread, for CPU pinning (valid while is_open())
+    std::thread::native_handle_type native_handle() { return thread_.native_handle(); }
+
+    size_t max_pending_bytes = 64u << 20;
+
+private:
+    void run();
+
+    std::string path_;
+    std::ofstream ofs_;
+    std::thread thread_;
+    bool running_ = false;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;       // writer wakeup
+    std::condition_variable done_cv_;  // flush() waiters
+    std::string pending_;
+    uint64_t queued_seq_ = 0;   // lines queued so far
+    uint64_t written_seq_ = 0;  // lines handed to the OS so far
+    uint64_t dropped_ = 0;
+    bool stop_ = false;
+};
+
+} // namespace mbo
@@ -0,0 +1,133 @@
+#pragma once
+#include "mbo/mbo_record.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mbo {
+
+// Offline batch replay: many files (days) x many instruments, rebuilt in
+// parallel on a WorkStealingPool.
+//
+// Each input file is one load task: it reads the file (CSV or ".mbob") into
+// MboRecords and splits them by instrument, keeping file order, then submits
+// one book task per instrument. A book task owns its instrument's book for
+// that file and applies its records in order, so per-instrument order is the
+// file order and no book is ever touched by two threads. Files are
+// independent sessions (a daily file starts from an empty book), so every
+// (file, instrument) pair is a separate task, and the pool balances them by
+// stealing: a worker that finished its own file takes book tasks spawned by
+// another worker's bigger file.
+//
+// Book tasks emit to sinks, in event-time order per task:
+//   bars       per bar interval with events: trade OHLC + volume ('T'
+//              records) and the best bid / ask at the end of the bar
+//   snapshots  top-N book (to_json) as of each snapshot boundary, taken
+//              before the first record at or after it
+//   stats      one per task at the end
+// Output is buffered per task and handed over in batches, so sinks see few,
+// large calls.
+
+struct ReplayTaskKey {
+    std::string file;
+    int32_t instrument_id = 0;
+    std::string symbol;
+};
+
+struct ReplayBar {
+    int64_t start_ns = 0;          // bar open (event time, multiple of bar_ns)
+    int64_t open = 0, high = 0, low = 0, close = 0;   // trade prices (1e-4), 0 without trades
+    int64_t volume = 0;
+    uint32_t trades = 0;
+    uint32_t events = 0;
+    int64_t bid = 0, ask = 0;      // best bid / ask at the bar's last event, 0 if empty
+};
+
+struct ReplaySnapshot {
+    int64_t ts_ns = 0;             // snapshot boundary
+    std::string json;              // MboOrderBook::to_json(depth)
+};
+
+struct ReplayTaskStats {
+    ReplayTaskKey key;
+    uint64_t events = 0;
+    uint64_t trades = 0;
+    uint64_t bars = 0;
+    uint64_t snapshots = 0;
+    uint64_t orders = 0;           // resting at the end
+    uint64_t bid_levels = 0, ask_levels = 0;
+    int64_t first_ts_ns = 0, last_ts_ns = 0;
+    double apply_ms = 0;           // book task wall time
+    int worker = -1;
+};
+
+// Sinks are called from pool workers: concurrently for different tasks, in
+// order within one task. Implementations must be thread-safe.
+class ReplaySink {
+public:
+    virtual ~ReplaySink() = default;
+    virtual void bars(const ReplayTaskKey&, const std::vector<ReplayBar>&) {}
+    virtual void snapshots(const ReplayTaskKey&, const std::vector<ReplaySnapshot>&) {}
+    virtual void stats(const ReplayTaskStats&) {}
+};
+
+// JSON lines, one file per kind (empty path = not written). Lines are
+// formatted outside the lock and appended per batch.
+class JsonlReplaySink : public ReplaySink {
+public:
+    JsonlReplaySink(const std::string& bars_path, const std::string& snapshots_path, const std::string& stats_path);
+    ~JsonlReplaySink() override;
+
+    bool ok() const { return ok_; }
+
+    void bars(const ReplayTaskKey& k, const std::vector<ReplayBar>& v) override;
+    void snapshots(const ReplayTaskKey& k, const std::vector<ReplaySnapshot>& v) override;
+    void stats(const ReplayTaskStats& s) override;
+
+private:
+    void write_(FILE* f, const std::string& s);
+
+    std::mutex m_;
+    FILE* bars_ = nullptr;
+    FILE* snaps_ = nullptr;
+    FILE* stats_ = nullptr;
+    bool ok_ = true;
+};
+
+struct BatchReplayOptions {
+    std::vector<std::string> files;
+    unsigned threads = 0;                  // 0 = hardware_concurrency
+    unsigned parse_threads = 1;            // CSV parser threads per load task (csv_chunk_parser.hpp)
+    std::vector<int32_t> instruments;      // only these (empty = all)
+    std::vector<std::string> symbols;      // only these (empty = all)
+    int64_t bar_ns = 60'000'000'000;       // 0 = no bars
+    int64_t snapshot_ns = 0;               // 0 = no snapshots
+    int snapshot_depth = 10;
+    size_t flush_every = 4096;             // bars / snapshots buffered per task before a sink call
+    std::vector<ReplaySink*> sinks;
+};
+
+struct BatchReplayResult {
+    std::vector<ReplayTaskStats> tasks;    // in file, then instrument order
+    std::vector<std::string> errors;       // files that failed to load
+    uint64_t events = 0;
+    double wall_ms = 0;
+    double load_ms = 0;                    // summed over load tasks
+    double apply_ms = 0;                   // summed over book tasks
+    uint64_t steals = 0;
+    unsigned threads = 0;
+};
+
+// Runs the whole batch; blocks until every task is done. False if no file
+// could be loaded.
+bool run_batch_replay(const BatchReplayOptions& opt, BatchReplayResult& out);
+
+// Loads a CSV or ".mbob" file into records (CSV timestamps parsed once). CSV
+// goes through the mmap chunk parser on `parse_threads` threads.
+bool load_replay_file(const std::string& path, std::vector<MboRecord>& out, std::string& err,
+                      unsigned parse_threads = 1);
+
+} // namespace mbo
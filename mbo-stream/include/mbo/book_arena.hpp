@@ -0,0 +1,135 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+
+namespace mbo {
+
+// Memory arena for order book nodes.
+//
+// The book is node based (std::map levels, std::list FIFO queues, an
+// unordered_map order index), so on the default heap its nodes end up spread
+// over many 4K pages and the first burst after startup pays a page fault for
+// each new one. The arena reserves one contiguous region up front, sized from a
+// capacity hint:
+//   - 2MB pages: transparent huge pages via madvise(MADV_HUGEPAGE), or
+//     hugetlbfs pages (MAP_HUGETLB) when requested and reserved by the admin
+//   - pre-faulted: every page is touched at startup, not on the hot path
+//   - optionally mlock()ed so it is never swapped out
+//
+// Allocation bumps through the region. Freed blocks go to a per-size-class
+// free list (16-byte classes up to kMaxSmallBytes, which covers every node
+// type) and are reused LIFO, so a steady-state book recycles the same warm
+// cache lines. Larger blocks (the index bucket array) are reused only for an
+// exact size match. Once the region is exhausted, requests fall back to
+// ::operator new and are counted as overflow.
+//
+// Not thread-safe: one arena per book-owning thread.
+
+enum class ArenaPages {
+    Normal,    // plain 4K pages
+    Thp,       // madvise(MADV_HUGEPAGE)
+    Hugetlb,   // MAP_HUGETLB (falls back to Thp if none are reserved)
+};
+
+const char* arena_pages_name(ArenaPages p);
+
+struct BookArenaOptions {
+    size_t bytes = 0;                 // region size, rounded up to 2MB
+    ArenaPages pages = ArenaPages::Thp;
+    bool prefault = true;
+    bool mlock = false;
+};
+
+// Region bytes for a book expected to hold `orders` resting orders (node
+// sizes of libstdc++ list/map/unordered_map plus the bucket array, 2x slack).
+size_t book_arena_bytes_for_orders(size_t orders);
+
+class BookArena {
+public:
+    static constexpr size_t kAlign = 16;
+    static constexpr size_t kMaxSmallBytes = 256;
+
+    explicit BookArena(const BookArenaOptions& opt);
+    ~BookArena();
+
+    BookArena(const BookArena&) = delete;
+    BookArena& operator=(const BookArena&) = delete;
+
+    void* allocate(size_t bytes);
+    void deallocate(void* p, size_t bytes) noexcept;
+
+    bool ok() const { return base_ != nullptr; }
+    const std::string& error() const { return error_; }   // setup warnings / failure
+
+    ArenaPages pages() const { return pages_; }
+    bool locked() const { return locked_; }
+    size_t capacity() const { return size_; }
+    size_t used() const { return (size_t)(top_ - base_); }   // high-water mark of the bump pointer
+    size_t live_bytes() const { return live_; }
+    uint64_t overflow_allocs() const { return overflow_; }
+
+    // bytes of the region currently backed by huge pages (/proc/self/smaps)
+    size_t huge_page_bytes() const;
+
+    // {"pages":"thp","capacity_mb":..,"used_mb":..,"huge_mb":..,"locked":..,"overflow":..}
+    std::string to_json() const;
+
+private:
+    struct FreeBlock { FreeBlock* next; size_t bytes; };
+
+    bool owns(const void* p) const {
+        return (const char*)p >= base_ && (const char*)p < base_ + size_;
+    }
+
+    char* map_ = nullptr;      // mmap result (may be larger than the aligned region)
+    size_t map_size_ = 0;
+    char* base_ = nullptr;     // 2MB-aligned start
+    size_t size_ = 0;
+    char* top_ = nullptr;      // bump pointer
+    ArenaPages pages_ = ArenaPages::Normal;
+    bool locked_ = false;
+    std::string error_;
+
+    FreeBlock* small_[kMaxSmallBytes / kAlign + 1] = {};
+    FreeBlock* large_ = nullptr;
+
+    size_t live_ = 0;
+    uint64_t overflow_ = 0;
+};
+
+// Standard allocator over a BookArena; a null arena means ::operator new, so
+// books built without an arena behave exactly as before.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept = default;
+    explicit ArenaAllocator(BookArena* a) noexcept : arena_(a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& o) noexcept : arena_(o.arena()) {}
+
+    T* allocate(size_t n) {
+        const size_t bytes = n * sizeof(T);
+        if (!arena_) return static_cast<T*>(::operator new(bytes));
+        return static_cast<T*>(arena_->allocate(bytes));
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        if (!arena_) { ::operator delete(p); return; }
+        arena_->deallocate(p, n * sizeof(T));
+    }
+
+    BookArena* arena() const noexcept { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& o) const noexcept { return arena_ == o.arena(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& o) const noexcept { return arena_ != o.arena(); }
+
+private:
+    BookArena* arena_ = nullptr;
+};
+
+} // namespace mbo
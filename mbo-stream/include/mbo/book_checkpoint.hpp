@@ -0,0 +1,157 @@
+#pragma once
+#include "mbo/mbo_order_book.hpp"
+
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace mbo {
+
+// Binary book checkpoint: the complete MBO state of one book plus the feed
+// position it corresponds to, so a restart can load it in milliseconds and
+// resume the feed (FEED_RESUME handshake) instead of replaying from the top.
+//
+// Layout (little-endian, packed):
+//   header  magic "MBOCKPT1", u32 version, u32 header bytes,
+//           u64 last_seq, u64 seq_count, u64 applied, i64 last_ts_ns,
+//           u32 bid levels, u32 ask levels, u64 orders, u16 symbol length,
+//           u64 journal index (absent in older, shorter headers)
+//   symbol  bytes
+//   levels  bids best first, then asks best first:
+//           i64 price, u32 n, n x { i64 order_id, i32 qty }  (FIFO order)
+//   trailer u64 FNV-1a (8-byte words) of everything before it
+//
+// Restoring appends each level at the worst end of its side and its orders
+// at the tail of the queue (MboOrderBook::restore_level), so there is no
+// per-order level lookup and the FIFO priority is exact.
+
+struct CheckpointMeta {
+    std::string symbol;
+    uint64_t last_seq = 0;     // last venue sequence applied
+    uint64_t seq_count = 0;    // records with last_seq applied
+    uint64_t applied = 0;      // records applied since the replay started
+    int64_t last_ts_ns = 0;    // ts_event of the last record applied
+    // event journal index of the first record not in the book (JOURNAL_DIR)
+    uint64_t journal_index = kNoJournalIndex;
+
+    static constexpr uint64_t kNoJournalIndex = ~0ull;
+};
+
+struct CheckpointStats {
+    uint64_t bytes = 0;
+    uint64_t orders = 0;
+    uint32_t bid_levels = 0;
+    uint32_t ask_levels = 0;
+};
+
+// Serialises `book` + `meta` into `out` (replaced).
+void encode_book_checkpoint(const MboOrderBook& book, const CheckpointMeta& meta, std::string& out,
+                            CheckpointStats* stats = nullptr);
+
+// Rebuilds `book` (must be empty) from a checkpoint image. False + err on a
+// bad magic/version/checksum or inconsistent contents.
+bool decode_book_checkpoint(const char* data, size_t len, MboOrderBook& book, CheckpointMeta& meta,
+                            std::string& err, CheckpointStats* stats = nullptr);
+
+// File helpers. Writing goes to "<path>.tmp" and renames over `path`, so a
+// reader (or a crash mid-write) never sees a torn checkpoint.
+bool write_book_checkpoint(const std::string& path, const MboOrderBook& book, const CheckpointMeta& meta,
+                           std::string& err, CheckpointStats* stats = nullptr);
+
+// Reads `path` into `book` (rebuilt on its own arena and capacity hint).
+bool read_book_checkpoint(const std::string& path, MboOrderBook& book, CheckpointMeta& meta,
+                          std::string& err, CheckpointStats* stats = nullptr);
+
+// Header and symbol only (no levels, no checksum): for picking a checkpoint
+// out of many without reading them.
+bool read_checkpoint_meta(const std::string& path, CheckpointMeta& meta, std::string& err);
+
+// Checkpoint history next to the event journal: "<dir>/ckpt-<journal
+// index>.ckpt", one per periodic checkpoint, the oldest pruned. An as-of query
+// (mbo/as_of.hpp) starts from the newest one before its time and replays the
+// journal from its index, so the seek cost is bounded by the interval.
+struct CheckpointFile {
+    std::string path;
+    uint64_t journal_index = 0;
+};
+
+std::string checkpoint_history_path(const std::string& dir, uint64_t journal_index);
+
+// History files in `dir`, in journal index order. False + err if the
+// directory can't be read.
+bool list_checkpoint_history(const std::string& dir, std::vector<CheckpointFile>& out, std::string& err);
+
+// Periodic checkpoints off the hot path. start() forks; the child encodes and
+// writes its copy-on-write image of the book while the parent goes straight
+// back to the feed, paying only for the fork (page-table copy) and for the
+// pages it dirties before the child is done. One child at a time.
+//
+// The parent reserves the image buffer, builds the file paths and picks the
+// history files to prune before fork(); the child only encodes into that
+// buffer, writes, renames, unlinks and _exit()s: no allocation, no logging,
+// no locks. It first drops the forking thread's CPU pinning and SCHED_FIFO
+// (restore_default_placement_self) so the encode and fsync stay off the
+// ingest core. With keep_history() it also writes the same image into the
+// history directory (checkpoints carrying a journal index only) and prunes it
+// to `keep` files.
+// `path` may be empty to keep the history alone.
+class CheckpointForker {
+public:
+    enum class Reap { None, Ok, Failed };
+
+    explicit CheckpointForker(std::string path) : path_(std::move(path)) {}
+    ~CheckpointForker() { wait(); }
+
+    CheckpointForker(const CheckpointForker&) = delete;
+    CheckpointForker& operator=(const CheckpointForker&) = delete;
+
+    void keep_history(std::string dir, size_t keep);
+
+    // With keep_history() and a `path`: after a good checkpoint, also delete
+    // the journal segments in the history directory that end before the
+    // oldest kept history checkpoint (startup recovery and as-of queries
+    // never read behind it). Without `path` recovery replays the journal from
+    // its start, so nothing is pruned.
+    void prune_journal(bool on) { prune_journal_ = on; }
+
+    // False (err set) if a child is still running or fork() failed.
+    bool start(const MboOrderBook& book, const CheckpointMeta& meta, std::string& err);
+
+    // Reaps a finished child without blocking / blocking.
+    Reap poll();
+    Reap wait();
+
+    bool running() const { return child_ > 0; }
+    const std::string& path() const { return path_; }
+    const std::string& last_path() const { return last_path_; }
+    uint64_t last_fork_ns() const { return fork_ns_; }
+    uint64_t last_bytes() const { return bytes_; }       // size of the last good checkpoint
+    uint64_t last_write_ns() const { return write_ns_; } // fork -> reaped, last good checkpoint
+    size_t last_journal_pruned() const { return journal_pruned_; }  // segments the last good child deleted
+
+private:
+    Reap reap_(bool block);
+
+    std::string path_;
+    std::string history_dir_;
+    size_t history_keep_ = 0;
+    bool prune_journal_ = false;
+    size_t journal_pruned_ = 0;
+    size_t journal_prune_planned_ = 0;
+    std::string last_path_;     // file the running / last child wrote
+
+    // prepared by start() before fork(), used by the child
+    std::string img_;
+    std::string tmp_path_;
+    std::string hist_path_;
+    std::string hist_tmp_path_;
+    std::vector<std::string> prune_;   // history checkpoints, then journal segments
+    pid_t child_ = -1;
+    int64_t started_ns_ = 0;
+    uint64_t fork_ns_ = 0;
+    uint64_t bytes_ = 0;
+    uint64_t write_ns_ = 0;
+};
+
+} // namespace mbo
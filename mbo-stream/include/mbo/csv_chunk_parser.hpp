@@ -0,0 +1,71 @@
+#pragma once
+#include "mbo/mbo_record.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mbo {
+
+// Parallel CSV loading for file-based replays.
+//
+// The file is mmap()ed and cut into newline-aligned chunks of about
+// chunk_bytes. Parser threads claim chunks in order and turn each into a
+// plain MboRecord array (no per-line strings). A reorder buffer of `window`
+// slots hands the arrays to the caller's thread strictly in file order, so
+// the (single-threaded) book applier sees exactly the sequence a line-by-line
+// read would produce. A parser may run at most `window` chunks ahead of the
+// consumer, which bounds memory to about window x chunk records; consumed
+// arrays go back to their slot and are reused.
+//
+// Parsing is the part that scales: with the parse spread over N threads the
+// applier only pays for book work plus one wait per chunk when it gets ahead.
+
+// One CSV line (Databento layout, see csv_parser.hpp) straight into a record,
+// without allocating. Same acceptance and values as parse_mbo_csv_line +
+// record_from_event; false for the header and malformed lines.
+bool parse_mbo_csv_record(std::string_view line, MboRecord& out);
+
+struct CsvChunkSpan {
+    size_t offset = 0;
+    size_t bytes = 0;
+};
+
+// [offset, offset + bytes) ranges covering data[0, size), each ending after a
+// '\n' (or at the end), each about chunk_bytes long (never empty).
+std::vector<CsvChunkSpan> split_csv_chunks(const char* data, size_t size, size_t chunk_bytes);
+
+// Parses every line of `data[0, bytes)` and appends the records to `out`.
+// Returns the number of non-empty lines that did not parse (the header too).
+uint64_t parse_csv_chunk(const char* data, size_t bytes, std::vector<MboRecord>& out);
+
+struct ParallelCsvOptions {
+    unsigned threads = 0;             // parser threads (0 = hardware_concurrency)
+    size_t chunk_bytes = 4u << 20;    // target chunk size
+    size_t window = 0;                // reorder buffer slots (0 = 2 x threads, min 2)
+};
+
+struct ParallelCsvStats {
+    uint64_t bytes = 0;
+    uint64_t chunks = 0;
+    uint64_t records = 0;
+    uint64_t bad_lines = 0;           // includes the header
+    unsigned threads = 0;
+    double wall_ms = 0;
+    double parse_ms = 0;              // summed over parser threads
+    double wait_ms = 0;               // consumer waiting for the next chunk
+};
+
+// fn(recs, n) on the calling thread, once per chunk in file order; return
+// false to stop early. False + err if the file can't be mapped.
+using CsvRecordsFn = std::function<bool(const MboRecord*, size_t)>;
+bool parse_csv_file_parallel(const std::string& path, const ParallelCsvOptions& opt, const CsvRecordsFn& fn,
+                             std::string& err, ParallelCsvStats* stats = nullptr);
+
+// Same over data already in memory (e.g. a buffer mapped or loaded once).
+void parse_csv_buffer_parallel(const char* data, size_t bytes, const ParallelCsvOptions& opt,
+                               const CsvRecordsFn& fn, ParallelCsvStats* stats = nullptr);
+
+} // namespace mbo
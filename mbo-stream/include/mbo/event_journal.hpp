@@ -0,0 +1,166 @@
+#pragma once
+#include "mbo/mbo_record.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MboOrderBook;
+
+namespace mbo {
+
+// Append-only journal of the events the engine applied, in apply order.
+//
+// Records are fixed-size MboRecords in segment files
+// "<dir>/journal-<first index>.mbob". Each segment is preallocated
+// (fallocate) and mmap()ed, with a counted MboFileHeader
+// (kMboFileCounted): the header's record_count is raised after each batch is
+// copied in, so a reader, or a restart after a crash, sees whole records
+// only. A full segment is synced, truncated to its records and replaced by the
+// next one, which has already been preallocated while the current one filled
+// up. Finished segments are plain ".mbob" files, so the bench tools and
+// mbo_gen consumers read them as they are.
+//
+// The ingest thread stages records into a local vector without locking
+// (append) and hands them over once per socket read (commit). A writer thread
+// copies them into the mapping, so the ingest thread never touches the file.
+// If the writer falls more than max_pending_records behind, committed
+// batches are dropped and counted instead of blocking the feed. The journal
+// index keeps counting through a drop, so it shows up as a gap between
+// segments, and replay stops there.
+//
+// A record with rtype kRtypeJournalReset marks the start of a new replay
+// (the engine cleared its book). Its action is 'R', so applying it clears a
+// replayed book as well.
+
+constexpr uint8_t kRtypeJournalReset = 0xFE;
+
+struct EventJournalOptions {
+    std::string dir;
+    size_t segment_records = 1u << 20;        // records per segment (80 MB)
+    size_t max_pending_records = 1u << 22;    // writer backlog before commits are dropped
+    bool sync_on_rotate = true;               // msync + fsync each finished segment
+};
+
+struct JournalSegment {
+    std::string path;
+    uint64_t first_index = 0;   // journal index of its first record
+    uint64_t records = 0;
+};
+
+// Segments in `dir`, in index order. False + err if the directory can't be read.
+bool list_journal_segments(const std::string& dir, std::vector<JournalSegment>& out, std::string& err);
+
+class EventJournal {
+public:
+    EventJournal() = default;
+    ~EventJournal();
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    // Creates `dir` if needed and continues after the last existing segment.
+    bool open(const EventJournalOptions& opt, std::string& err);
+    bool is_open() const { return running_; }
+
+    // ---- producer (one thread) ----
+    // a zeroed record to fill, staged for the next commit()
+    MboRecord& stage() {
+        staging_.emplace_back();
+        return staging_.back();
+    }
+    // hands the staged records to the writer (or drops them, see above)
+    void commit();
+    // journal index the next staged record will get
+    uint64_t next_index() const { return next_index_ + staging_.size(); }
+
+    // commit + wait until everything committed is in the mapping
+    void flush();
+    // flush + stop the writer + finish the current segment (also the destructor)
+    void close();
+
+    // ---- stats (any thread) ----
+    uint64_t records_written() const { return written_total_.load(std::memory_order_relaxed); }
+    uint64_t records_dropped() const { return dropped_total_.load(std::memory_order_relaxed); }
+    uint64_t segments_opened() const { return segments_total_.load(std::memory_order_relaxed); }  // kept files
+    const std::string& error() const { return error_; }   // last writer-side error (under close())
+
+    // the writer thread, for CPU pinning (valid while is_open())
+    std::thread::native_handle_type native_handle() { return thread_.native_handle(); }
+
+private:
+    struct Segment {
+        std::string path;
+        int fd = -1;
+        char* map = nullptr;
+        size_t map_bytes = 0;
+        uint64_t first = 0;
+        uint64_t count = 0;
+        bool open() const { return map != nullptr; }
+    };
+
+    bool open_segment_(Segment& s, uint64_t first, std::string& err);
+    void finish_segment_(Segment& s);
+    void write_batch_(uint64_t first, const MboRecord* recs, size_t n);
+    void run();
+
+    EventJournalOptions opt_;
+    std::thread thread_;
+    bool running_ = false;
+
+    // producer side
+    std::vector<MboRecord> staging_;
+    uint64_t next_index_ = 0;       // index of staging_[0]
+
+    // hand-off (under mtx_)
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::vector<MboRecord> pending_;
+    uint64_t pending_first_ = 0;    // index of pending_[0]
+    bool resync_ = false;           // a commit was dropped; restart pending_ at the next empty hand-off
+    uint64_t committed_ = 0;        // records handed over (or dropped)
+    uint64_t done_ = 0;             // records the writer has finished with
+    bool stop_ = false;
+
+    // writer side
+    Segment cur_;
+    Segment next_;                  // preallocated successor of cur_
+    std::string error_;
+
+    std::atomic<uint64_t> written_total_{0};
+    std::atomic<uint64_t> dropped_total_{0};
+    std::atomic<uint64_t> segments_total_{0};
+};
+
+// Read side: maps the segments read-only and walks them in index order.
+class JournalReader {
+public:
+    bool open(const std::string& dir, std::string& err);
+
+    const std::vector<JournalSegment>& segments() const { return segs_; }
+    uint64_t first_index() const { return segs_.empty() ? 0 : segs_.front().first_index; }
+    // end of the gap-free run that starts at first_index()
+    uint64_t end_index() const;
+
+    // fn(recs, n, index of recs[0]) over records [from, to) in segment-sized
+    // chunks; fn returns false to stop. Stops at a gap. Returns records visited.
+    using ChunkFn = std::function<bool(const MboRecord*, size_t, uint64_t)>;
+    uint64_t scan(uint64_t from, uint64_t to, const ChunkFn& fn, std::string* err = nullptr) const;
+
+private:
+    std::vector<JournalSegment> segs_;
+};
+
+// Applies journal records [from, to) to `book` (book_event_from_record, no
+// string work); per record, on_record(r) runs after the apply (may be null).
+// Returns records applied.
+uint64_t replay_journal(const JournalReader& reader, MboOrderBook& book, uint64_t from = 0,
+                        uint64_t to = UINT64_MAX, const std::function<void(const MboRecord&)>& on_record = {});
+
+} // namespace mbo
@@ -0,0 +1,99 @@
+#pragma once
+#include "mbo/hdr_histogram.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace mbo {
+
+// Exchange -> capture -> engine latency, per symbol, from the feed's own
+// timestamps:
+//   recv_minus_event  ts_recv - ts_event   (venue matching -> capture)
+//   in_delta          ts_in_delta          (venue send -> capture, as reported)
+//   apply_minus_recv  apply wall time - ts_recv (our side; sampled)
+//
+// apply_minus_recv is absolute when the feed is live (first event within a
+// minute of the wall clock). For a replay it is rebased so the fastest event
+// seen so far reads 0, i.e. it measures how far we fall behind a real-time
+// replay; with a fixed-rate streamer it measures pacing, not latency.
+//
+// Each series keeps a session total plus a rolling window in *event* time
+// (ts_recv): the current and the previous window, so rolling() always covers
+// between one and two windows of market time.
+enum class FeedLatencySeries : int { RecvMinusEvent = 0, InDelta, ApplyMinusRecv };
+constexpr int kFeedLatencySeries = 3;
+const char* feed_latency_series_name(FeedLatencySeries s);
+
+class RollingHistogram {
+public:
+    RollingHistogram(int digits, int64_t window_ns);
+
+    void record(uint64_t v, int64_t t_ns) {
+        if (t_ns >= window_end_) roll(t_ns);
+        cur_.record(v);
+        total_.record(v);
+    }
+
+    HdrHistogram rolling() const;               // previous + current window
+    const HdrHistogram& total() const { return total_; }
+
+private:
+    void roll(int64_t t_ns);
+
+    int64_t window_ns_;
+    int64_t window_end_ = INT64_MIN;
+    HdrHistogram cur_;
+    HdrHistogram prev_;
+    HdrHistogram total_;
+};
+
+class FeedLatencyTracker {
+public:
+    // apply_sample_every: 1-in-N events read the wall clock (0 => series off)
+    FeedLatencyTracker(int digits, int64_t window_ns, int apply_sample_every);
+
+    // Timestamps in ns; ts_recv_ns <= 0 skips the event. Returns true when the
+    // caller should pass apply_wall_ns for this event (sampled).
+    bool want_apply_sample() {
+        if (every_ <= 0) return false;
+        if (--countdown_ > 0) return false;
+        countdown_ = every_;
+        return true;
+    }
+    void record(const std::string& symbol, int64_t ts_recv_ns, int64_t ts_event_ns,
+                int32_t ts_in_delta, int64_t apply_wall_ns /* 0 = not sampled */);
+
+    bool empty() const { return by_symbol_.empty(); }
+    uint64_t negative() const { return negative_; }
+
+    // {"CLX5":{"recv_minus_event":{..us..},..},..}  (session totals)
+    std::string to_json() const;
+
+    // Prometheus summary over the rolling window (quantiles) with session
+    // _sum/_count, metric mbo_feed_latency_seconds{symbol,series}.
+    std::string to_prometheus() const;
+
+private:
+    struct PerSymbol {
+        PerSymbol(int digits, int64_t window_ns);
+        RollingHistogram series[kFeedLatencySeries];
+    };
+
+    PerSymbol& slot(const std::string& symbol);
+
+    int digits_;
+    int64_t window_ns_;
+    int every_;
+    int countdown_ = 1;
+
+    std::map<std::string, PerSymbol> by_symbol_;
+    const std::string* last_symbol_ = nullptr;
+    PerSymbol* last_slot_ = nullptr;
+
+    bool apply_base_set_ = false;
+    int64_t apply_offset_ns_ = 0;   // replay rebase (0 for live feeds)
+    uint64_t negative_ = 0;         // skipped: timestamps out of order
+};
+
+} // namespace mbo
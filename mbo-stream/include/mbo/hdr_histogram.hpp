@@ -0,0 +1,219 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mbo {
+
+// Log-linear (HdrHistogram-style) latency histogram.
+//
+// Values are bucketed by power of two, and every power-of-two bucket is split
+// into 2^k linear sub-buckets, chosen so that any recorded value is reported
+// within 10^-significant_digits relative error (3 digits => 0.1%). Recording
+// is O(1) (one clz + shift + increment, no allocation); the counts array is
+// sized once in the constructor from the highest trackable value.
+//
+// Values above highest_trackable are clamped into the top bucket (and counted
+// in `clamped`). Two histograms with the same configuration can be merged, so
+// per-interval histograms can be rolled up into session totals.
+class HdrHistogram {
+public:
+    // default: 1 ns .. ~1 hour with 3 significant digits (~33k counters, ~260 KB)
+    explicit HdrHistogram(int significant_digits = 3,
+                          uint64_t highest_trackable = 3'600'000'000'000ull)
+        : digits_(std::clamp(significant_digits, 1, 5)),
+          highest_(std::max<uint64_t>(highest_trackable, 2)) {
+        const uint64_t largest_single_unit = 2 * pow10(digits_);
+        sub_bucket_count_magnitude_ = (int)std::ceil(std::log2((double)largest_single_unit));
+        sub_bucket_half_count_magnitude_ = sub_bucket_count_magnitude_ - 1;
+        sub_bucket_count_ = 1ull << sub_bucket_count_magnitude_;
+        sub_bucket_half_count_ = sub_bucket_count_ / 2;
+        sub_bucket_mask_ = sub_bucket_count_ - 1;
+
+        uint64_t smallest_untrackable = sub_bucket_count_;
+        int buckets = 1;
+        while (smallest_untrackable <= highest_) {
+            if (smallest_untrackable > (UINT64_MAX >> 1)) { ++buckets; break; }
+            smallest_untrackable <<= 1;
+            ++buckets;
+        }
+        bucket_count_ = buckets;
+        counts_.assign((size_t)(bucket_count_ + 1) * sub_bucket_half_count_, 0);
+        reset();
+    }
+
+    int significant_digits() const { return digits_; }
+    uint64_t highest_trackable() const { return highest_; }
+
+    // O(1); values above highest_trackable() are clamped
+    void record(uint64_t v) { record_n(v, 1); }
+
+    void record_n(uint64_t v, uint64_t n) {
+        if (v > highest_) { v = highest_; clamped_ += n; }
+        counts_[counts_index(v)] += n;
+        total_ += n;
+        sum_ += (long double)v * (long double)n;
+        if (v < min_) min_ = v;
+        if (v > max_) max_ = v;
+    }
+
+    // Pow2Histogram-compatible spelling
+    void add(uint64_t v) { record(v); }
+
+    void reset() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total_ = 0;
+        clamped_ = 0;
+        sum_ = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+    }
+
+    // Adds `o` into this histogram. Same configuration: bucket-wise add;
+    // otherwise every bucket of `o` is re-recorded at its representative value.
+    void merge(const HdrHistogram& o) {
+        if (o.total_ == 0) return;
+        if (o.digits_ == digits_ && o.counts_.size() == counts_.size()) {
+            for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += o.counts_[i];
+            total_ += o.total_;
+            clamped_ += o.clamped_;
+            sum_ += o.sum_;
+            min_ = std::min(min_, o.min_);
+            max_ = std::max(max_, o.max_);
+            return;
+        }
+        for (size_t i = 0; i < o.counts_.size(); ++i) {
+            if (o.counts_[i]) record_n(o.value_from_index(i), o.counts_[i]);
+        }
+        min_ = std::min(min_, o.min_);
+        max_ = std::max(max_, std::min(o.max_, highest_));
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t clamped() const { return clamped_; }
+    uint64_t min() const { return total_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ ? (double)(sum_ / (long double)total_) : 0.0; }
+
+    // p in [0, 100]; returns the highest value equivalent to the bucket that
+    // holds the p-th percentile (clamped to the exact recorded max)
+    uint64_t value_at_percentile(double p) const {
+        if (total_ == 0) return 0;
+        p = std::clamp(p, 0.0, 100.0);
+        uint64_t target = (uint64_t)((p / 100.0) * (double)total_ + 0.5);
+        if (target < 1) target = 1;
+        uint64_t cum = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            cum += counts_[i];
+            if (cum >= target) return std::min(highest_equivalent(value_from_index(i)), max_);
+        }
+        return max_;
+    }
+
+    // Pow2Histogram-compatible: p in [0, 1]
+    uint64_t percentile(double p) const { return value_at_percentile(p * 100.0); }
+
+    // Summary for JSONL output; values are divided by `unit` (e.g. 1e3 for ns -> us).
+    // {"count":..,"min":..,"mean":..,"p50":..,"p90":..,"p99":..,"p999":..,"max":..}
+    std::string to_json(double unit = 1.0) const {
+        std::ostringstream oss;
+        oss.precision(10);
+        oss << "{\"count\":" << total_
+            << ",\"min\":" << (double)min() / unit
+            << ",\"mean\":" << mean() / unit
+            << ",\"p50\":" << (double)value_at_percentile(50) / unit
+            << ",\"p90\":" << (double)value_at_percentile(90) / unit
+            << ",\"p99\":" << (double)value_at_percentile(99) / unit
+            << ",\"p999\":" << (double)value_at_percentile(99.9) / unit
+            << ",\"max\":" << (double)max() / unit;
+        if (clamped_) oss << ",\"clamped\":" << clamped_;
+        oss << "}";
+        return oss.str();
+    }
+
+    // Full-fidelity sparse encoding: {"digits":3,"highest":..,"counts":[[value,count],..]}
+    // (value = lowest value of each non-empty bucket), for offline merging.
+    std::string encode_json() const {
+        std::ostringstream oss;
+        oss << "{\"digits\":" << digits_ << ",\"highest\":" << highest_ << ",\"counts\":[";
+        bool first = true;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            if (!counts_[i]) continue;
+            if (!first) oss << ",";
+            first = false;
+            oss << "[" << value_from_index(i) << "," << counts_[i] << "]";
+        }
+        oss << "]}";
+        return oss.str();
+    }
+
+private:
+    static uint64_t pow10(int d) {
+        uint64_t v = 1;
+        while (d-- > 0) v *= 10;
+        return v;
+    }
+
+    static int clz64(uint64_t v) {
+#if defined(__GNUG__) || defined(__clang__)
+        return __builtin_clzll(v);
+#else
+        int n = 0;
+        for (uint64_t bit = 1ull << 63; bit && !(v & bit); bit >>= 1) ++n;
+        return n;
+#endif
+    }
+
+    int bucket_index(uint64_t v) const {
+        // smallest power of two containing v, relative to the first bucket
+        const int pow2ceiling = 64 - clz64(v | sub_bucket_mask_);
+        return pow2ceiling - (sub_bucket_half_count_magnitude_ + 1);
+    }
+
+    size_t counts_index(uint64_t v) const {
+        const int bi = bucket_index(v);
+        const uint64_t sbi = v >> bi;
+        const uint64_t bucket_base = (uint64_t)(bi + 1) << sub_bucket_half_count_magnitude_;
+        return (size_t)(bucket_base + (sbi - sub_bucket_half_count_));
+    }
+
+    uint64_t value_from_index(size_t idx) const {
+        int bi = (int)(idx >> sub_bucket_half_count_magnitude_) - 1;
+        uint64_t sbi = (idx & (sub_bucket_half_count_ - 1)) + sub_bucket_half_count_;
+        if (bi < 0) {
+            sbi -= sub_bucket_half_count_;
+            bi = 0;
+        }
+        return sbi << bi;
+    }
+
+    uint64_t highest_equivalent(uint64_t v) const {
+        const int bi = bucket_index(v);
+        const uint64_t sbi = v >> bi;
+        const int adj = (sbi >= sub_bucket_count_) ? 1 : 0;
+        const uint64_t width = 1ull << (bi + adj);
+        const uint64_t lowest = (v >> bi) << bi;
+        return lowest + width - 1;
+    }
+
+    int digits_;
+    uint64_t highest_;
+    int sub_bucket_count_magnitude_ = 0;
+    int sub_bucket_half_count_magnitude_ = 0;
+    uint64_t sub_bucket_count_ = 0;
+    uint64_t sub_bucket_half_count_ = 0;
+    uint64_t sub_bucket_mask_ = 0;
+    int bucket_count_ = 0;
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    uint64_t clamped_ = 0;
+    long double sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+} // namespace mbo
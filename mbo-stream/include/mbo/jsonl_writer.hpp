@@ -32,8 +32,82 @@ struct BenchLine {
     double snap_p50_ms = 0.0;
     double snap_p95_ms = 0.0;
     double snap_p99_ms = 0.0;
+
+    // full histogram summaries (HdrHistogram::to_json; apply in us, snapshot in ms)
+    std::string apply_hist_json;
+    std::string snap_hist_json;
+
+    // sampled per-stage timers (StageTimers::to_json, us), empty => omitted
+    std::string stages_json;
+
+    // optional end-to-end latency (streamer STAMP_SEND=1); omitted when e2e_stamped == 0
+    int64_t e2e_stamped = 0;
+    double e2e_send_apply_p50_us = 0.0;
+    double e2e_send_apply_p99_us = 0.0;
+    double e2e_send_publish_p50_us = 0.0;
+    double e2e_send_publish_p99_us = 0.0;
+
+    // per-symbol feed latency (FeedLatencyTracker::to_json; us), empty => omitted
+    std::string feed_latency_json;
+
+    // kernel RX timestamp legs (RX_TIMESTAMPS; us), JSON object string, empty => omitted
+    std::string rx_json;
+
+    // book node arena (BookArena::to_json), empty => omitted
+    std::string book_arena_json;
+
+    // catch-up mode (see LagMonitor); omitted when catchup_entries == 0
+    int64_t catchup_entries = 0;
+    double catchup_s = 0.0;
+    int64_t snapshots_conflated = 0;
+
+    // optional per-stage allocation counts (ALLOC_COUNT=1 builds), JSON object string
+    std::string alloc_json;
+
+    // optional hardware counters (already JSON object strings, empty => omitted)
+    std::string perf_apply_json;
+    std::string perf_snap_json;
+};
+
+// One record per BENCH_INTERVAL_S while a session runs ("type":"interval");
+// counts and percentiles cover that interval only, *_total fields the session.
+struct IntervalLine {
+    int64_t ts_wall_us = 0;
+    std::string host;
+    int port = 0;
+    int64_t session = 0;            // engine session number (1-based)
+    int64_t interval = 0;           // interval number within the session
+    double interval_s = 0.0;        // measured length of this interval
+    double elapsed_s = 0.0;         // since session start
+
+    int64_t events = 0;
+    int64_t events_total = 0;
+    int64_t parse_errors = 0;
+    uint64_t bytes = 0;
+    double throughput_msgs_per_s = 0.0;
+
+    double event_lag_ms = 0.0;          // wall now - last applied event time
+    double event_time_advance_s = 0.0;  // event time covered by this interval
+
+    uint64_t read_backlog_hwm_bytes = 0;  // largest unframed carry-over in the interval
+    uint64_t pg_queue_hwm = 0;            // largest PG queue depth in the interval
+    uint64_t pg_dropped = 0;              // rows evicted from the PG queue in the interval
+
+    uint64_t feed_backlog_bytes = 0;  // FIONREAD at the end of the interval
+    double event_drift_ms = 0.0;      // LagMonitor drift at the end of the interval
+    bool catchup = false;             // in catch-up mode at the end of the interval
+    double catchup_s = 0.0;           // time spent in catch-up during the interval
+
+    uint64_t rss_bytes = 0;
+    uint64_t rss_peak_bytes = 0;
+
+    std::string stages_json;  // StageTimers::interval_json()
 };
 
+// Single-line JSON encodings (no trailing newline).
+std::string to_json(const BenchLine& b);
+std::string to_json(const IntervalLine& b);
+
 class JsonlWriter {
 public:
     JsonlWriter() = default;
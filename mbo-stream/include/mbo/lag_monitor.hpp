@@ -0,0 +1,84 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace mbo {
+
+// Ingest lag tracking and the catch-up mode switch.
+//
+// Two lag signals, both sampled once per socket read:
+//   - backlog: bytes queued in the kernel receive buffer that we have not read
+//     yet (FIONREAD), i.e. how far the socket is ahead of the engine;
+//   - drift: in real-time replay, how much further wall-clock time has advanced
+//     than event time since the session baseline. Drift never goes negative:
+//     whenever event time runs ahead of the wall clock, the baseline moves
+//     forward to that point. Only meaningful when the feed is paced in event
+//     time, so it is off unless a threshold is set.
+//
+// Crossing either enter threshold switches to catch-up. Catch-up ends once both
+// signals are under a quarter of their thresholds (hysteresis, so the mode
+// does not flap around one boundary). A threshold of 0 disables that signal.
+class LagMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    LagMonitor(uint64_t enter_backlog_bytes, int64_t enter_drift_us)
+        : enter_backlog_(enter_backlog_bytes), enter_drift_us_(std::max<int64_t>(enter_drift_us, 0)) {}
+
+    bool enabled() const { return enter_backlog_ > 0 || enter_drift_us_ > 0; }
+    bool catchup() const { return catchup_; }
+
+    // Returns true when the mode changed (see catchup()).
+    bool update(uint64_t backlog_bytes, int64_t event_ts_us, int64_t wall_us, Clock::time_point now) {
+        backlog_ = backlog_bytes;
+        if (event_ts_us > 0) {
+            if (base_ts_us_ == 0 || (wall_us - base_wall_us_) < (event_ts_us - base_ts_us_)) {
+                base_ts_us_ = event_ts_us;
+                base_wall_us_ = wall_us;
+            }
+            drift_us_ = (wall_us - base_wall_us_) - (event_ts_us - base_ts_us_);
+        }
+
+        if (catchup_) catchup_ns_ += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_).count();
+        last_ = now;
+
+        if (!enabled()) return false;
+        const bool over = (enter_backlog_ > 0 && backlog_ >= enter_backlog_) ||
+                          (enter_drift_us_ > 0 && drift_us_ >= enter_drift_us_);
+        const bool under = (enter_backlog_ == 0 || backlog_ < enter_backlog_ / 4) &&
+                           (enter_drift_us_ == 0 || drift_us_ < enter_drift_us_ / 4);
+        if (!catchup_ && over) {
+            catchup_ = true;
+            ++entries_;
+            return true;
+        }
+        if (catchup_ && under) {
+            catchup_ = false;
+            return true;
+        }
+        return false;
+    }
+
+    uint64_t backlog_bytes() const { return backlog_; }
+    int64_t drift_us() const { return drift_us_; }
+
+    uint64_t entries() const { return entries_; }
+    uint64_t catchup_ns() const { return catchup_ns_; }
+
+private:
+    uint64_t enter_backlog_;
+    int64_t enter_drift_us_;
+
+    bool catchup_ = false;
+    uint64_t backlog_ = 0;
+    int64_t drift_us_ = 0;
+    int64_t base_ts_us_ = 0;
+    int64_t base_wall_us_ = 0;
+
+    Clock::time_point last_{};
+    uint64_t entries_ = 0;
+    uint64_t catchup_ns_ = 0;
+};
+
+} // namespace mbo
@@ -0,0 +1,184 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace mbo {
+
+// Asynchronous structured logger.
+//
+// A log call copies a fixed-size binary record (timestamp, level, a pointer to
+// the static format string, up to kLogMaxArgs raw arguments and a small inline
+// text area for string arguments) into a per-thread single-producer ring. No
+// lock, no allocation and no formatting happens on the calling thread; a
+// background thread drains every ring, formats "{}" placeholders and writes a
+// whole batch with one fwrite. When a ring is full the record is dropped and
+// counted, the caller never blocks.
+//
+// Levels are checked before the arguments are evaluated (MBO_LOG macros), so a
+// disabled debug line costs one relaxed load. LOG_LEVEL=error|warn|info|debug|
+// trace sets the initial level; set_log_level() changes it at runtime.
+//
+// Output: "2026-01-02T03:04:05.123456Z I <message>" on stderr, or appended to
+// LOG_PATH when set.
+
+enum class LogLevel : uint8_t { Error = 0, Warn, Info, Debug, Trace };
+
+constexpr int kLogMaxArgs = 8;
+constexpr int kLogTextBytes = 160;      // inline string argument bytes per record
+constexpr size_t kLogRingSlots = 1024;  // per thread, power of two
+
+enum class LogArgKind : uint8_t { I64, U64, F64, Str, Bool };
+
+// Trivially copyable: producers copy it into a ring slot with memcpy.
+struct LogRecord {
+    uint64_t ts_ns;                  // system_clock, ns since epoch
+    const char* fmt;                 // static storage ("{}" placeholders)
+    uint32_t suppressed;             // rate-limited calls folded into this one
+    LogLevel level;
+    uint8_t nargs;
+    uint16_t text_len;
+    LogArgKind kind[kLogMaxArgs];
+    uint64_t arg[kLogMaxArgs];       // value bits, or (offset << 16 | len) into text for Str
+    char text[kLogTextBytes];
+};
+
+LogLevel log_level();
+void set_log_level(LogLevel lvl);
+bool parse_log_level(const char* s, LogLevel& out);
+const char* log_level_name(LogLevel lvl);
+
+namespace detail {
+extern std::atomic<uint8_t> g_log_level;
+void log_submit(const LogRecord& r);
+} // namespace detail
+
+inline bool log_enabled(LogLevel lvl) {
+    return (uint8_t)lvl <= detail::g_log_level.load(std::memory_order_relaxed);
+}
+
+// Blocks until everything logged before the call has been written; use before
+// printing straight to stderr so the two streams don't interleave.
+void log_flush();
+
+// Stops the background thread after a final flush (also done at exit).
+void log_shutdown();
+
+// Records dropped because a thread's ring was full.
+uint64_t log_dropped();
+
+// Per-call-site limiter (MBO_LOG_RATELIMITED): at most `per_sec` records per
+// second; the suppressed count rides on the next record that gets through.
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(uint32_t per_sec) : per_sec_(per_sec ? per_sec : 1) {}
+
+    // true => log; `suppressed` = calls dropped since the last allowed one
+    bool allow(uint32_t& suppressed) {
+        const int64_t now_s = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        if (now_s != window_s_.load(std::memory_order_relaxed)) {
+            window_s_.store(now_s, std::memory_order_relaxed);
+            count_.store(0, std::memory_order_relaxed);
+        }
+        if (count_.fetch_add(1, std::memory_order_relaxed) < per_sec_) {
+            suppressed = skipped_.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+private:
+    uint32_t per_sec_;
+    std::atomic<int64_t> window_s_{0};
+    std::atomic<uint32_t> count_{0};
+    std::atomic<uint32_t> skipped_{0};
+};
+
+namespace detail {
+
+inline void log_put_text(LogRecord& r, int i, const char* p, size_t n) {
+    const size_t room = (size_t)kLogTextBytes - r.text_len;
+    if (n > room) n = room;
+    std::memcpy(r.text + r.text_len, p, n);
+    r.kind[i] = LogArgKind::Str;
+    r.arg[i] = ((uint64_t)r.text_len << 16) | (uint64_t)n;
+    r.text_len = (uint16_t)(r.text_len + n);
+}
+
+template <typename T>
+inline void log_put(LogRecord& r, int i, const T& v) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>) {
+        r.kind[i] = LogArgKind::Bool;
+        r.arg[i] = v ? 1 : 0;
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        r.kind[i] = LogArgKind::I64;
+        r.arg[i] = (uint64_t)(int64_t)v;
+    } else if constexpr (std::is_integral_v<U>) {
+        r.kind[i] = LogArgKind::U64;
+        r.arg[i] = (uint64_t)v;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        const double d = (double)v;
+        r.kind[i] = LogArgKind::F64;
+        std::memcpy(&r.arg[i], &d, sizeof d);
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        const std::string_view s(v);
+        log_put_text(r, i, s.data(), s.size());
+    } else {
+        static_assert(sizeof(T) == 0, "unsupported log argument type");
+    }
+}
+
+template <typename... Args>
+inline void log_write(LogLevel lvl, uint32_t suppressed, const char* fmt, const Args&... args) {
+    static_assert(sizeof...(Args) <= kLogMaxArgs, "too many log arguments");
+    LogRecord r;
+    r.ts_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    r.fmt = fmt;
+    r.level = lvl;
+    r.suppressed = suppressed;
+    r.nargs = (uint8_t)sizeof...(Args);
+    r.text_len = 0;
+    int i = 0;
+    (log_put(r, i++, args), ...);
+    (void)i;
+    log_submit(r);
+}
+
+} // namespace detail
+
+// Formats a record into `out` (used by the background thread; exposed for tools).
+void format_log_record(const LogRecord& r, std::string& out);
+
+} // namespace mbo
+
+// fmt must be a string literal (the pointer is read later, on the log thread).
+#define MBO_LOG(lvl, fmt, ...)                                                     \
+    do {                                                                           \
+        if (::mbo::log_enabled(lvl))                                               \
+            ::mbo::detail::log_write((lvl), 0, "" fmt, ##__VA_ARGS__);             \
+    } while (0)
+
+#define MBO_LOG_ERROR(fmt, ...) MBO_LOG(::mbo::LogLevel::Error, fmt, ##__VA_ARGS__)
+#define MBO_LOG_WARN(fmt, ...)  MBO_LOG(::mbo::LogLevel::Warn, fmt, ##__VA_ARGS__)
+#define MBO_LOG_INFO(fmt, ...)  MBO_LOG(::mbo::LogLevel::Info, fmt, ##__VA_ARGS__)
+#define MBO_LOG_DEBUG(fmt, ...) MBO_LOG(::mbo::LogLevel::Debug, fmt, ##__VA_ARGS__)
+#define MBO_LOG_TRACE(fmt, ...) MBO_LOG(::mbo::LogLevel::Trace, fmt, ##__VA_ARGS__)
+
+// At most per_sec records per second from this call site.
+#define MBO_LOG_RATELIMITED(lvl, per_sec, fmt, ...)                                \
+    do {                                                                           \
+        if (::mbo::log_enabled(lvl)) {                                             \
+            static ::mbo::LogRateLimiter mbo_log_rl_(per_sec);                     \
+            uint32_t mbo_log_sup_ = 0;                                             \
+            if (mbo_log_rl_.allow(mbo_log_sup_))                                   \
+                ::mbo::detail::log_write((lvl), mbo_log_sup_, "" fmt, ##__VA_ARGS__); \
+        }                                                                          \
+    } while (0)
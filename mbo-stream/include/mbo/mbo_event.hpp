@@ -14,5 +14,10 @@ struct MboEvent {
     int32_t size = 0;
     int64_t order_id = 0;
     uint32_t flags = 0;
+    int32_t ts_in_delta = 0;   // venue send -> capture, ns (Databento), 0 if absent
+    uint64_t sequence = 0;     // venue sequence (non-decreasing, not unique), 0 if absent
     std::string symbol;
+
+    // optional 16th CSV column: streamer wall-clock send time (STAMP_SEND=1), 0 if absent
+    int64_t ts_send_ns = 0;
 };
@@ -10,7 +10,9 @@
 
 class MboOrderBook {
 public:
-    explicit MboOrderBook(std::string sym = "");
+    // arena: optional node storage (huge-page / pre-faulted, see book_arena.hpp);
+    // must outlive the book. expected_orders pre-sizes the order index.
+    explicit MboOrderBook(std::string sym = "", mbo::BookArena* arena = nullptr, size_t expected_orders = 0);
     void apply(const MboEvent& e);
     std::string to_json(int depth = 5, double price_scale = 10000.0) const;
     std::string to_json_bbo(double price_scale = 10000.0) const;
@@ -18,6 +20,33 @@ public:
 
     TopOfBook top_of_book(double price_scale = 10000.0) const;
 
+    // resting orders / price levels (cheap; used by the metrics gauges)
+    size_t order_count() const { return index_.size(); }
+    size_t bid_levels() const { return bids_.size(); }
+    size_t ask_levels() const { return asks_.size(); }
+    int64_t best_bid() const { return bids_.empty() ? 0 : bids_.begin()->first; }   // 0 if empty
+    int64_t best_ask() const { return asks_.empty() ? 0 : asks_.begin()->first; }
+
+    // construction parameters, to rebuild a book on the same storage
+    mbo::BookArena* arena() const { return arena_; }
+    size_t expected_orders() const { return expected_orders_; }
+    const std::string& symbol() const { return symbol_; }
+
+    // ---- checkpoint support (see book_checkpoint.hpp) ----
+    // fn(is_buy, price, const OrderQueue&) for every level, best price first per side
+    template <typename Fn>
+    void for_each_level(Fn&& fn) const {
+        for (const auto& [px, q] : bids_) fn(true, px, q);
+        for (const auto& [px, q] : asks_) fn(false, px, q);
+    }
+
+    // Bulk restore into an empty book: appends one level, with its orders in
+    // FIFO order, behind the worst level of its side (levels must arrive best
+    // first, as for_each_level emits them). No per-order level lookup.
+    // False on an out-of-order price or a duplicate order id; the book is then
+    // incomplete and should be discarded.
+    bool restore_level(bool is_buy, int64_t price, const Order* orders, size_t n);
+    void reserve_orders(size_t n) { index_.reserve(n); }
 
 private:
     void clear_();
@@ -25,8 +54,23 @@ private:
     void cancel_(const MboEvent& e);
     void modify_(const MboEvent& e);
 
+    template <typename Cmp>
+    using Levels = std::map<int64_t, OrderQueue, Cmp,
+                            mbo::ArenaAllocator<std::pair<const int64_t, OrderQueue>>>;
+    using Index = std::unordered_map<int64_t, OrderRef, std::hash<int64_t>, std::equal_to<int64_t>,
+                                     mbo::ArenaAllocator<std::pair<const int64_t, OrderRef>>>;
+
+    // level for `price`, created empty (with the arena allocator) if missing
+    template <typename Cmp>
+    OrderQueue& level_(Levels<Cmp>& side, int64_t price);
+
+    template <typename Cmp>
+    bool restore_level_(Levels<Cmp>& side, bool is_buy, int64_t price, const Order* orders, size_t n);
+
     std::string symbol_;
-    std::map<int64_t, std::list<Order>, std::greater<int64_t>> bids_;
-    std::map<int64_t, std::list<Order>, std::less<int64_t>> asks_;
-    std::unordered_map<int64_t, OrderRef> index_;
+    mbo::BookArena* arena_;
+    size_t expected_orders_;
+    Levels<std::greater<int64_t>> bids_;
+    Levels<std::less<int64_t>> asks_;
+    Index index_;
 };
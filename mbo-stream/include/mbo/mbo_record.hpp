@@ -0,0 +1,75 @@
+#pragma once
+#include "mbo/mbo_event.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mbo {
+
+// Fixed-size POD form of one MBO event, used for binary files (".mbob") and
+// anywhere events are stored in bulk. Unlike MboEvent it owns no heap memory.
+// - timestamps: UNIX epoch nanoseconds
+// - price: book fixed-point (same 1e-4 scale as parse_mbo_csv_line)
+struct MboRecord {
+    int64_t ts_recv_ns = 0;
+    int64_t ts_event_ns = 0;
+    int64_t price = 0;
+    int64_t order_id = 0;
+    uint64_t sequence = 0;
+    int32_t instrument_id = 0;
+    int32_t size = 0;
+    int32_t ts_in_delta = 0;
+    uint32_t flags = 0;
+    uint16_t publisher_id = 0;
+    char action = 'N';
+    char side = 'N';
+    uint8_t channel_id = 0;
+    uint8_t rtype = 160;      // Databento MBO
+    uint8_t reserved[2] = {0, 0};
+    char symbol[16] = {};     // NUL-padded, truncated if longer
+};
+static_assert(sizeof(MboRecord) == 80, "MboRecord layout is part of the file format");
+
+// ".mbob" file = MboFileHeader followed by back-to-back MboRecord (little endian).
+// Preallocated files (event journal segments) set kMboFileCounted: only the
+// first record_count records are valid, the rest of the file is zero fill.
+constexpr uint32_t kMboFileCounted = 1;
+
+struct MboFileHeader {
+    char magic[4] = {'M', 'B', 'O', 'B'};
+    uint32_t version = 1;
+    uint32_t record_size = sizeof(MboRecord);
+    uint32_t price_scale = 10000;
+    uint64_t record_count = 0;   // valid records (kMboFileCounted), else unused
+    uint32_t flags = 0;
+    uint32_t reserved = 0;
+};
+static_assert(sizeof(MboFileHeader) == 32, "MboFileHeader layout is part of the file format");
+
+bool valid_mbo_file_header(const MboFileHeader& h);
+
+void set_record_symbol(MboRecord& r, const std::string& symbol);
+std::string record_symbol(const MboRecord& r);
+
+// Conversions to / from the string-carrying event used by the engine.
+void event_from_record(const MboRecord& r, MboEvent& out);
+bool record_from_event(const MboEvent& e, MboRecord& out);
+// with timestamps the caller already parsed (no ISO-8601 parsing)
+void record_from_event(const MboEvent& e, int64_t ts_recv_ns, int64_t ts_event_ns, MboRecord& out);
+
+// Only the fields MboOrderBook::apply reads (no timestamp formatting, no
+// symbol copy), for replays that feed records straight into a book. `out` is
+// reused across calls.
+void book_event_from_record(const MboRecord& r, MboEvent& out);
+
+// Valid records in a file of `file_bytes` with header `h`.
+size_t mbo_file_record_count(const MboFileHeader& h, size_t file_bytes);
+
+// Load a whole ".mbob" file. Returns false (and prints why) on error.
+bool read_mbo_records(const std::string& path, std::vector<MboRecord>& out);
+
+// True if the path names a binary record file (by extension).
+bool is_mbo_record_path(const std::string& path);
+
+} // namespace mbo
@@ -0,0 +1,127 @@
+#pragma once
+#include "mbo/stage_timer.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace mbo {
+
+// Process-wide live metrics, rendered in Prometheus text format by the
+// metrics listener (metrics_server.hpp).
+//
+// Every field is a relaxed atomic written without locks. Counters owned by a
+// single thread (the ingest thread, the PG writer) are bumped with a plain
+// load + store, which compiles to ordinary moves on x86; counters that several
+// threads may touch (WS sessions) use fetch_add. Readers only ever see values
+// that are slightly stale, never torn.
+
+// Single-writer increment: no lock-prefixed RMW on the hot path.
+inline void bump(std::atomic<uint64_t>& c, uint64_t n = 1) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void set_gauge(std::atomic<uint64_t>& g, uint64_t v) { g.store(v, std::memory_order_relaxed); }
+
+// Fixed-bucket latency histogram (Prometheus histogram semantics: cumulative
+// buckets are computed at render time). Single writer.
+struct StageMetric {
+    static constexpr int kBuckets = 20;
+    // upper bounds in ns: 50ns .. 100ms (1-2.5-5 steps), plus +Inf
+    static const uint64_t kBoundsNs[kBuckets];
+
+    std::atomic<uint64_t> bucket[kBuckets + 1]{};
+    std::atomic<uint64_t> sum_ns{0};
+    std::atomic<uint64_t> count{0};
+
+    void record(uint64_t ns) {
+        int i = 0;
+        while (i < kBuckets && ns > kBoundsNs[i]) ++i;
+        bump(bucket[i]);
+        bump(sum_ns, ns);
+        bump(count);
+    }
+};
+
+// Legs of the kernel-receive-timestamp latency breakdown (RX_TIMESTAMPS).
+enum class RxLeg : int {
+    RxToParse = 0,  // kernel arrival -> parse start (socket queue + carry buffer)
+    ParseToApply,   // parse start -> apply done
+    RxToApply,      // kernel arrival -> apply done
+};
+constexpr int kRxLegCount = 3;
+const char* rx_leg_name(RxLeg leg);
+
+struct EngineMetrics {
+    // ---- ingest (ingest thread) ----
+    std::atomic<uint64_t> sessions_total{0};
+    std::atomic<uint64_t> bytes_read_total{0};
+    std::atomic<uint64_t> lines_total{0};
+    std::atomic<uint64_t> events_total{0};        // applied events
+    std::atomic<uint64_t> parse_errors_total{0};
+    std::atomic<uint64_t> snapshots_total{0};
+    std::atomic<uint64_t> feed_connected{0};      // gauge 0/1
+    std::atomic<uint64_t> feed_empty_polls_total{0};  // BUSY_POLL reads that found the socket empty
+    std::atomic<uint64_t> feed_resumes_total{0};      // sessions resumed on a kept book
+
+    // events/s over the last second, maintained by the metrics listener
+    std::atomic<uint64_t> events_per_s{0};
+
+    // ---- lag / catch-up mode (ingest thread, once per socket read) ----
+    std::atomic<uint64_t> feed_backlog_bytes{0};     // unread bytes in the socket receive queue
+    std::atomic<uint64_t> event_drift_us{0};         // wall-clock progress beyond event-time progress
+    std::atomic<uint64_t> catchup_active{0};         // gauge 0/1
+    std::atomic<uint64_t> catchup_entries_total{0};
+    std::atomic<uint64_t> catchup_exits_total{0};
+    std::atomic<uint64_t> catchup_ns_total{0};
+    std::atomic<uint64_t> snapshots_conflated_total{0};  // snapshot boundaries skipped in catch-up
+
+    // ---- book (refreshed on every snapshot) ----
+    std::atomic<uint64_t> book_orders{0};
+    std::atomic<uint64_t> book_bid_levels{0};
+    std::atomic<uint64_t> book_ask_levels{0};
+
+    // ---- book checkpoints (ingest thread, CHECKPOINT_PATH) ----
+    std::atomic<uint64_t> checkpoints_total{0};
+    std::atomic<uint64_t> checkpoint_failures_total{0};
+    std::atomic<uint64_t> checkpoint_fork_us{0};     // last fork() as seen by the ingest thread
+    std::atomic<uint64_t> checkpoint_bytes{0};       // size of the last good checkpoint
+
+    // ---- event journal (mirrored once per socket read, JOURNAL_DIR) ----
+    std::atomic<uint64_t> journal_records_total{0};
+    std::atomic<uint64_t> journal_dropped_total{0};
+    std::atomic<uint64_t> journal_segments_total{0};
+
+    // ---- per-stage latency (sampled StageTimers) ----
+    StageMetric stage[kStageCount];
+    StageMetric rx[kRxLegCount];                  // RX_TIMESTAMPS legs, same sampling
+
+    // ---- persistence (PG queue) ----
+    std::atomic<uint64_t> pg_queue_depth{0};
+    std::atomic<uint64_t> pg_queue_high_water{0};
+    std::atomic<uint64_t> pg_rows_enqueued{0};
+    std::atomic<uint64_t> pg_rows_written{0};
+    std::atomic<uint64_t> pg_rows_failed{0};
+    std::atomic<uint64_t> pg_rows_dropped{0};     // evicted by a full queue
+    std::atomic<uint64_t> pg_queue_interval_hwm{0};  // reset by each interval bench line (not exported)
+
+    // ---- WebSocket (WS io thread(s)) ----
+    std::atomic<uint64_t> ws_sessions_active{0};
+    std::atomic<uint64_t> ws_sessions_total{0};
+    std::atomic<uint64_t> ws_frames_total{0};
+    std::atomic<uint64_t> ws_bytes_total{0};
+    std::atomic<uint64_t> ws_conflations_total{0};  // ticks skipped: previous frame still in flight
+    std::atomic<uint64_t> ws_write_errors_total{0};
+};
+
+EngineMetrics& metrics();
+
+// Pre-rendered exposition text appended to /metrics, for per-symbol series
+// whose label sets are not known up front (FeedLatencyTracker::to_prometheus).
+// Replaced wholesale by the ingest thread about once a second.
+void set_feed_latency_prometheus(std::string text);
+
+// Prometheus text exposition format (version 0.0.4).
+std::string render_prometheus(const EngineMetrics& m);
+
+} // namespace mbo
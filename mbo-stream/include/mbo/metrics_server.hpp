@@ -0,0 +1,7 @@
+#pragma once
+#include <boost/asio.hpp>
+
+// Start a plain HTTP listener on the given port serving GET /metrics
+// (Prometheus text format, see metrics.hpp). Also refreshes the events/s gauge
+// once per second. Runs on the caller's io_context.
+void start_metrics_server(boost::asio::io_context& ioc, int port);
@@ -1,4 +1,6 @@
 #pragma once
+#include "mbo/book_arena.hpp"
+
 #include <cstdint>
 #include <list>
 
@@ -9,10 +11,13 @@ struct Order {
     int32_t qty;
 };
 
+// FIFO queue of one price level; nodes come from the book's arena (if any)
+using OrderQueue = std::list<Order, mbo::ArenaAllocator<Order>>;
+
 // Reference to an order's exact position inside the book
 // Used for O(1) cancel / modify.
 struct OrderRef {
     bool is_buy;     // true = bid, false = ask
     int64_t price;   // price level where the order resides
-    std::list<Order>::iterator it;
+    OrderQueue::iterator it;
 };
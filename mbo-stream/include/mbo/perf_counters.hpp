@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace mbo {
+
+// Hardware counters read through perf_event_open(2), counting user space of
+// the calling thread only. Each event is opened independently so that a PMU
+// (or a container / VM) missing one of them still yields the others; if none
+// can be opened, available() is false and every read returns zeros.
+enum class PerfEvent : int {
+    Cycles = 0,
+    Instructions,
+    L1dMisses,
+    LlcMisses,
+    BranchMisses,
+    DtlbMisses,
+};
+
+constexpr int kPerfEventCount = 6;
+
+const char* perf_event_name(PerfEvent ev);
+
+struct PerfSample {
+    uint64_t v[kPerfEventCount]{};
+};
+
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const { return opened_ > 0; }
+    bool has(PerfEvent ev) const { return fds_[(int)ev] >= 0; }
+
+    // why the first failing event could not be opened (empty if all opened)
+    const std::string& error() const { return error_; }
+
+    // reset + enable / disable all counters
+    void start();
+    void stop();
+
+    // current counts, scaled for multiplexing (missing events read as 0)
+    PerfSample read() const;
+
+private:
+    int fds_[kPerfEventCount];
+    int opened_ = 0;
+    std::string error_;
+};
+
+// Accumulates counter deltas over a number of items (events, renders, ...).
+struct PerfTotals {
+    uint64_t v[kPerfEventCount]{};
+    uint64_t items = 0;
+    uint64_t samples = 0;
+
+    void add(const PerfSample& begin, const PerfSample& end, uint64_t n_items) {
+        for (int i = 0; i < kPerfEventCount; ++i) {
+            v[i] += (end.v[i] >= begin.v[i]) ? (end.v[i] - begin.v[i]) : 0;
+        }
+        items += n_items;
+        samples++;
+    }
+
+    double per_item(PerfEvent ev) const {
+        return items ? (double)v[(int)ev] / (double)items : 0.0;
+    }
+
+    // {"cycles":{"total":..,"per_item":..},...,"ipc":..} for available events only
+    std::string to_json(const PerfCounters& pc) const;
+};
+
+} // namespace mbo
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace mbo {
+
+// Resident set size of this process (/proc/self/statm), 0 if unavailable.
+inline uint64_t process_rss_bytes() {
+    std::FILE* f = std::fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    unsigned long size = 0, resident = 0;
+    const int n = std::fscanf(f, "%lu %lu", &size, &resident);
+    std::fclose(f);
+    if (n != 2) return 0;
+    return (uint64_t)resident * (uint64_t)sysconf(_SC_PAGESIZE);
+}
+
+// Peak resident set size since process start (getrusage ru_maxrss, KiB on Linux).
+inline uint64_t process_peak_rss_bytes() {
+    struct rusage ru {};
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return (uint64_t)ru.ru_maxrss * 1024u;
+}
+
+} // namespace mbo
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+namespace mbo {
+
+// Kernel receive timestamps on a stream socket.
+//
+// Software RX timestamps are taken by the kernel when a packet enters the
+// network stack (loopback included, no NIC support needed) and are delivered
+// as ancillary data on recvmsg. For TCP the stamp describes the most recent
+// segment consumed by the read, so for a batch it is the arrival time of its
+// newest bytes: older lines in the same batch waited at least that long.
+// Stamps are CLOCK_REALTIME, comparable with std::chrono::system_clock.
+
+enum class RxTimestampMode {
+    None,          // not available; reads return rx_ns = 0
+    Timestamping,  // SO_TIMESTAMPING (RX_SOFTWARE | SOFTWARE)
+    TimestampNs,   // SO_TIMESTAMPNS fallback
+};
+
+const char* rx_timestamp_mode_name(RxTimestampMode m);
+
+// Turns on RX timestamps for `fd`, preferring SO_TIMESTAMPING.
+RxTimestampMode enable_rx_timestamps(int fd);
+
+// recvmsg() into buf; returns bytes read, 0 on EOF, -1 on error (errno set,
+// EINTR retried). rx_ns = kernel arrival time of the data, 0 if none came.
+ssize_t recv_with_rx_timestamp(int fd, char* buf, size_t len, int64_t& rx_ns);
+
+} // namespace mbo
@@ -2,6 +2,36 @@
 #include <memory>
 #include <string>
 
+// Latest-snapshot store shared between the ingest thread (publish) and the
+// WS sessions (load). Implementations are swappable behind this interface so
+// alternatives can be benchmarked (tools/bench/bench_store_contention) and
+// selected at startup (SNAPSHOT_STORE) without touching callers.
+class SnapshotStore {
+public:
+    virtual ~SnapshotStore() = default;
+
+    virtual const char* name() const = 0;
+
+    // publish the global (symbol-less) snapshot
+    virtual void publish(std::string s) = 0;
+    virtual void publish(const std::string& symbol, std::string s) = 0;
+
+    virtual std::shared_ptr<const std::string> load() const = 0;
+    // per-symbol snapshot; falls back to the global one if the symbol is unknown
+    virtual std::shared_ptr<const std::string> load(const std::string& symbol) const = 0;
+};
+
+// "shared_mutex" (default): one reader/writer lock around a symbol map.
+// "atomic": copy-on-write symbol index + per-symbol atomic shared_ptr slots;
+//           readers never touch a lock shared by every symbol.
+// Returns nullptr for an unknown kind.
+std::unique_ptr<SnapshotStore> make_snapshot_store(const std::string& kind);
+
+// Process-wide store used by the free functions below. Replace it only at
+// startup, before any publisher / reader thread runs.
+SnapshotStore& snapshot_store();
+void set_snapshot_store(std::unique_ptr<SnapshotStore> store);
+
 void publish_snapshot(std::string s);
 std::shared_ptr<const std::string> load_snapshot();
 
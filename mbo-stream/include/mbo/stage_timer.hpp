@@ -0,0 +1,179 @@
+#pragma once
+#include "mbo/hdr_histogram.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MBO_HAVE_TSC 1
+#else
+#define MBO_HAVE_TSC 0
+#endif
+
+namespace mbo {
+
+struct StageMetric;
+
+// Sampled per-stage timers for the ingest hot path.
+//
+// Timestamps come from the TSC (rdtsc at scope entry, rdtscp at exit), which
+// costs a few ns instead of two clock_gettime calls; ticks are converted to ns
+// with a factor calibrated once against steady_clock. Each stage samples
+// 1-in-N of its own occurrences (STAGE_SAMPLE_EVERY, 0 = off), so a scope that
+// is not sampled costs one counter decrement.
+//
+// Building with -DMBO_STAGE_TIMERS=0 (make STAGE_TIMERS=0) makes kStageTimers
+// false: sample() is constant false, so StageScope and its call sites compile
+// away.
+#ifndef MBO_STAGE_TIMERS
+#define MBO_STAGE_TIMERS 1
+#endif
+constexpr bool kStageTimers = MBO_STAGE_TIMERS != 0;
+
+enum class Stage : int {
+    Read = 0,       // socket read_some (includes waiting for data)
+    Frame,          // carving one line out of the read buffer
+    Parse,          // CSV line -> MboEvent
+    Apply,          // MboOrderBook::apply
+    SnapshotBuild,  // MboOrderBook::to_json
+    Publish,        // WS frame build + snapshot store publish
+    Feed,           // JSONL feed write
+    Enqueue,        // top_of_book + PG queue push
+};
+
+constexpr int kStageCount = 8;
+
+const char* stage_name(Stage s);
+
+// TSC -> ns conversion, calibrated on first use. Falls back to steady_clock
+// (1 tick = 1 ns) on non-x86 builds or when the TSC is not invariant.
+struct TscClock {
+    bool use_tsc = false;
+    double ns_per_tick = 1.0;
+    double ghz = 0.0;         // 0 when falling back to steady_clock
+
+    static const TscClock& get();
+
+    uint64_t to_ns(uint64_t ticks) const { return (uint64_t)((double)ticks * ns_per_tick); }
+};
+
+inline uint64_t steady_now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Scope entry: rdtsc after lfence so earlier loads don't drift into the region.
+inline uint64_t stage_ticks_begin(bool use_tsc) {
+#if MBO_HAVE_TSC
+    if (use_tsc) {
+        _mm_lfence();
+        return __rdtsc();
+    }
+#endif
+    (void)use_tsc;
+    return steady_now_ns();
+}
+
+// Scope exit: rdtscp waits for the timed instructions to retire.
+inline uint64_t stage_ticks_end(bool use_tsc) {
+#if MBO_HAVE_TSC
+    if (use_tsc) {
+        unsigned aux;
+        const uint64_t t = __rdtscp(&aux);
+        _mm_lfence();
+        return t;
+    }
+#endif
+    (void)use_tsc;
+    return steady_now_ns();
+}
+
+class StageTimers {
+public:
+    explicit StageTimers(int sample_every = 0, int hist_digits = 3);
+
+    int sample_every() const { return every_; }
+    bool enabled() const { return kStageTimers && every_ > 0; }
+
+    // true for 1-in-N calls per stage (first call included)
+    bool sample(Stage s) {
+        if constexpr (!kStageTimers) {
+            (void)s;
+            return false;
+        } else {
+            if (every_ <= 0) return false;
+            int& c = countdown_[(int)s];
+            if (--c > 0) return false;
+            c = every_;
+            return true;
+        }
+    }
+
+    bool use_tsc() const { return use_tsc_; }
+
+    // sampled path only (out of line)
+    void record_ticks(Stage s, uint64_t ticks);
+
+    // also feed every sample into sinks[kStageCount] (the live metrics histograms)
+    void attach(StageMetric* sinks) { sinks_ = sinks; }
+
+    // Samples land in a per-interval histogram; roll_interval() folds it into
+    // the session totals and starts a new interval. hist() is the session
+    // total as of the last roll, so roll once more before reading it at the end.
+    const HdrHistogram& hist(Stage s) const { return total_[(int)s]; }
+    const HdrHistogram& interval(Stage s) const { return interval_[(int)s]; }
+    void roll_interval();
+    void reset();
+
+    // {"sample_every":N,"clock":"tsc","tsc_ghz":..,"read":{..us..},..}; stages
+    // without samples are omitted. to_json() = session totals,
+    // interval_json() = current interval.
+    std::string to_json() const;
+    std::string interval_json() const;
+
+private:
+    int every_;
+    bool use_tsc_;
+    const TscClock* clock_;
+    StageMetric* sinks_ = nullptr;
+    int countdown_[kStageCount];
+    HdrHistogram interval_[kStageCount];
+    HdrHistogram total_[kStageCount];
+
+    std::string json_of(const HdrHistogram* hs) const;
+};
+
+// RAII sample of one stage. Not sampled => no clock read at all.
+class StageScope {
+public:
+    StageScope(StageTimers& t, Stage s) {
+        if constexpr (kStageTimers) {
+            if (t.sample(s)) {
+                t_ = &t;
+                s_ = s;
+                t0_ = stage_ticks_begin(t.use_tsc());
+            }
+        } else {
+            (void)t;
+            (void)s;
+        }
+    }
+
+    ~StageScope() {
+        if constexpr (kStageTimers) {
+            if (t_) t_->record_ticks(s_, stage_ticks_end(t_->use_tsc()) - t0_);
+        }
+    }
+
+    StageScope(const StageScope&) = delete;
+    StageScope& operator=(const StageScope&) = delete;
+
+private:
+    StageTimers* t_ = nullptr;
+    Stage s_ = Stage::Read;
+    uint64_t t0_ = 0;
+};
+
+} // namespace mbo
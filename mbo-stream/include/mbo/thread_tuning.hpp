@@ -0,0 +1,69 @@
+#pragma once
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+namespace mbo {
+
+// Thread placement for the engine: CPU pinning, SCHED_FIFO and busy-poll.
+//
+// The ingest/apply thread is the latency-critical one. Pinning it to its own
+// core (ideally isolated with isolcpus/nohz_full) removes migrations and cache
+// refills; SCHED_FIFO keeps ordinary tasks from preempting it; busy-poll
+// removes the wakeup after every read. WS fan-out and the writer threads
+// (PG, bench log, /metrics) get their own CPU sets so they stop sharing the
+// ingest core.
+//
+// Everything here is best effort: a failure (bad CPU, no CAP_SYS_NICE) is
+// reported through `err` and the engine carries on with default scheduling.
+
+// "2", "2,4", "4-7", "0,2-3" -> sorted CPU ids. Empty string => empty list.
+// Returns false on a malformed list.
+bool parse_cpu_list(const std::string& s, std::vector<int>& out);
+
+// "2,4-7" for logs ("" for an empty list)
+std::string format_cpu_list(const std::vector<int>& cpus);
+
+// Restricts `t` to `cpus` (no-op for an empty list).
+bool pin_thread(pthread_t t, const std::vector<int>& cpus, std::string& err);
+inline bool pin_current_thread(const std::vector<int>& cpus, std::string& err) {
+    return pin_thread(pthread_self(), cpus, err);
+}
+
+// SCHED_FIFO at `priority` (1..99) for the calling thread; 0 => no change.
+// Needs CAP_SYS_NICE or an RLIMIT_RTPRIO allowance. A FIFO thread that spins
+// can starve its core; the kernel's RT throttling (sched_rt_runtime_us) is the
+// safety net, so pair it with a dedicated CPU.
+bool set_current_thread_fifo(int priority, std::string& err);
+
+// Remembers the calling thread's CPU set and scheduling policy as the process
+// default. Call once at startup, before anything is pinned or made FIFO.
+void capture_default_placement();
+
+// Puts `t` back on the captured CPU set and policy. Threads started from the
+// pinned SCHED_FIFO ingest thread inherit its placement; helper threads call
+// this before taking their own. No-op (true) if nothing was captured.
+bool restore_default_placement(pthread_t t, std::string& err);
+
+// Same for the calling thread with sched_setaffinity / sched_setscheduler
+// only: no allocation, async-signal-safe, usable in a forked child.
+void restore_default_placement_self();
+
+// SO_BUSY_POLL: the kernel polls the device queue for up to `usec` on a read
+// that would otherwise find the socket empty. Values above
+// net.core.busy_read need CAP_NET_ADMIN. No effect on loopback.
+bool enable_socket_busy_poll(int fd, int usec, std::string& err);
+
+// Names the calling thread (visible in top -H / perf); truncated to 15 chars.
+void name_current_thread(const char* name);
+
+// Pause hint for spin loops.
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+} // namespace mbo
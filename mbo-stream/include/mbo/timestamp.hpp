@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace mbo {
+
+// ISO-8601 UTC timestamps as used by the Databento CSV export:
+//   2025-09-24T19:30:00.001385399Z
+// converted to / from UNIX epoch nanoseconds without going through tm/timegm.
+
+constexpr std::size_t kIsoNsLen = 30; // length of the canonical form above
+
+// Parse "YYYY-MM-DDTHH:MM:SS[.f{1,9}][Z]". Returns false on malformed input.
+bool parse_iso8601_ns(std::string_view s, int64_t& out_ns);
+
+// Write the canonical 30-char form into out (no terminator). Returns kIsoNsLen.
+std::size_t format_iso8601_ns(int64_t ns, char* out);
+
+std::string iso8601_ns(int64_t ns);
+
+} // namespace mbo
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mbo {
+
+// Fixed-size thread pool with one task deque per worker and work stealing,
+// for offline batch jobs (batch_replay.hpp).
+//
+// A task submitted from a worker goes to the back of that worker's own deque
+// and the worker pops from the back (LIFO: the freshest task, whose data is
+// still in cache). An idle worker steals from the front of another deque
+// (FIFO: the oldest, typically biggest, piece of work). Tasks submitted from
+// outside the pool are dealt round-robin. So a task that splits its work
+// into sub-tasks (a file into instruments) keeps them local until other
+// workers run dry and take them.
+//
+// Each deque has its own mutex: tasks here are milliseconds to seconds long,
+// so a lock per push/pop is noise, and it keeps the pool simple to reason
+// about. Idle workers sleep on a condition variable.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads == 0 => std::thread::hardware_concurrency(). Workers are named
+    // "<name>-<i>".
+    explicit WorkStealingPool(unsigned threads = 0, const std::string& name = "mbo-pool");
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task t);
+
+    // Blocks until every submitted task, including those submitted by tasks,
+    // has run. Rethrows the first exception a task threw (the rest still ran).
+    void wait();
+
+    unsigned size() const { return (unsigned)workers_.size(); }
+
+    // index of the calling worker in this pool, -1 outside it
+    int current_worker() const;
+
+    uint64_t tasks_run() const { return run_total_.load(std::memory_order_relaxed); }
+    uint64_t steals() const { return steal_total_.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex m;
+        std::deque<Task> q;
+        std::thread thread;
+    };
+
+    bool pop_local_(unsigned self, Task& out);
+    bool steal_(unsigned self, Task& out);
+    void run_(unsigned self, std::string name);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex idle_m_;
+    std::condition_variable idle_cv_;   // tasks queued / stop
+    std::condition_variable done_cv_;   // pending_ reached 0
+    std::atomic<int64_t> queued_{0};    // in some deque (briefly < 0 around a push)
+    uint64_t pending_ = 0;              // submitted, not finished (under idle_m_)
+    bool stop_ = false;
+    std::exception_ptr error_;          // first task exception (under idle_m_)
+
+    std::atomic<unsigned> next_{0};     // round-robin for outside submits
+    std::atomic<uint64_t> run_total_{0};
+    std::atomic<uint64_t> steal_total_{0};
+};
+
+} // namespace mbo
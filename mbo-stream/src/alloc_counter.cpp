@@ -0,0 +1,106 @@
+#include "mbo/alloc_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+namespace mbo {
+
+namespace {
+// Plain-old-data TLS: no constructor, so it is safe to touch from operator new
+// before / during static initialisation and on any thread.
+thread_local AllocCounts t_counts;
+} // namespace
+
+AllocCounts thread_alloc_counts() { return t_counts; }
+
+std::string AllocTotals::to_json() const {
+    std::ostringstream oss;
+    oss.precision(6);
+    oss << "{\"allocs\":" << allocs
+        << ",\"frees\":" << frees
+        << ",\"bytes\":" << bytes
+        << ",\"items\":" << items
+        << ",\"allocs_per_item\":" << allocs_per_item()
+        << ",\"bytes_per_item\":" << bytes_per_item()
+        << "}";
+    return oss.str();
+}
+
+} // namespace mbo
+
+#if defined(MBO_ALLOC_COUNT)
+
+// ----------------------- global operator new / delete -----------------------
+
+namespace {
+
+inline void* counted_alloc(std::size_t n) {
+    if (n == 0) n = 1;
+    void* p = std::malloc(n);
+    if (p) {
+        mbo::t_counts.allocs++;
+        mbo::t_counts.bytes += n;
+    }
+    return p;
+}
+
+inline void* counted_alloc_aligned(std::size_t n, std::align_val_t al) {
+    if (n == 0) n = 1;
+    std::size_t a = static_cast<std::size_t>(al);
+    if (a < sizeof(void*)) a = sizeof(void*);
+    void* p = nullptr;
+    if (posix_memalign(&p, a, n) != 0) return nullptr;
+    mbo::t_counts.allocs++;
+    mbo::t_counts.bytes += n;
+    return p;
+}
+
+inline void counted_free(void* p) noexcept {
+    if (!p) return;
+    mbo::t_counts.frees++;
+    std::free(p);
+}
+
+} // namespace
+
+void* operator new(std::size_t n) {
+    if (void* p = counted_alloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) {
+    if (void* p = counted_alloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return counted_alloc(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return counted_alloc(n); }
+
+void* operator new(std::size_t n, std::align_val_t al) {
+    if (void* p = counted_alloc_aligned(n, al)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n, std::align_val_t al) {
+    if (void* p = counted_alloc_aligned(n, al)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t n, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return counted_alloc_aligned(n, al);
+}
+void* operator new[](std::size_t n, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return counted_alloc_aligned(n, al);
+}
+
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p); }
+
+#endif // MBO_ALLOC_COUNT
@@ -1,4 +1,5 @@
 #include "mbo/app_config.hpp"
+#include "mbo/thread_tuning.hpp"
 
 #include <cstdlib>
 #include <cctype>
@@ -42,7 +43,33 @@ void usage(const char* prog) {
         << "Env: PG_CONNINFO=\"host=127.0.0.1 port=5432 dbname=batonic user=postgres password=postgres\"\n"
         << "Env: FEED_ENABLED=1 (optional)\n"
         << "Env: FEED_PATH=frontend/public/snapshots_feed.jsonl (optional)\n"
-        << "Env: BENCH_LOG_PATH=frontend/public/benchmarks.jsonl (optional)\n";
+        << "Env: BENCH_LOG_PATH=frontend/public/benchmarks.jsonl (optional)\n"
+        << "Env: MAX_SESSIONS=1 (optional, exit after N replay sessions)\n"
+        << "Env: PERF_COUNTERS=1 PERF_SAMPLE_EVERY=64 (optional, hardware counters)\n"
+        << "Env: SNAPSHOT_STORE=shared_mutex|atomic (optional, snapshot store implementation)\n"
+        << "Env: STAGE_SAMPLE_EVERY=16 (optional, 1-in-N per-stage TSC timers; 0 = off)\n"
+        << "Env: BENCH_INTERVAL_S=10 (optional, interval bench lines; 0 = session summary only)\n"
+        << "Env: CATCHUP_BACKLOG_BYTES=0 CATCHUP_LAG_MS=0 CATCHUP_PUBLISH_MS=250 (optional, catch-up mode, off by default; 0 = signal off)\n"
+        << "Env: RX_TIMESTAMPS=1 (optional, kernel receive timestamps -> parse -> apply latency; 0 = plain reads)\n"
+        << "Env: FEED_LATENCY_WINDOW_S=60 (optional, per-symbol exchange->engine latency window in event time; 0 = off)\n"
+        << "Env: INGEST_CPUS=2 WS_CPUS=3 WRITER_CPUS=4-5 (optional, pin engine threads to CPU lists)\n"
+        << "Env: INGEST_RT_PRIO=0 (optional, SCHED_FIFO priority 1..99 for the ingest thread; needs CAP_SYS_NICE)\n"
+        << "Env: BUSY_POLL=0 BUSY_POLL_US=50 (optional, spin on a non-blocking feed socket; SO_BUSY_POLL budget)\n"
+        << "Env: BOOK_ARENA_ORDERS=0 BOOK_ARENA_PAGES=thp BOOK_ARENA_PREFAULT=1 BOOK_ARENA_MLOCK=0 (optional, huge-page book node arena; pages thp|hugetlb|4k)\n"
+        << "Env: FEED_RESUME=1 (optional, keep the book across a dropped feed and resume by sequence; 0 = fresh replay per session)\n"
+        << "Env: CHECKPOINT_PATH=book.ckpt (optional, periodic binary book checkpoint; loaded at startup to resume)\n"
+        << "Env: CHECKPOINT_INTERVAL_S=60 (optional, seconds between checkpoints, >= 1)\n"
+        << "Env: CHECKPOINT_LOAD=1 (optional, 0 = write checkpoints but start cold)\n"
+        << "Env: JOURNAL_DIR=journal/ (optional, append-only binary journal of applied events)\n"
+        << "Env: JOURNAL_SEGMENT_MB=64 (optional, preallocated segment size, 1..4096)\n"
+        << "Env: JOURNAL_SYNC=1 (optional, msync + fsync each finished segment)\n"
+        << "Env: JOURNAL_RECOVER=1 (optional, replay the journal after the checkpoint at startup)\n"
+        << "Env: JOURNAL_PRUNE=1 (optional, delete segments behind the oldest kept checkpoint; 0 = keep everything)\n"
+        << "Env: CHECKPOINT_KEEP=24 (optional, history checkpoints kept in JOURNAL_DIR for as-of queries, 0 = none)\n"
+        << "Env: ASOF=1 (optional, serve as-of book queries from JOURNAL_DIR: GET /asof on METRICS_PORT, WS {\"type\":\"asof\"})\n"
+        << "Env: METRICS_PORT=9464 (optional, Prometheus GET /metrics listener)\n"
+        << "Env: LOG_LEVEL=info LOG_PATH= (optional, async logger: error|warn|info|debug|trace; debug adds the per-snapshot BBO dump)\n"
+        << "Env: HIST_DIGITS=3 (optional, latency histogram significant digits 1..5)\n";
 }
 
 AppConfig parse_config(int argc, char** argv) {
@@ -84,6 +111,161 @@ AppConfig parse_config(int argc, char** argv) {
         cfg.pg_conninfo.clear();
     }
 
+    // session limit env
+    if (const char* ms = std::getenv("MAX_SESSIONS"); ms && *ms) {
+        cfg.max_sessions = std::atoi(ms);
+    }
+    if (cfg.max_sessions < 0) cfg.max_sessions = 0;
+
+    // perf counters env
+    cfg.perf_counters = env_truthy(std::getenv("PERF_COUNTERS"));
+    if (const char* pe = std::getenv("PERF_SAMPLE_EVERY"); pe && *pe) {
+        cfg.perf_sample_every = std::atoi(pe);
+    }
+    if (cfg.perf_sample_every < 1) cfg.perf_sample_every = 1;
+
+    // snapshot store env
+    if (const char* ss = std::getenv("SNAPSHOT_STORE"); ss && *ss) {
+        cfg.snapshot_store = ss;
+    }
+
+    // stage timers env
+    if (const char* se = std::getenv("STAGE_SAMPLE_EVERY"); se && *se) {
+        cfg.stage_sample_every = std::atoi(se);
+    }
+    if (cfg.stage_sample_every < 0) cfg.stage_sample_every = 0;
+
+    // interval bench lines env
+    if (const char* bi = std::getenv("BENCH_INTERVAL_S"); bi && *bi) {
+        cfg.bench_interval_s = std::atof(bi);
+    }
+    if (cfg.bench_interval_s < 0) cfg.bench_interval_s = 0;
+
+    // catch-up mode env
+    if (const char* cb = std::getenv("CATCHUP_BACKLOG_BYTES"); cb && *cb) {
+        cfg.catchup_backlog_bytes = std::atoll(cb);
+    }
+    if (cfg.catchup_backlog_bytes < 0) cfg.catchup_backlog_bytes = 0;
+    if (const char* cl = std::getenv("CATCHUP_LAG_MS"); cl && *cl) {
+        cfg.catchup_lag_ms = std::atoll(cl);
+    }
+    if (cfg.catchup_lag_ms < 0) cfg.catchup_lag_ms = 0;
+    if (const char* cp = std::getenv("CATCHUP_PUBLISH_MS"); cp && *cp) {
+        cfg.catchup_publish_ms = std::atoi(cp);
+    }
+    if (cfg.catchup_publish_ms < 0) cfg.catchup_publish_ms = 0;
+
+    // kernel RX timestamps env (default on)
+    if (const char* rx = std::getenv("RX_TIMESTAMPS"); rx && *rx) {
+        cfg.rx_timestamps = env_truthy(rx);
+    }
+
+    // feed latency env
+    if (const char* fl = std::getenv("FEED_LATENCY_WINDOW_S"); fl && *fl) {
+        cfg.feed_latency_window_s = std::atof(fl);
+    }
+    if (cfg.feed_latency_window_s < 0) cfg.feed_latency_window_s = 0;
+
+    // thread placement env
+    auto cpu_env = [](const char* name, std::vector<int>& out) {
+        const char* v = std::getenv(name);
+        if (!v || !*v) return;
+        if (!mbo::parse_cpu_list(v, out)) {
+            std::cerr << "[cpu] ignoring malformed " << name << "=" << v << "\n";
+            out.clear();
+        }
+    };
+    cpu_env("INGEST_CPUS", cfg.ingest_cpus);
+    cpu_env("WS_CPUS", cfg.ws_cpus);
+    cpu_env("WRITER_CPUS", cfg.writer_cpus);
+    if (const char* rp = std::getenv("INGEST_RT_PRIO"); rp && *rp) {
+        cfg.ingest_rt_prio = std::atoi(rp);
+    }
+    if (cfg.ingest_rt_prio < 0) cfg.ingest_rt_prio = 0;
+    if (cfg.ingest_rt_prio > 99) cfg.ingest_rt_prio = 99;
+    cfg.busy_poll = env_truthy(std::getenv("BUSY_POLL"));
+    if (const char* bp = std::getenv("BUSY_POLL_US"); bp && *bp) {
+        cfg.busy_poll_us = std::atoi(bp);
+    }
+    if (cfg.busy_poll_us < 0) cfg.busy_poll_us = 0;
+
+    // book arena env
+    if (const char* ba = std::getenv("BOOK_ARENA_ORDERS"); ba && *ba) {
+        cfg.book_arena_orders = std::atoll(ba);
+    }
+    if (cfg.book_arena_orders < 0) cfg.book_arena_orders = 0;
+    if (cfg.book_arena_orders > 100'000'000) cfg.book_arena_orders = 100'000'000;
+    if (const char* bp = std::getenv("BOOK_ARENA_PAGES"); bp && *bp) {
+        cfg.book_arena_pages = bp;
+    }
+    if (cfg.book_arena_pages != "thp" && cfg.book_arena_pages != "hugetlb" && cfg.book_arena_pages != "4k") {
+        std::cerr << "[arena] unknown BOOK_ARENA_PAGES=" << cfg.book_arena_pages << ", using thp\n";
+        cfg.book_arena_pages = "thp";
+    }
+    if (const char* bf = std::getenv("BOOK_ARENA_PREFAULT"); bf && *bf) {
+        cfg.book_arena_prefault = env_truthy(bf);
+    }
+    cfg.book_arena_mlock = env_truthy(std::getenv("BOOK_ARENA_MLOCK"));
+
+    // feed resume env (default on)
+    if (const char* fr = std::getenv("FEED_RESUME"); fr && *fr) {
+        cfg.feed_resume = env_truthy(fr);
+    }
+
+    // book checkpoint env
+    if (const char* cp = std::getenv("CHECKPOINT_PATH"); cp && *cp) {
+        cfg.checkpoint_path = cp;
+    }
+    if (const char* ci = std::getenv("CHECKPOINT_INTERVAL_S"); ci && *ci) {
+        cfg.checkpoint_interval_s = std::atof(ci);
+    }
+    if (cfg.checkpoint_interval_s < 1.0) cfg.checkpoint_interval_s = 1.0;
+    if (const char* cl = std::getenv("CHECKPOINT_LOAD"); cl && *cl) {
+        cfg.checkpoint_load = env_truthy(cl);
+    }
+
+    // event journal env
+    if (const char* jd = std::getenv("JOURNAL_DIR"); jd && *jd) {
+        cfg.journal_dir = jd;
+    }
+    if (const char* js = std::getenv("JOURNAL_SEGMENT_MB"); js && *js) {
+        cfg.journal_segment_mb = std::atoi(js);
+    }
+    if (cfg.journal_segment_mb < 1) cfg.journal_segment_mb = 1;
+    if (cfg.journal_segment_mb > 4096) cfg.journal_segment_mb = 4096;
+    if (const char* jy = std::getenv("JOURNAL_SYNC"); jy && *jy) {
+        cfg.journal_sync = env_truthy(jy);
+    }
+    if (const char* jr = std::getenv("JOURNAL_RECOVER"); jr && *jr) {
+        cfg.journal_recover = env_truthy(jr);
+    }
+    if (const char* jp = std::getenv("JOURNAL_PRUNE"); jp && *jp) {
+        cfg.journal_prune = env_truthy(jp);
+    }
+
+    // as-of query env
+    if (const char* ck = std::getenv("CHECKPOINT_KEEP"); ck && *ck) {
+        cfg.checkpoint_keep = std::atoi(ck);
+    }
+    if (cfg.checkpoint_keep < 0) cfg.checkpoint_keep = 0;
+    if (cfg.checkpoint_keep > 100000) cfg.checkpoint_keep = 100000;
+    if (const char* ao = std::getenv("ASOF"); ao && *ao) {
+        cfg.asof = env_truthy(ao);
+    }
+
+    // metrics listener env
+    if (const char* mp = std::getenv("METRICS_PORT"); mp && *mp) {
+        cfg.metrics_port = std::atoi(mp);
+    }
+    if (cfg.metrics_port < 0 || cfg.metrics_port > 65535) cfg.metrics_port = 0;
+
+    // histogram precision env
+    if (const char* hd = std::getenv("HIST_DIGITS"); hd && *hd) {
+        cfg.hist_digits = std::atoi(hd);
+    }
+    if (cfg.hist_digits < 1) cfg.hist_digits = 1;
+    if (cfg.hist_digits > 5) cfg.hist_digits = 5;
+
     return cfg;
 }
 
@@ -0,0 +1,206 @@
+#include "mbo/as_of.hpp"
+#include "mbo/event_journal.hpp"
+#include "mbo/timestamp.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace mbo {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+std::atomic<AsOfService*> g_service{nullptr};
+
+} // namespace
+
+bool BookAsOf::seek(int64_t ts_ns, AsOfStats& st, std::string& err) {
+    st = AsOfStats{};
+    const auto t0 = Clock::now();
+
+    JournalReader reader;
+    if (!reader.open(dir_, err)) return false;
+    const uint64_t first = reader.first_index();
+    const uint64_t end = reader.end_index();
+
+    // newest history checkpoint at or before T that the journal can continue
+    std::vector<CheckpointFile> hist;
+    std::string herr;
+    list_checkpoint_history(dir_, hist, herr);   // no history: replay from the start
+    const CheckpointFile* chosen = nullptr;
+    for (auto it = hist.rbegin(); it != hist.rend(); ++it) {
+        if (it->journal_index < first || it->journal_index > end) continue;
+        CheckpointMeta m;
+        std::string merr;
+        if (!read_checkpoint_meta(it->path, m, merr) || m.journal_index != it->journal_index) continue;
+        if (m.last_ts_ns <= ts_ns) {
+            chosen = &*it;
+            break;
+        }
+    }
+    const uint64_t start = chosen ? chosen->journal_index : first;
+    if (!chosen && first != 0) {
+        err = "no checkpoint at or before T and the journal starts at index " + std::to_string(first);
+        return false;
+    }
+
+    // continue from the last seek, or load the seek point
+    // (the kept book went through `start`, so it is the checkpoint rolled forward)
+    if (valid_ && next_ >= start && next_ <= end && last_ts_ <= ts_ns) {
+        st.from_cache = true;
+    } else if (chosen) {
+        valid_ = false;
+        book_ = MboOrderBook();
+        CheckpointMeta m;
+        if (!read_book_checkpoint(chosen->path, book_, m, err)) return false;
+        next_ = chosen->journal_index;
+        last_seq_ = m.last_seq;
+        last_ts_ = m.last_ts_ns;
+        valid_ = true;
+    } else {
+        book_ = MboOrderBook();
+        next_ = 0;
+        last_seq_ = 0;
+        last_ts_ = 0;
+        valid_ = true;
+    }
+    st.checkpoint_index = chosen ? chosen->journal_index : CheckpointMeta::kNoJournalIndex;
+    st.load_ms = ms_since(t0);
+
+    // replay up to the first record after T
+    const auto t1 = Clock::now();
+    MboEvent e;
+    bool past = false;
+    uint64_t applied = 0;
+    reader.scan(next_, end, [&](const MboRecord* recs, size_t n, uint64_t) {
+        for (size_t i = 0; i < n; ++i) {
+            const MboRecord& r = recs[i];
+            if (r.rtype != kRtypeJournalReset && r.ts_event_ns > ts_ns) {
+                past = true;
+                return false;
+            }
+            if (book_.symbol().empty() && r.symbol[0]) book_ = MboOrderBook(record_symbol(r));
+            book_event_from_record(r, e);
+            book_.apply(e);
+            ++applied;
+            if (r.rtype != kRtypeJournalReset) {
+                last_seq_ = r.sequence;
+                last_ts_ = r.ts_event_ns;
+            }
+        }
+        return true;
+    }, &err);
+    next_ += applied;
+    st.replay_ms = ms_since(t1);
+
+    st.complete = past;
+    st.replayed = applied;
+    st.next_index = next_;
+    st.last_seq = last_seq_;
+    st.last_ts_ns = last_ts_;
+    err.clear();   // a scan stopped early still leaves a consistent book
+    return true;
+}
+
+std::string BookAsOf::to_json(int64_t ts_ns, int depth, const AsOfStats& st) const {
+    std::ostringstream oss;
+    oss << "{\"type\":\"asof\",\"ts\":\"" << iso8601_ns(ts_ns) << "\""
+        << ",\"complete\":" << (st.complete ? "true" : "false")
+        << ",\"checkpoint\":";
+    if (st.checkpoint_index == CheckpointMeta::kNoJournalIndex) oss << "null";
+    else oss << st.checkpoint_index;
+    oss << ",\"cached\":" << (st.from_cache ? "true" : "false")
+        << ",\"replayed\":" << st.replayed
+        << ",\"next_index\":" << st.next_index
+        << ",\"last_seq\":" << st.last_seq
+        << ",\"last_ts\":\"" << (st.last_ts_ns ? iso8601_ns(st.last_ts_ns) : std::string()) << "\""
+        << ",\"ms\":" << (st.load_ms + st.replay_ms)
+        << ",\"book\":" << book_.to_json(depth) << "}";
+    return oss.str();
+}
+
+bool parse_asof_time(const std::string& s, int64_t& ts_ns) {
+    if (s.empty()) return false;
+    if (parse_iso8601_ns(s, ts_ns)) return true;
+    char* end = nullptr;
+    const long long v = std::strtoll(s.c_str(), &end, 10);
+    if (end != s.c_str() + s.size()) return false;
+    ts_ns = v;
+    return true;
+}
+
+std::string asof_error_json(const std::string& err) {
+    std::string out = "{\"type\":\"asof_error\",\"error\":\"";
+    for (char c : err) {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char)c >= 0x20) out += c;
+    }
+    return out + "\"}";
+}
+
+// ----------------------- service -----------------------
+
+AsOfService::AsOfService(std::string journal_dir, size_t max_queued)
+    : asof_(std::move(journal_dir)), max_queued_(max_queued), thread_([this] { run(); }) {}
+
+AsOfService::~AsOfService() {
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+void AsOfService::submit(int64_t ts_ns, int depth, Done done) {
+    bool stopping;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stopping = stop_;   // the worker no longer drains the queue
+        if (!stopping && queue_.size() < max_queued_) {
+            queue_.push_back(Query{ts_ns, depth, std::move(done)});
+            cv_.notify_one();
+            return;
+        }
+    }
+    if (stopping) done(false, asof_error_json("shutting down"));
+    else done(false, asof_error_json("busy: " + std::to_string(max_queued_) + " queries queued"));
+}
+
+void AsOfService::run() {
+    for (;;) {
+        Query q;
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            cv_.wait(lk, [&] { return stop_ || !queue_.empty(); });
+            if (stop_) {
+                // answer what is still queued so no request waits forever
+                std::deque<Query> left;
+                left.swap(queue_);
+                lk.unlock();
+                for (auto& p : left) p.done(false, asof_error_json("shutting down"));
+                return;
+            }
+            q = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        AsOfStats st;
+        std::string err;
+        if (asof_.seek(q.ts_ns, st, err)) q.done(true, asof_.to_json(q.ts_ns, q.depth, st));
+        else q.done(false, asof_error_json(err));
+    }
+}
+
+void set_asof_service(AsOfService* svc) { g_service.store(svc, std::memory_order_release); }
+
+AsOfService* asof_service() { return g_service.load(std::memory_order_acquire); }
+
+} // namespace mbo
@@ -0,0 +1,114 @@
+#include "mbo/async_jsonl_writer.hpp"
+
+#include <filesystem>
+#include <iostream>
+
+namespace mbo {
+
+AsyncJsonlWriter::AsyncJsonlWriter(const std::string& path, bool append) {
+    open(path, append);
+}
+
+AsyncJsonlWriter::~AsyncJsonlWriter() {
+    close();
+}
+
+bool AsyncJsonlWriter::open(const std::string& path, bool append) {
+    close();
+    path_ = path;
+
+    std::filesystem::path fp(path);
+    std::error_code ec;
+    if (fp.has_parent_path()) {
+        std::filesystem::create_directories(fp.parent_path(), ec);
+    }
+
+    auto mode = std::ios::binary | (append ? std::ios::app : std::ios::trunc);
+    ofs_.open(path, mode);
+    if (!ofs_) {
+        std::cerr << "[jsonl] failed to open: " << path << "\n";
+        return false;
+    }
+
+    stop_ = false;
+    running_ = true;
+    thread_ = std::thread([this] { run(); });
+    return true;
+}
+
+void AsyncJsonlWriter::write_line(const std::string& line) {
+    if (!running_) return;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (pending_.size() + line.size() + 1 > max_pending_bytes) {
+            dropped_++;
+            return;
+        }
+        pending_ += line;
+        pending_ += '\n';
+        queued_seq_++;
+    }
+    cv_.notify_one();
+}
+
+void AsyncJsonlWriter::flush() {
+    if (!running_) return;
+    std::unique_lock<std::mutex> lk(mtx_);
+    const uint64_t target = queued_seq_;
+    cv_.notify_one();
+    done_cv_.wait(lk, [&] { return written_seq_ >= target; });
+}
+
+void AsyncJsonlWriter::close() {
+    if (!running_) return;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+    running_ = false;
+    ofs_.close();
+    if (dropped_ > 0) {
+        std::cerr << "[jsonl] " << path_ << ": dropped " << dropped_ << " line(s) (writer backlog)\n";
+    }
+}
+
+uint64_t AsyncJsonlWriter::dropped_lines() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return dropped_;
+}
+
+void AsyncJsonlWriter::run() {
+    std::string batch;
+    while (true) {
+        uint64_t seq;
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            cv_.wait(lk, [&] { return stop_ || !pending_.empty(); });
+            batch.swap(pending_);
+            seq = queued_seq_;
+            stopping = stop_;
+        }
+
+        if (!batch.empty()) {
+            ofs_.write(batch.data(), (std::streamsize)batch.size());
+            ofs_.flush();
+            batch.clear();
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            written_seq_ = seq;
+        }
+        done_cv_.notify_all();
+
+        if (stopping) {
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (pending_.empty()) break;
+        }
+    }
+}
+
+} // namespace mbo
@@ -0,0 +1,286 @@
+#include "mbo/batch_replay.hpp"
+#include "mbo/csv_chunk_parser.hpp"
+#include "mbo/mbo_order_book.hpp"
+#include "mbo/timestamp.hpp"
+#include "mbo/work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+
+namespace mbo {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+int64_t floor_to(int64_t ts, int64_t step) {
+    const int64_t q = ts / step;
+    return (ts % step < 0 ? q - 1 : q) * step;
+}
+
+// NOTE: file names and symbols are written as is (no JSON escaping), as in
+// the rest of the engine's JSON output.
+void key_json(std::ostringstream& oss, const char* kind, const ReplayTaskKey& k) {
+    oss << "{\"kind\":\"" << kind << "\",\"file\":\"" << k.file << "\",\"instrument_id\":" << k.instrument_id
+        << ",\"symbol\":\"" << k.symbol << "\"";
+}
+
+// One (file, instrument) book: applies `recs` in order and emits to the sinks.
+ReplayTaskStats run_book_task(const BatchReplayOptions& opt, const ReplayTaskKey& key,
+                              const std::vector<MboRecord>& recs, int worker) {
+    const auto t0 = Clock::now();
+    ReplayTaskStats st;
+    st.key = key;
+    st.worker = worker;
+    st.events = recs.size();
+
+    MboOrderBook book(key.symbol, nullptr, recs.size() / 4);
+    std::vector<ReplayBar> bars;
+    std::vector<ReplaySnapshot> snaps;
+    auto flush = [&](bool force) {
+        if (!bars.empty() && (force || bars.size() >= opt.flush_every)) {
+            for (ReplaySink* s : opt.sinks) s->bars(key, bars);
+            bars.clear();
+        }
+        if (!snaps.empty() && (force || snaps.size() >= opt.flush_every)) {
+            for (ReplaySink* s : opt.sinks) s->snapshots(key, snaps);
+            snaps.clear();
+        }
+    };
+
+    ReplayBar bar;
+    bool in_bar = false;
+    auto close_bar = [&] {
+        bar.bid = book.best_bid();
+        bar.ask = book.best_ask();
+        bars.push_back(bar);
+        ++st.bars;
+    };
+    int64_t next_snap = 0;
+
+    MboEvent e;
+    for (size_t i = 0; i < recs.size(); ++i) {
+        const MboRecord& r = recs[i];
+        const int64_t ts = r.ts_event_ns;
+
+        if (opt.snapshot_ns > 0) {
+            if (i == 0) {
+                next_snap = floor_to(ts, opt.snapshot_ns) + opt.snapshot_ns;
+            } else if (ts >= next_snap) {
+                // one snapshot per quiet stretch: the book is the same at every boundary in it
+                snaps.push_back(ReplaySnapshot{floor_to(ts, opt.snapshot_ns), book.to_json(opt.snapshot_depth)});
+                ++st.snapshots;
+                next_snap = floor_to(ts, opt.snapshot_ns) + opt.snapshot_ns;
+            }
+        }
+        if (opt.bar_ns > 0) {
+            const int64_t b = floor_to(ts, opt.bar_ns);
+            if (in_bar && b != bar.start_ns) close_bar();
+            if (!in_bar || b != bar.start_ns) {
+                bar = ReplayBar{};
+                bar.start_ns = b;
+                in_bar = true;
+            }
+        }
+
+        book_event_from_record(r, e);
+        book.apply(e);
+
+        if (opt.bar_ns > 0) {
+            ++bar.events;
+            if (r.action == 'T') {
+                if (bar.trades == 0) bar.open = bar.high = bar.low = r.price;
+                bar.high = std::max(bar.high, r.price);
+                bar.low = std::min(bar.low, r.price);
+                bar.close = r.price;
+                bar.volume += r.size;
+                ++bar.trades;
+            }
+        }
+        if (r.action == 'T') ++st.trades;
+        flush(false);
+    }
+    if (in_bar) close_bar();
+    flush(true);
+
+    st.orders = book.order_count();
+    st.bid_levels = book.bid_levels();
+    st.ask_levels = book.ask_levels();
+    if (!recs.empty()) {
+        st.first_ts_ns = recs.front().ts_event_ns;
+        st.last_ts_ns = recs.back().ts_event_ns;
+    }
+    st.apply_ms = ms_since(t0);
+    for (ReplaySink* s : opt.sinks) s->stats(st);
+    return st;
+}
+
+} // namespace
+
+// ----------------------- JSONL sink -----------------------
+
+JsonlReplaySink::JsonlReplaySink(const std::string& bars_path, const std::string& snapshots_path,
+                                 const std::string& stats_path) {
+    auto open = [&](const std::string& p, FILE*& f) {
+        if (p.empty()) return;
+        f = std::fopen(p.c_str(), "w");
+        if (!f) ok_ = false;
+    };
+    open(bars_path, bars_);
+    open(snapshots_path, snaps_);
+    open(stats_path, stats_);
+}
+
+JsonlReplaySink::~JsonlReplaySink() {
+    for (FILE* f : {bars_, snaps_, stats_}) {
+        if (f) std::fclose(f);
+    }
+}
+
+void JsonlReplaySink::write_(FILE* f, const std::string& s) {
+    std::lock_guard<std::mutex> lk(m_);
+    std::fwrite(s.data(), 1, s.size(), f);
+}
+
+void JsonlReplaySink::bars(const ReplayTaskKey& k, const std::vector<ReplayBar>& v) {
+    if (!bars_) return;
+    std::ostringstream oss;
+    for (const ReplayBar& b : v) {
+        key_json(oss, "bar", k);
+        oss << ",\"ts\":\"" << iso8601_ns(b.start_ns) << "\",\"o\":" << b.open << ",\"h\":" << b.high
+            << ",\"l\":" << b.low << ",\"c\":" << b.close << ",\"v\":" << b.volume << ",\"trades\":" << b.trades
+            << ",\"events\":" << b.events << ",\"bid\":" << b.bid << ",\"ask\":" << b.ask << "}\n";
+    }
+    write_(bars_, oss.str());
+}
+
+void JsonlReplaySink::snapshots(const ReplayTaskKey& k, const std::vector<ReplaySnapshot>& v) {
+    if (!snaps_) return;
+    std::ostringstream oss;
+    for (const ReplaySnapshot& s : v) {
+        key_json(oss, "snapshot", k);
+        oss << ",\"ts\":\"" << iso8601_ns(s.ts_ns) << "\",\"book\":" << s.json << "}\n";
+    }
+    write_(snaps_, oss.str());
+}
+
+void JsonlReplaySink::stats(const ReplayTaskStats& s) {
+    if (!stats_) return;
+    std::ostringstream oss;
+    key_json(oss, "stats", s.key);
+    oss << ",\"events\":" << s.events << ",\"trades\":" << s.trades << ",\"bars\":" << s.bars
+        << ",\"snapshots\":" << s.snapshots << ",\"orders\":" << s.orders << ",\"bid_levels\":" << s.bid_levels
+        << ",\"ask_levels\":" << s.ask_levels << ",\"first_ts\":\"" << iso8601_ns(s.first_ts_ns)
+        << "\",\"last_ts\":\"" << iso8601_ns(s.last_ts_ns) << "\",\"apply_ms\":" << s.apply_ms
+        << ",\"worker\":" << s.worker << "}\n";
+    write_(stats_, oss.str());
+}
+
+// ----------------------- driver -----------------------
+
+bool load_replay_file(const std::string& path, std::vector<MboRecord>& out, std::string& err,
+                      unsigned parse_threads) {
+    out.clear();
+    if (is_mbo_record_path(path)) {
+        if (!read_mbo_records(path, out)) {
+            err = "cannot read " + path;
+            return false;
+        }
+        return true;
+    }
+    ParallelCsvOptions po;
+    po.threads = std::max(1u, parse_threads);
+    return parse_csv_file_parallel(
+        path, po,
+        [&](const MboRecord* recs, size_t n) {
+            out.insert(out.end(), recs, recs + n);   // header / bad lines already dropped
+            return true;
+        },
+        err);
+}
+
+bool run_batch_replay(const BatchReplayOptions& opt, BatchReplayResult& out) {
+    out = BatchReplayResult{};
+    const auto t0 = Clock::now();
+
+    std::mutex m;   // guards out
+    WorkStealingPool pool(opt.threads, "mbo-replay");
+    out.threads = pool.size();
+
+    auto wanted = [&](const MboRecord& r) {
+        if (!opt.instruments.empty() &&
+            std::find(opt.instruments.begin(), opt.instruments.end(), r.instrument_id) == opt.instruments.end()) {
+            return false;
+        }
+        return opt.symbols.empty() ||
+               std::find(opt.symbols.begin(), opt.symbols.end(), record_symbol(r)) != opt.symbols.end();
+    };
+
+    for (const std::string& file : opt.files) {
+        pool.submit([&, file] {
+            const auto l0 = Clock::now();
+            auto all = std::make_shared<std::vector<MboRecord>>();
+            std::string err;
+            if (!load_replay_file(file, *all, err, opt.parse_threads)) {
+                std::lock_guard<std::mutex> lk(m);
+                out.errors.push_back(err);
+                return;
+            }
+
+            // split by instrument, file order kept within each
+            std::vector<int32_t> order;
+            std::unordered_map<int32_t, std::shared_ptr<std::vector<MboRecord>>> parts;
+            for (const MboRecord& r : *all) {
+                if (!wanted(r)) continue;
+                auto& p = parts[r.instrument_id];
+                if (!p) {
+                    p = std::make_shared<std::vector<MboRecord>>();
+                    order.push_back(r.instrument_id);
+                }
+                p->push_back(r);
+            }
+            all.reset();
+            {
+                std::lock_guard<std::mutex> lk(m);
+                out.load_ms += ms_since(l0);
+            }
+
+            // biggest at the front of this worker's deque, where idle workers
+            // steal from, so the long books start first
+            std::sort(order.begin(), order.end(),
+                      [&](int32_t a, int32_t b) { return parts[a]->size() > parts[b]->size(); });
+            for (int32_t id : order) {
+                auto recs = parts[id];
+                ReplayTaskKey key{file, id, record_symbol(recs->front())};
+                pool.submit([&, key, recs] {
+                    ReplayTaskStats st = run_book_task(opt, key, *recs, pool.current_worker());
+                    std::lock_guard<std::mutex> lk(m);
+                    out.events += st.events;
+                    out.apply_ms += st.apply_ms;
+                    out.tasks.push_back(std::move(st));
+                });
+            }
+        });
+    }
+    pool.wait();
+
+    // stable report order: file (as given), then instrument
+    std::unordered_map<std::string, size_t> file_pos;
+    for (size_t i = 0; i < opt.files.size(); ++i) file_pos.emplace(opt.files[i], i);
+    std::sort(out.tasks.begin(), out.tasks.end(), [&](const ReplayTaskStats& a, const ReplayTaskStats& b) {
+        const size_t fa = file_pos[a.key.file], fb = file_pos[b.key.file];
+        return fa != fb ? fa < fb : a.key.instrument_id < b.key.instrument_id;
+    });
+    out.steals = pool.steals();
+    out.wall_ms = ms_since(t0);
+    return out.errors.size() < opt.files.size();
+}
+
+} // namespace mbo
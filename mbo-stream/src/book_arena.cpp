@@ -0,0 +1,187 @@
+#include "mbo/book_arena.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace mbo {
+
+static constexpr size_t kHugePage = 2u << 20;
+
+static size_t round_up(size_t v, size_t a) { return (v + a - 1) / a * a; }
+
+const char* arena_pages_name(ArenaPages p) {
+    switch (p) {
+        case ArenaPages::Normal:  return "4k";
+        case ArenaPages::Thp:     return "thp";
+        case ArenaPages::Hugetlb: return "hugetlb";
+    }
+    return "?";
+}
+
+size_t book_arena_bytes_for_orders(size_t orders) {
+    // per order: list node (16B links + 24B Order) + hash node (next + key +
+    // OrderRef + cached hash, ~56B) + one bucket pointer; levels are a few
+    // hundred map nodes and negligible next to that
+    constexpr size_t kPerOrder = 48 + 64 + 8;
+    return round_up(orders * kPerOrder * 2 + kHugePage, kHugePage);
+}
+
+BookArena::BookArena(const BookArenaOptions& opt) {
+    size_ = round_up(opt.bytes > 0 ? opt.bytes : kHugePage, kHugePage);
+
+    if (opt.pages == ArenaPages::Hugetlb) {
+        void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            map_ = base_ = static_cast<char*>(p);
+            map_size_ = size_;
+            pages_ = ArenaPages::Hugetlb;
+        } else {
+            error_ = std::string("MAP_HUGETLB: ") + std::strerror(errno) + ", using thp; ";
+        }
+    }
+
+    if (!base_) {
+        // over-map by one huge page so the region can start 2MB-aligned
+        // (THP only backs aligned 2MB ranges)
+        map_size_ = size_ + kHugePage;
+        void* p = ::mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            error_ += std::string("mmap: ") + std::strerror(errno);
+            map_ = nullptr;
+            map_size_ = size_ = 0;
+            return;
+        }
+        map_ = static_cast<char*>(p);
+        base_ = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(map_), kHugePage));
+        pages_ = ArenaPages::Normal;
+        if (opt.pages != ArenaPages::Normal) {
+            if (::madvise(base_, size_, MADV_HUGEPAGE) == 0) {
+                pages_ = ArenaPages::Thp;
+            } else {
+                error_ += std::string("MADV_HUGEPAGE: ") + std::strerror(errno) + "; ";
+            }
+        }
+    }
+    top_ = base_;
+
+    if (opt.prefault) {
+        // one write per 4K page; with THP each 2MB range faults in as one page
+        const long pg = ::sysconf(_SC_PAGESIZE);
+        for (size_t off = 0; off < size_; off += (size_t)(pg > 0 ? pg : 4096)) {
+            static_cast<volatile char*>(base_)[off] = 0;
+        }
+    }
+
+    if (opt.mlock) {
+        if (::mlock(base_, size_) == 0) {
+            locked_ = true;
+        } else {
+            error_ += std::string("mlock: ") + std::strerror(errno) + " (RLIMIT_MEMLOCK?); ";
+        }
+    }
+}
+
+BookArena::~BookArena() {
+    if (map_) {
+        if (locked_) ::munlock(base_, size_);
+        ::munmap(map_, map_size_);
+    }
+}
+
+void* BookArena::allocate(size_t bytes) {
+    const size_t n = round_up(bytes ? bytes : 1, kAlign);
+
+    if (n <= kMaxSmallBytes) {
+        FreeBlock*& head = small_[n / kAlign];
+        if (head) {
+            FreeBlock* b = head;
+            head = b->next;
+            live_ += n;
+            return b;
+        }
+    } else {
+        for (FreeBlock** pp = &large_; *pp; pp = &(*pp)->next) {
+            if ((*pp)->bytes == n) {
+                FreeBlock* b = *pp;
+                *pp = b->next;
+                live_ += n;
+                return b;
+            }
+        }
+    }
+
+    if (base_ && (size_t)(base_ + size_ - top_) >= n) {
+        void* p = top_;
+        top_ += n;
+        live_ += n;
+        return p;
+    }
+
+    overflow_++;
+    return ::operator new(bytes);
+}
+
+void BookArena::deallocate(void* p, size_t bytes) noexcept {
+    if (!p) return;
+    if (!owns(p)) {
+        ::operator delete(p);
+        return;
+    }
+    const size_t n = round_up(bytes ? bytes : 1, kAlign);
+    live_ -= n;
+    FreeBlock* b = static_cast<FreeBlock*>(p);
+    b->bytes = n;
+    if (n <= kMaxSmallBytes) {
+        b->next = small_[n / kAlign];
+        small_[n / kAlign] = b;
+    } else {
+        b->next = large_;
+        large_ = b;
+    }
+}
+
+size_t BookArena::huge_page_bytes() const {
+    if (!base_) return 0;
+    if (pages_ == ArenaPages::Hugetlb) return size_;
+
+    // sum AnonHugePages over the smaps entries inside [base_, base_ + size_)
+    std::ifstream in("/proc/self/smaps");
+    std::string line;
+    bool inside = false;
+    size_t kb = 0;
+    const uintptr_t lo = reinterpret_cast<uintptr_t>(base_);
+    const uintptr_t hi = lo + size_;
+    while (std::getline(in, line)) {
+        unsigned long long a = 0, b = 0;
+        if (std::sscanf(line.c_str(), "%llx-%llx ", &a, &b) == 2 && line.find('-') < 16) {
+            inside = a < hi && b > lo;
+            continue;
+        }
+        if (inside && line.rfind("AnonHugePages:", 0) == 0) {
+            kb += std::strtoull(line.c_str() + 14, nullptr, 10);
+        }
+    }
+    return kb * 1024;
+}
+
+std::string BookArena::to_json() const {
+    std::ostringstream os;
+    os.precision(4);
+    os << "{\"pages\":\"" << arena_pages_name(pages_) << "\""
+       << ",\"capacity_mb\":" << (double)size_ / (1 << 20)
+       << ",\"used_mb\":" << (double)used() / (1 << 20)
+       << ",\"live_mb\":" << (double)live_ / (1 << 20)
+       << ",\"huge_mb\":" << (double)huge_page_bytes() / (1 << 20)
+       << ",\"locked\":" << (locked_ ? "true" : "false")
+       << ",\"overflow\":" << overflow_ << "}";
+    return os.str();
+}
+
+} // namespace mbo
@@ -0,0 +1,436 @@
+#include "mbo/book_checkpoint.hpp"
+#include "mbo/event_journal.hpp"
+#include "mbo/thread_tuning.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace mbo {
+
+namespace {
+
+constexpr char kMagic[8] = {'M', 'B', 'O', 'C', 'K', 'P', 'T', '1'};
+constexpr uint32_t kVersion = 1;
+
+#pragma pack(push, 1)
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_bytes;
+    uint64_t last_seq;
+    uint64_t seq_count;
+    uint64_t applied;
+    int64_t last_ts_ns;
+    uint32_t bid_levels;
+    uint32_t ask_levels;
+    uint64_t orders;
+    uint16_t symbol_len;
+    uint64_t journal_index;
+};
+
+struct LevelHeader {
+    int64_t price;
+    uint32_t n;
+};
+
+struct PackedOrder {
+    int64_t order_id;
+    int32_t qty;
+};
+#pragma pack(pop)
+
+// headers written before journal_index was added
+constexpr uint32_t kHeaderBytesNoJournal = offsetof(Header, journal_index);
+
+// FNV-1a over 8-byte words (bytes for the tail): a checksum against torn or
+// truncated files, cheap enough for a multi-MB image
+uint64_t fnv1a(const char* p, size_t n) {
+    uint64_t h = 1469598103934665603ull;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof w);
+        h ^= w;
+        h *= 1099511628211ull;
+    }
+    for (; i < n; ++i) {
+        h ^= (unsigned char)p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+int64_t mono_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+char* put(char* p, const T& v) {
+    std::memcpy(p, &v, sizeof v);
+    return p + sizeof v;
+}
+
+// tmp + fsync + rename, so a reader never sees a torn file. Allocation-free
+// (the forked checkpoint child uses it): `tmp` is `path` + ".tmp", and on
+// failure `what` names the call that failed, with errno set.
+bool write_image_raw(const char* path, const char* tmp, const char* data, size_t n, const char*& what) {
+    const int fd = ::open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) { what = "open"; return false; }
+
+    size_t off = 0;
+    while (off < n) {
+        const ssize_t w = ::write(fd, data + off, n - off);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            const int e = errno;
+            ::close(fd);
+            ::unlink(tmp);
+            errno = e;
+            what = "write";
+            return false;
+        }
+        off += (size_t)w;
+    }
+    if (::fsync(fd) != 0 || ::close(fd) != 0) {
+        const int e = errno;
+        ::unlink(tmp);
+        errno = e;
+        what = "fsync/close";
+        return false;
+    }
+    if (::rename(tmp, path) != 0) {
+        const int e = errno;
+        ::unlink(tmp);
+        errno = e;
+        what = "rename";
+        return false;
+    }
+    return true;
+}
+
+bool write_image(const std::string& path, const std::string& img, std::string& err) {
+    const std::string tmp = path + ".tmp";
+    const char* what = "";
+    if (write_image_raw(path.c_str(), tmp.c_str(), img.data(), img.size(), what)) return true;
+    err = std::string(what) + (std::strcmp(what, "open") == 0 ? " " + tmp : std::string()) + ": " +
+          std::strerror(errno);
+    return false;
+}
+
+size_t image_bytes(const MboOrderBook& book, const CheckpointMeta& meta) {
+    return sizeof(Header) + std::min<size_t>(meta.symbol.size(), 0xffff) +
+           (book.bid_levels() + book.ask_levels()) * sizeof(LevelHeader) +
+           (size_t)book.order_count() * sizeof(PackedOrder) + sizeof(uint64_t);
+}
+
+constexpr char kHistPrefix[] = "ckpt-";
+constexpr char kHistSuffix[] = ".ckpt";
+
+} // namespace
+
+void encode_book_checkpoint(const MboOrderBook& book, const CheckpointMeta& meta, std::string& out,
+                            CheckpointStats* stats) {
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof kMagic);
+    h.version = kVersion;
+    h.header_bytes = sizeof(Header);
+    h.last_seq = meta.last_seq;
+    h.seq_count = meta.seq_count;
+    h.applied = meta.applied;
+    h.last_ts_ns = meta.last_ts_ns;
+    h.bid_levels = (uint32_t)book.bid_levels();
+    h.ask_levels = (uint32_t)book.ask_levels();
+    h.orders = book.order_count();
+    h.symbol_len = (uint16_t)std::min<size_t>(meta.symbol.size(), 0xffff);
+    h.journal_index = meta.journal_index;
+
+    const size_t bytes = image_bytes(book, meta);
+    out.resize(bytes);   // no allocation if the caller reserved image_bytes()
+    char* p = out.data();
+    p = put(p, h);
+    std::memcpy(p, meta.symbol.data(), h.symbol_len);
+    p += h.symbol_len;
+
+    book.for_each_level([&](bool, int64_t price, const OrderQueue& q) {
+        p = put(p, LevelHeader{price, (uint32_t)q.size()});
+        for (const Order& o : q) p = put(p, PackedOrder{o.order_id, o.qty});
+    });
+
+    put(p, fnv1a(out.data(), bytes - sizeof(uint64_t)));
+
+    if (stats) {
+        stats->bytes = out.size();
+        stats->orders = h.orders;
+        stats->bid_levels = h.bid_levels;
+        stats->ask_levels = h.ask_levels;
+    }
+}
+
+bool decode_book_checkpoint(const char* data, size_t len, MboOrderBook& book, CheckpointMeta& meta,
+                            std::string& err, CheckpointStats* stats) {
+    if (len < kHeaderBytesNoJournal + sizeof(uint64_t)) { err = "truncated checkpoint"; return false; }
+
+    Header h;
+    std::memcpy(&h, data, kHeaderBytesNoJournal);
+    if (std::memcmp(h.magic, kMagic, sizeof kMagic) != 0) { err = "bad magic"; return false; }
+    if (h.version != kVersion) { err = "unsupported version " + std::to_string(h.version); return false; }
+    if (h.header_bytes == kHeaderBytesNoJournal) {
+        h.journal_index = CheckpointMeta::kNoJournalIndex;
+    } else if (h.header_bytes == sizeof(Header) && len >= sizeof(Header) + sizeof(uint64_t)) {
+        std::memcpy(&h, data, sizeof h);
+    } else {
+        err = "bad header size";
+        return false;
+    }
+
+    uint64_t sum;
+    std::memcpy(&sum, data + len - sizeof sum, sizeof sum);
+    if (fnv1a(data, len - sizeof sum) != sum) { err = "checksum mismatch"; return false; }
+
+    const char* p = data + h.header_bytes;
+    const char* end = data + len - sizeof sum;
+    if ((size_t)(end - p) < h.symbol_len) { err = "truncated symbol"; return false; }
+
+    meta.symbol.assign(p, h.symbol_len);
+    p += h.symbol_len;
+    meta.last_seq = h.last_seq;
+    meta.seq_count = h.seq_count;
+    meta.applied = h.applied;
+    meta.last_ts_ns = h.last_ts_ns;
+    meta.journal_index = h.journal_index;
+
+    book = MboOrderBook(meta.symbol, book.arena(), std::max<size_t>(book.expected_orders(), h.orders));
+
+    std::vector<Order> orders;
+    uint64_t restored = 0;
+    const uint64_t levels = (uint64_t)h.bid_levels + h.ask_levels;
+    for (uint64_t l = 0; l < levels; ++l) {
+        if ((size_t)(end - p) < sizeof(LevelHeader)) { err = "truncated level"; return false; }
+        LevelHeader lh;
+        std::memcpy(&lh, p, sizeof lh);
+        p += sizeof lh;
+        if ((size_t)(end - p) / sizeof(PackedOrder) < lh.n) { err = "truncated orders"; return false; }
+
+        orders.resize(lh.n);
+        for (uint32_t i = 0; i < lh.n; ++i) {
+            PackedOrder po;
+            std::memcpy(&po, p, sizeof po);
+            p += sizeof po;
+            orders[i] = Order{po.order_id, lh.price, po.qty};
+        }
+        if (!book.restore_level(l < h.bid_levels, lh.price, orders.data(), orders.size())) {
+            err = "inconsistent level at price " + std::to_string(lh.price);
+            return false;
+        }
+        restored += lh.n;
+    }
+    if (p != end || restored != h.orders) { err = "order count mismatch"; return false; }
+
+    if (stats) {
+        stats->bytes = len;
+        stats->orders = h.orders;
+        stats->bid_levels = h.bid_levels;
+        stats->ask_levels = h.ask_levels;
+    }
+    return true;
+}
+
+bool write_book_checkpoint(const std::string& path, const MboOrderBook& book, const CheckpointMeta& meta,
+                           std::string& err, CheckpointStats* stats) {
+    std::string img;
+    encode_book_checkpoint(book, meta, img, stats);
+    return write_image(path, img, err);
+}
+
+bool read_book_checkpoint(const std::string& path, MboOrderBook& book, CheckpointMeta& meta,
+                          std::string& err, CheckpointStats* stats) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { err = "open " + path + ": " + std::strerror(errno); return false; }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        err = std::string("fstat: ") + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    std::string img((size_t)st.st_size, '\0');
+    size_t off = 0;
+    while (off < img.size()) {
+        const ssize_t r = ::read(fd, &img[off], img.size() - off);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        off += (size_t)r;
+    }
+    ::close(fd);
+    if (off != img.size()) { err = "short read"; return false; }
+
+    return decode_book_checkpoint(img.data(), img.size(), book, meta, err, stats);
+}
+
+bool read_checkpoint_meta(const std::string& path, CheckpointMeta& meta, std::string& err) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { err = "open " + path + ": " + std::strerror(errno); return false; }
+
+    Header h{};
+    const ssize_t n = ::pread(fd, &h, sizeof h, 0);
+    bool ok = n >= (ssize_t)kHeaderBytesNoJournal && std::memcmp(h.magic, kMagic, sizeof kMagic) == 0 &&
+              h.version == kVersion &&
+              (h.header_bytes == kHeaderBytesNoJournal || (h.header_bytes == sizeof(Header) && n == (ssize_t)sizeof h));
+    if (ok) {
+        meta.symbol.assign(h.symbol_len, '\0');
+        ok = ::pread(fd, meta.symbol.data(), h.symbol_len, h.header_bytes) == (ssize_t)h.symbol_len;
+    }
+    ::close(fd);
+    if (!ok) { err = path + ": not a checkpoint"; return false; }
+
+    meta.last_seq = h.last_seq;
+    meta.seq_count = h.seq_count;
+    meta.applied = h.applied;
+    meta.last_ts_ns = h.last_ts_ns;
+    meta.journal_index = h.header_bytes == sizeof(Header) ? h.journal_index : CheckpointMeta::kNoJournalIndex;
+    return true;
+}
+
+std::string checkpoint_history_path(const std::string& dir, uint64_t journal_index) {
+    char name[64];
+    std::snprintf(name, sizeof name, "%s%020llu%s", kHistPrefix, (unsigned long long)journal_index, kHistSuffix);
+    return dir + "/" + name;
+}
+
+bool list_checkpoint_history(const std::string& dir, std::vector<CheckpointFile>& out, std::string& err) {
+    out.clear();
+    DIR* d = ::opendir(dir.c_str());
+    if (!d) {
+        err = "opendir " + dir + ": " + std::strerror(errno);
+        return false;
+    }
+    const size_t plen = std::strlen(kHistPrefix), slen = std::strlen(kHistSuffix);
+    while (const dirent* de = ::readdir(d)) {
+        const std::string name = de->d_name;
+        if (name.size() != plen + 20 + slen || name.compare(0, plen, kHistPrefix) != 0 ||
+            name.compare(name.size() - slen, slen, kHistSuffix) != 0) {
+            continue;
+        }
+        out.push_back(CheckpointFile{dir + "/" + name, std::strtoull(name.c_str() + plen, nullptr, 10)});
+    }
+    ::closedir(d);
+    std::sort(out.begin(), out.end(),
+              [](const CheckpointFile& a, const CheckpointFile& b) { return a.journal_index < b.journal_index; });
+    return true;
+}
+
+void CheckpointForker::keep_history(std::string dir, size_t keep) {
+    history_dir_ = std::move(dir);
+    history_keep_ = keep;
+}
+
+bool CheckpointForker::start(const MboOrderBook& book, const CheckpointMeta& meta, std::string& err) {
+    if (child_ > 0 && reap_(false) == Reap::None) {
+        err = "previous checkpoint still running";
+        return false;
+    }
+
+    // Everything the child needs is allocated here: it only fills the
+    // reserved image, writes, renames and unlinks (async-signal-safe calls),
+    // so it never touches malloc state the fork may have caught mid-update.
+    img_.clear();
+    img_.reserve(image_bytes(book, meta));
+    tmp_path_ = path_.empty() ? std::string() : path_ + ".tmp";
+    const bool history = history_keep_ > 0 && meta.journal_index != CheckpointMeta::kNoJournalIndex;
+    prune_.clear();
+    journal_prune_planned_ = 0;
+    if (history) {
+        hist_path_ = checkpoint_history_path(history_dir_, meta.journal_index);
+        hist_tmp_path_ = hist_path_ + ".tmp";
+        std::vector<CheckpointFile> files;
+        std::string lerr;
+        if (list_checkpoint_history(history_dir_, files, lerr)) {
+            files.erase(std::remove_if(files.begin(), files.end(),
+                                       [&](const CheckpointFile& f) { return f.path == hist_path_; }),
+                        files.end());
+            // the new file makes files.size() + 1; keep the newest history_keep_
+            for (size_t i = 0; i + history_keep_ < files.size() + 1; ++i) prune_.push_back(files[i].path);
+
+            // journal segments wholly behind the oldest checkpoint that stays;
+            // a segment goes only once its successor starts at or before it,
+            // so the last (open) segment is never touched
+            std::vector<JournalSegment> segs;
+            if (prune_journal_ && !path_.empty() && list_journal_segments(history_dir_, segs, lerr)) {
+                const size_t dropped = prune_.size();
+                const uint64_t keep_from = dropped < files.size() ? files[dropped].journal_index : meta.journal_index;
+                for (size_t i = 0; i + 1 < segs.size() && segs[i + 1].first_index <= keep_from; ++i) {
+                    prune_.push_back(segs[i].path);
+                    ++journal_prune_planned_;
+                }
+            }
+        }
+    }
+
+    const int64_t t0 = mono_ns();
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        err = std::string("fork: ") + std::strerror(errno);
+        return false;
+    }
+    if (pid == 0) {
+        // off the ingest core and SCHED_FIFO the forking thread may hold
+        restore_default_placement_self();
+        // one encode for both files
+        encode_book_checkpoint(book, meta, img_);
+        const char* what = "";
+        bool ok = path_.empty() || write_image_raw(path_.c_str(), tmp_path_.c_str(), img_.data(), img_.size(), what);
+        if (ok && history) {
+            ok = write_image_raw(hist_path_.c_str(), hist_tmp_path_.c_str(), img_.data(), img_.size(), what);
+            if (ok) {
+                for (const std::string& f : prune_) ::unlink(f.c_str());
+            }
+        }
+        if (!ok) {
+            const char* e = std::strerror(errno);
+            const char* parts[] = {"[checkpoint] ", what, ": ", e, "\n"};
+            for (const char* s : parts) (void)!::write(2, s, std::strlen(s));
+        }
+        ::_exit(ok ? 0 : 1);
+    }
+
+    child_ = pid;
+    started_ns_ = t0;
+    last_path_ = !path_.empty() ? path_ : checkpoint_history_path(history_dir_, meta.journal_index);
+    fork_ns_ = (uint64_t)(mono_ns() - t0);
+    return true;
+}
+
+CheckpointForker::Reap CheckpointForker::poll() { return child_ > 0 ? reap_(false) : Reap::None; }
+
+CheckpointForker::Reap CheckpointForker::wait() { return child_ > 0 ? reap_(true) : Reap::None; }
+
+CheckpointForker::Reap CheckpointForker::reap_(bool block) {
+    int status = 0;
+    pid_t r;
+    do {
+        r = ::waitpid(child_, &status, block ? 0 : WNOHANG);
+    } while (r < 0 && errno == EINTR);
+    if (r == 0) return Reap::None;
+
+    child_ = -1;
+    if (r < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return Reap::Failed;
+
+    write_ns_ = (uint64_t)(mono_ns() - started_ns_);
+    journal_pruned_ = journal_prune_planned_;
+    struct stat st{};
+    if (::stat(last_path_.c_str(), &st) == 0) bytes_ = (uint64_t)st.st_size;
+    return Reap::Ok;
+}
+
+} // namespace mbo
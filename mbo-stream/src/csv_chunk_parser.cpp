@@ -0,0 +1,305 @@
+#include "mbo/csv_chunk_parser.hpp"
+#include "mbo/thread_tuning.hpp"
+#include "mbo/timestamp.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace mbo {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+template <typename T>
+inline bool parse_int(std::string_view sv, T& out) {
+    if (sv.empty()) return false;
+    return std::from_chars(sv.data(), sv.data() + sv.size(), out).ec == std::errc{};
+}
+
+// "64.830000000" -> 648300 (1e-4 ticks). Plain decimals with nothing past the
+// 4th decimal are exact integer work; anything else (more precision, exponent,
+// junk) goes through strtod + llround, the same arithmetic as
+// parse_mbo_csv_line, so both parsers agree on every input.
+inline bool parse_price_1e4(std::string_view sv, int64_t& out) {
+    if (sv.empty()) return false;
+    size_t i = 0;
+    const bool neg = sv[0] == '-';
+    if (neg) ++i;
+    int64_t ip = 0;
+    size_t int_digits = 0;
+    for (; i < sv.size() && sv[i] >= '0' && sv[i] <= '9' && int_digits < 15; ++i, ++int_digits) {
+        ip = ip * 10 + (sv[i] - '0');
+    }
+    bool exact = int_digits > 0;
+    int64_t frac = 0;
+    if (exact && i < sv.size()) {
+        if (sv[i] != '.') {
+            exact = false;
+        } else {
+            ++i;
+            for (int d = 0; d < 4; ++d) {
+                frac *= 10;
+                if (i < sv.size() && sv[i] >= '0' && sv[i] <= '9') frac += sv[i++] - '0';
+            }
+            for (; i < sv.size(); ++i) {
+                if (sv[i] != '0') {
+                    exact = false;
+                    break;
+                }
+            }
+        }
+    }
+    if (exact) {
+        out = (ip * 10000 + frac) * (neg ? -1 : 1);
+        return true;
+    }
+
+    char buf[64];
+    const size_t n = std::min(sv.size(), sizeof(buf) - 1);
+    std::memcpy(buf, sv.data(), n);
+    buf[n] = '\0';
+    char* end = nullptr;
+    const double d = std::strtod(buf, &end);
+    if (end == buf) return false;
+    out = (int64_t)std::llround(d * 10000.0);
+    return true;
+}
+
+struct Mapping {
+    int fd = -1;
+    char* data = nullptr;
+    size_t bytes = 0;
+    ~Mapping() {
+        if (data) ::munmap(data, bytes);
+        if (fd >= 0) ::close(fd);
+    }
+};
+
+} // namespace
+
+bool parse_mbo_csv_record(std::string_view s, MboRecord& out) {
+    if (!s.empty() && s.back() == '\r') s.remove_suffix(1);
+    if (s.empty()) return false;
+    if (s.compare(0, 8, "ts_recv,") == 0) return false;
+
+    // 16 fields at most (the optional ts_send_ns column is not kept in a record)
+    std::string_view f[16];
+    size_t nf = 0;
+    const char* p = s.data();
+    const char* end = p + s.size();
+    while (nf < 16) {
+        const char* c = (const char*)std::memchr(p, ',', (size_t)(end - p));
+        if (!c) {
+            f[nf++] = std::string_view(p, (size_t)(end - p));
+            break;
+        }
+        f[nf++] = std::string_view(p, (size_t)(c - p));
+        p = c + 1;
+    }
+    if (nf < 15) return false;
+
+    out = MboRecord{};
+    int32_t publisher = 0;
+    if (!parse_iso8601_ns(f[0], out.ts_recv_ns) || !parse_iso8601_ns(f[1], out.ts_event_ns)) return false;
+    if (!parse_int<int32_t>(f[3], publisher)) return false;
+    if (!parse_int<int32_t>(f[4], out.instrument_id)) return false;
+    if (!parse_price_1e4(f[7], out.price)) return false;
+    if (!parse_int<int32_t>(f[8], out.size)) return false;
+    if (!parse_int<int64_t>(f[10], out.order_id)) return false;
+    if (!parse_int<uint32_t>(f[11], out.flags)) return false;
+    if (!parse_int<int32_t>(f[12], out.ts_in_delta)) out.ts_in_delta = 0;
+    if (!parse_int<uint64_t>(f[13], out.sequence)) out.sequence = 0;
+
+    out.publisher_id = (uint16_t)publisher;
+    out.action = !f[5].empty() ? f[5][0] : 'N';
+    out.side = !f[6].empty() ? f[6][0] : 'N';
+    std::memcpy(out.symbol, f[14].data(), std::min(f[14].size(), sizeof(out.symbol)));
+    return true;
+}
+
+std::vector<CsvChunkSpan> split_csv_chunks(const char* data, size_t size, size_t chunk_bytes) {
+    std::vector<CsvChunkSpan> out;
+    chunk_bytes = std::max<size_t>(chunk_bytes, 1);
+    out.reserve(size / chunk_bytes + 1);
+    size_t start = 0;
+    while (start < size) {
+        size_t end = std::min(size, start + chunk_bytes);
+        if (end < size) {
+            const char* nl = (const char*)std::memchr(data + end - 1, '\n', size - (end - 1));
+            end = nl ? (size_t)(nl - data) + 1 : size;
+        }
+        out.push_back(CsvChunkSpan{start, end - start});
+        start = end;
+    }
+    return out;
+}
+
+uint64_t parse_csv_chunk(const char* data, size_t bytes, std::vector<MboRecord>& out) {
+    uint64_t bad = 0;
+    const char* p = data;
+    const char* end = data + bytes;
+    while (p < end) {
+        const char* nl = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+        const char* le = nl ? nl : end;
+        if (le > p && !(le - p == 1 && *p == '\r')) {
+            out.emplace_back();
+            if (!parse_mbo_csv_record(std::string_view(p, (size_t)(le - p)), out.back())) {
+                out.pop_back();
+                ++bad;
+            }
+        }
+        p = le + 1;
+    }
+    return bad;
+}
+
+bool parse_csv_file_parallel(const std::string& path, const ParallelCsvOptions& opt, const CsvRecordsFn& fn,
+                             std::string& err, ParallelCsvStats* stats) {
+    const auto t0 = Clock::now();
+    Mapping m;
+    m.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m.fd < 0) {
+        err = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(m.fd, &st) != 0) {
+        err = "fstat " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    m.bytes = (size_t)st.st_size;
+    if (m.bytes > 0) {
+        void* p = ::mmap(nullptr, m.bytes, PROT_READ, MAP_PRIVATE, m.fd, 0);
+        if (p == MAP_FAILED) {
+            err = "mmap " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        m.data = (char*)p;
+        ::madvise(p, m.bytes, MADV_SEQUENTIAL);
+    }
+
+    parse_csv_buffer_parallel(m.data, m.bytes, opt, fn, stats);
+    if (stats) stats->wall_ms = ms_since(t0);   // mapping included
+    return true;
+}
+
+void parse_csv_buffer_parallel(const char* data, size_t bytes, const ParallelCsvOptions& opt,
+                               const CsvRecordsFn& fn, ParallelCsvStats* stats) {
+    const auto t0 = Clock::now();
+    const std::vector<CsvChunkSpan> chunks = split_csv_chunks(data, bytes, opt.chunk_bytes);
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned)std::max<size_t>(1, std::min<size_t>(threads, chunks.size()));
+    const size_t window = std::max<size_t>(2, opt.window ? opt.window : 2 * (size_t)threads);
+
+    // reorder buffer: chunk i lives in slot i % window until consumed
+    struct Slot {
+        std::vector<MboRecord> recs;
+        uint64_t bad = 0;
+        bool ready = false;
+    };
+    std::vector<Slot> slots(window);
+    std::mutex mtx;
+    std::condition_variable work_cv;   // a slot freed / stop
+    std::condition_variable ready_cv;  // a chunk parsed
+    size_t claimed = 0;                // next chunk to hand to a parser
+    size_t consumed = 0;               // chunks delivered to fn
+    bool stop = false;
+    double parse_ms = 0;
+    const size_t est_per_chunk = opt.chunk_bytes / 96 + 16;   // ~100-byte lines
+
+    auto parser = [&](unsigned id) {
+        const std::string name = "mbo-parse-" + std::to_string(id);
+        name_current_thread(name.c_str());
+        double busy = 0;
+        for (;;) {
+            size_t i;
+            std::vector<MboRecord> recs;
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                work_cv.wait(lk, [&] { return stop || claimed >= chunks.size() || claimed < consumed + window; });
+                if (stop || claimed >= chunks.size()) break;
+                i = claimed++;
+                recs = std::move(slots[i % window].recs);   // reuse the consumed array
+            }
+            const auto p0 = Clock::now();
+            recs.clear();
+            recs.reserve(est_per_chunk);
+            const uint64_t bad = parse_csv_chunk(data + chunks[i].offset, chunks[i].bytes, recs);
+            busy += ms_since(p0);
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                Slot& s = slots[i % window];
+                s.recs = std::move(recs);
+                s.bad = bad;
+                s.ready = true;
+            }
+            ready_cv.notify_all();
+        }
+        std::lock_guard<std::mutex> lk(mtx);
+        parse_ms += busy;
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t) pool.emplace_back(parser, t);
+
+    ParallelCsvStats s;
+    s.bytes = bytes;
+    s.threads = threads;
+    std::vector<MboRecord> cur;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        {
+            std::unique_lock<std::mutex> lk(mtx);
+            Slot& slot = slots[i % window];
+            if (!slot.ready) {
+                const auto w0 = Clock::now();
+                ready_cv.wait(lk, [&] { return slot.ready; });
+                s.wait_ms += ms_since(w0);
+            }
+            cur = std::move(slot.recs);
+            s.bad_lines += slot.bad;
+        }
+        s.records += cur.size();
+        ++s.chunks;
+        const bool go_on = fn(cur.data(), cur.size());
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            Slot& slot = slots[i % window];
+            slot.recs = std::move(cur);     // back for reuse by chunk i + window
+            slot.ready = false;
+            consumed = i + 1;
+            if (!go_on) stop = true;
+        }
+        work_cv.notify_all();
+        if (!go_on) break;
+    }
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        stop = true;
+    }
+    work_cv.notify_all();
+    for (auto& t : pool) t.join();
+
+    s.parse_ms = parse_ms;
+    s.wall_ms = ms_since(t0);
+    if (stats) *stats = s;
+}
+
+} // namespace mbo
@@ -7,6 +7,7 @@
 
 // Header:
 // ts_recv,ts_event,rtype,publisher_id,instrument_id,action,side,price,size,channel_id,order_id,flags,ts_in_delta,sequence,symbol
+// The streamer may append a 16th column, ts_send_ns (see STAMP_SEND).
 
 static inline bool split_csv_simple(std::string_view s, std::vector<std::string_view>& out) {
     out.clear();
@@ -74,6 +75,15 @@ bool parse_mbo_csv_line(const std::string& line, MboEvent& out) {
     if (!parse_int<int64_t>(f[10], out.order_id)) return false;
     if (!parse_int<uint32_t>(f[11], out.flags)) return false;
 
+    out.ts_in_delta = 0;
+    if (!parse_int<int32_t>(f[12], out.ts_in_delta)) out.ts_in_delta = 0;
+
+    out.sequence = 0;
+    if (!parse_int<uint64_t>(f[13], out.sequence)) out.sequence = 0;
+
+    out.ts_send_ns = 0;
+    if (f.size() >= 16 && !parse_int<int64_t>(f[15], out.ts_send_ns)) out.ts_send_ns = 0;
+
     out.action = (!f[5].empty()) ? f[5][0] : 'N';
     out.side   = (!f[6].empty()) ? f[6][0] : 'N';
 
@@ -0,0 +1,364 @@
+#include "mbo/event_journal.hpp"
+#include "mbo/mbo_order_book.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mbo {
+
+static constexpr const char* kSegPrefix = "journal-";
+static constexpr const char* kSegSuffix = ".mbob";
+
+static std::string segment_path(const std::string& dir, uint64_t first) {
+    char name[64];
+    std::snprintf(name, sizeof name, "%s%020" PRIu64 "%s", kSegPrefix, first, kSegSuffix);
+    return dir + "/" + name;
+}
+
+static bool read_header(int fd, MboFileHeader& h) {
+    return ::pread(fd, &h, sizeof h, 0) == (ssize_t)sizeof h && valid_mbo_file_header(h);
+}
+
+bool list_journal_segments(const std::string& dir, std::vector<JournalSegment>& out, std::string& err) {
+    out.clear();
+    DIR* d = ::opendir(dir.c_str());
+    if (!d) {
+        err = "opendir " + dir + ": " + std::strerror(errno);
+        return false;
+    }
+    const size_t plen = std::strlen(kSegPrefix), slen = std::strlen(kSegSuffix);
+    while (const dirent* de = ::readdir(d)) {
+        const std::string name = de->d_name;
+        if (name.size() != plen + 20 + slen || name.compare(0, plen, kSegPrefix) != 0 ||
+            name.compare(name.size() - slen, slen, kSegSuffix) != 0) {
+            continue;
+        }
+        JournalSegment s;
+        s.path = dir + "/" + name;
+        s.first_index = std::strtoull(name.c_str() + plen, nullptr, 10);
+
+        const int fd = ::open(s.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        MboFileHeader h;
+        struct stat st{};
+        if (read_header(fd, h) && ::fstat(fd, &st) == 0) {
+            s.records = mbo_file_record_count(h, (size_t)st.st_size);
+            out.push_back(std::move(s));
+        }
+        ::close(fd);
+    }
+    ::closedir(d);
+    std::sort(out.begin(), out.end(),
+              [](const JournalSegment& a, const JournalSegment& b) { return a.first_index < b.first_index; });
+    return true;
+}
+
+// ----------------------- writer -----------------------
+
+EventJournal::~EventJournal() { close(); }
+
+bool EventJournal::open(const EventJournalOptions& opt, std::string& err) {
+    if (running_) return true;
+    opt_ = opt;
+    if (opt_.segment_records == 0) opt_.segment_records = 1;
+
+    if (::mkdir(opt_.dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        err = "mkdir " + opt_.dir + ": " + std::strerror(errno);
+        return false;
+    }
+
+    // continue after the last segment; an unfinished one (crash) is closed
+    // out at its record count first, so every older segment is a plain file
+    std::vector<JournalSegment> segs;
+    if (!list_journal_segments(opt_.dir, segs, err)) return false;
+    // (and a preallocated successor that never got a record is removed)
+    while (!segs.empty() && segs.back().records == 0) {
+        ::unlink(segs.back().path.c_str());
+        segs.pop_back();
+    }
+    next_index_ = 0;
+    if (!segs.empty()) {
+        const JournalSegment& last = segs.back();
+        next_index_ = last.first_index + last.records;
+        if (::truncate(last.path.c_str(), (off_t)(sizeof(MboFileHeader) + last.records * sizeof(MboRecord))) != 0) {
+            err = "truncate " + last.path + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+
+    if (!open_segment_(cur_, next_index_, err)) return false;
+
+    staging_.reserve(1 << 14);
+    pending_.reserve(1 << 14);
+    pending_first_ = next_index_;
+    stop_ = false;
+    running_ = true;
+    thread_ = std::thread([this] { run(); });
+    return true;
+}
+
+bool EventJournal::open_segment_(Segment& s, uint64_t first, std::string& err) {
+    s = Segment{};
+    s.path = segment_path(opt_.dir, first);
+    s.first = first;
+    s.map_bytes = sizeof(MboFileHeader) + opt_.segment_records * sizeof(MboRecord);
+
+    s.fd = ::open(s.path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (s.fd < 0) {
+        err = "open " + s.path + ": " + std::strerror(errno);
+        return false;
+    }
+    // reserve the blocks now: a full disk fails here, not as SIGBUS on a store
+    int rc = ::posix_fallocate(s.fd, 0, (off_t)s.map_bytes);
+    if (rc == EOPNOTSUPP || rc == EINVAL) rc = ::ftruncate(s.fd, (off_t)s.map_bytes) == 0 ? 0 : errno;
+    if (rc != 0) {
+        err = "fallocate " + s.path + ": " + std::strerror(rc);
+        ::close(s.fd);
+        ::unlink(s.path.c_str());
+        s.fd = -1;
+        return false;
+    }
+    void* p = ::mmap(nullptr, s.map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, s.fd, 0);
+    if (p == MAP_FAILED) {
+        err = "mmap " + s.path + ": " + std::strerror(errno);
+        ::close(s.fd);
+        ::unlink(s.path.c_str());
+        s.fd = -1;
+        return false;
+    }
+    s.map = static_cast<char*>(p);
+
+    MboFileHeader h;
+    h.flags = kMboFileCounted;
+    h.record_count = 0;
+    std::memcpy(s.map, &h, sizeof h);
+    segments_total_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void EventJournal::finish_segment_(Segment& s) {
+    if (!s.open()) return;
+    const size_t used = sizeof(MboFileHeader) + s.count * sizeof(MboRecord);
+    if (opt_.sync_on_rotate && s.count > 0) ::msync(s.map, used, MS_SYNC);
+    ::munmap(s.map, s.map_bytes);
+    if (s.count == 0) {
+        ::unlink(s.path.c_str());
+        segments_total_.fetch_sub(1, std::memory_order_relaxed);
+    } else if (::ftruncate(s.fd, (off_t)used) != 0) {
+        error_ = "ftruncate " + s.path + ": " + std::strerror(errno);
+    } else if (opt_.sync_on_rotate) {
+        ::fsync(s.fd);
+    }
+    ::close(s.fd);
+    s = Segment{};
+}
+
+void EventJournal::write_batch_(uint64_t first, const MboRecord* recs, size_t n) {
+    while (n > 0) {
+        // a dropped commit leaves a gap: close the segment and start a new one
+        // at the right index, so segment first + count stays exact
+        if (cur_.open() && first != cur_.first + cur_.count) {
+            finish_segment_(cur_);
+            finish_segment_(next_);
+        }
+        if (!cur_.open() || cur_.count == opt_.segment_records) {
+            const uint64_t at = cur_.open() ? cur_.first + cur_.count : first;
+            finish_segment_(cur_);
+            if (next_.open() && next_.first == at) {
+                cur_ = next_;
+                next_ = Segment{};
+            } else {
+                finish_segment_(next_);
+                std::string err;
+                if (!open_segment_(cur_, at, err)) {
+                    error_ = err;
+                    dropped_total_.fetch_add(n, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+        const size_t k = std::min<size_t>(n, opt_.segment_records - cur_.count);
+        std::memcpy(cur_.map + sizeof(MboFileHeader) + cur_.count * sizeof(MboRecord), recs, k * sizeof(MboRecord));
+        cur_.count += k;
+        // records first, then the count that publishes them
+        auto* h = reinterpret_cast<MboFileHeader*>(cur_.map);
+        __atomic_store_n(&h->record_count, cur_.count, __ATOMIC_RELEASE);
+        written_total_.fetch_add(k, std::memory_order_relaxed);
+        recs += k;
+        first += k;
+        n -= k;
+    }
+
+    // preallocate the successor once the current segment is half full, off
+    // the rotation path
+    if (cur_.open() && !next_.open() && cur_.count >= opt_.segment_records / 2) {
+        std::string err;
+        if (!open_segment_(next_, cur_.first + opt_.segment_records, err)) error_ = err;
+    }
+}
+
+void EventJournal::commit() {
+    if (staging_.empty()) return;
+    const size_t n = staging_.size();
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (pending_.empty() && resync_) {
+            pending_first_ = next_index_;
+            resync_ = false;
+        }
+        if (resync_ || pending_.size() + n > opt_.max_pending_records) {
+            resync_ = true;
+            dropped_total_.fetch_add(n, std::memory_order_relaxed);
+            done_ += n;
+        } else if (pending_.empty()) {
+            pending_.swap(staging_);   // usual case: the writer keeps up, no copy
+        } else {
+            pending_.insert(pending_.end(), staging_.begin(), staging_.end());
+        }
+        committed_ += n;
+    }
+    cv_.notify_one();
+    next_index_ += n;
+    staging_.clear();
+}
+
+void EventJournal::flush() {
+    if (!running_) return;
+    commit();
+    std::unique_lock<std::mutex> lk(mtx_);
+    const uint64_t target = committed_;
+    done_cv_.wait(lk, [&] { return done_ >= target; });
+}
+
+void EventJournal::close() {
+    if (!running_) return;
+    flush();
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+    finish_segment_(cur_);
+    finish_segment_(next_);
+    running_ = false;
+}
+
+void EventJournal::run() {
+    std::vector<MboRecord> batch;
+    batch.reserve(1 << 14);
+    while (true) {
+        uint64_t first;
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            cv_.wait(lk, [&] { return stop_ || !pending_.empty(); });
+            if (pending_.empty() && stop_) break;
+            batch.swap(pending_);
+            first = pending_first_;
+            pending_first_ += batch.size();
+        }
+
+        write_batch_(first, batch.data(), batch.size());
+
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            done_ += batch.size();
+        }
+        done_cv_.notify_all();
+        batch.clear();
+    }
+}
+
+// ----------------------- reader -----------------------
+
+bool JournalReader::open(const std::string& dir, std::string& err) {
+    return list_journal_segments(dir, segs_, err);
+}
+
+uint64_t JournalReader::end_index() const {
+    if (segs_.empty()) return 0;
+    uint64_t end = segs_.front().first_index;
+    for (const auto& s : segs_) {
+        if (s.first_index != end) break;
+        end += s.records;
+    }
+    return end;
+}
+
+uint64_t JournalReader::scan(uint64_t from, uint64_t to, const ChunkFn& fn, std::string* err) const {
+    uint64_t visited = 0;
+    uint64_t expect = from;
+    for (const auto& s : segs_) {
+        const uint64_t s_end = s.first_index + s.records;
+        if (s_end <= from) continue;
+        if (expect >= to) break;
+        if (s.first_index > expect) {
+            if (err) *err = "gap in journal before index " + std::to_string(s.first_index);
+            break;
+        }
+
+        const int fd = ::open(s.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            if (err) *err = "open " + s.path + ": " + std::strerror(errno);
+            break;
+        }
+        // the writer may still be filling the last segment: take the count
+        // from the header now, and map only what it covers
+        MboFileHeader h;
+        struct stat st{};
+        if (!read_header(fd, h) || ::fstat(fd, &st) != 0) {
+            ::close(fd);
+            if (err) *err = "bad segment header: " + s.path;
+            break;
+        }
+        const uint64_t recs = mbo_file_record_count(h, (size_t)st.st_size);
+        const size_t bytes = sizeof(MboFileHeader) + recs * sizeof(MboRecord);
+        void* p = recs ? ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0) : nullptr;
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            if (err) *err = "mmap " + s.path + ": " + std::strerror(errno);
+            break;
+        }
+        if (p) ::madvise(p, bytes, MADV_SEQUENTIAL);
+
+        const auto* base = reinterpret_cast<const MboRecord*>(static_cast<const char*>(p) + sizeof(MboFileHeader));
+        const uint64_t lo = expect - s.first_index;
+        const uint64_t hi = std::min<uint64_t>(recs, to - s.first_index);
+        bool more = true;
+        if (hi > lo) {
+            more = fn(base + lo, (size_t)(hi - lo), expect);
+            visited += hi - lo;
+            expect += hi - lo;
+        }
+        if (p) ::munmap(p, bytes);
+        if (!more || recs < s.records) break;
+    }
+    return visited;
+}
+
+uint64_t replay_journal(const JournalReader& reader, MboOrderBook& book, uint64_t from, uint64_t to,
+                        const std::function<void(const MboRecord&)>& on_record) {
+    MboEvent e;
+    uint64_t applied = 0;
+    reader.scan(from, to, [&](const MboRecord* recs, size_t n, uint64_t) {
+        for (size_t i = 0; i < n; ++i) {
+            book_event_from_record(recs[i], e);
+            book.apply(e);
+            if (on_record) on_record(recs[i]);
+        }
+        applied += n;
+        return true;
+    });
+    return applied;
+}
+
+} // namespace mbo
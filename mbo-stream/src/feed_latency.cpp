@@ -0,0 +1,139 @@
+#include "mbo/feed_latency.hpp"
+
+#include <sstream>
+
+namespace mbo {
+
+// feed-side latencies above a minute are clamped (and counted as such)
+static constexpr uint64_t kHighestNs = 60'000'000'000ull;
+
+// first event closer than this to the wall clock => live feed, no rebase
+static constexpr int64_t kLiveThresholdNs = 60'000'000'000ll;
+
+const char* feed_latency_series_name(FeedLatencySeries s) {
+    switch (s) {
+        case FeedLatencySeries::RecvMinusEvent: return "recv_minus_event";
+        case FeedLatencySeries::InDelta:        return "in_delta";
+        case FeedLatencySeries::ApplyMinusRecv: return "apply_minus_recv";
+    }
+    return "?";
+}
+
+RollingHistogram::RollingHistogram(int digits, int64_t window_ns)
+    : window_ns_(window_ns > 0 ? window_ns : 60'000'000'000ll),
+      cur_(digits, kHighestNs), prev_(digits, kHighestNs), total_(digits, kHighestNs) {}
+
+void RollingHistogram::roll(int64_t t_ns) {
+    if (window_end_ == INT64_MIN) {
+        window_end_ = t_ns + window_ns_;
+        return;
+    }
+    // one window elapsed: current becomes previous; more than one: both stale
+    if (t_ns < window_end_ + window_ns_) {
+        prev_ = cur_;
+    } else {
+        prev_.reset();
+    }
+    cur_.reset();
+    while (window_end_ <= t_ns) window_end_ += window_ns_;
+}
+
+HdrHistogram RollingHistogram::rolling() const {
+    HdrHistogram h = prev_;
+    h.merge(cur_);
+    return h;
+}
+
+FeedLatencyTracker::PerSymbol::PerSymbol(int digits, int64_t window_ns)
+    : series{RollingHistogram(digits, window_ns), RollingHistogram(digits, window_ns),
+             RollingHistogram(digits, window_ns)} {}
+
+FeedLatencyTracker::FeedLatencyTracker(int digits, int64_t window_ns, int apply_sample_every)
+    : digits_(digits), window_ns_(window_ns), every_(apply_sample_every) {}
+
+FeedLatencyTracker::PerSymbol& FeedLatencyTracker::slot(const std::string& symbol) {
+    // one symbol per feed is the common case: skip the map lookup
+    if (last_slot_ && *last_symbol_ == symbol) return *last_slot_;
+    auto it = by_symbol_.find(symbol);
+    if (it == by_symbol_.end()) it = by_symbol_.emplace(symbol, PerSymbol(digits_, window_ns_)).first;
+    last_symbol_ = &it->first;
+    last_slot_ = &it->second;
+    return it->second;
+}
+
+void FeedLatencyTracker::record(const std::string& symbol, int64_t ts_recv_ns, int64_t ts_event_ns,
+                                int32_t ts_in_delta, int64_t apply_wall_ns) {
+    if (ts_recv_ns <= 0) return;
+    PerSymbol& ps = slot(symbol);
+
+    if (ts_event_ns > 0) {
+        const int64_t d = ts_recv_ns - ts_event_ns;
+        if (d >= 0) ps.series[(int)FeedLatencySeries::RecvMinusEvent].record((uint64_t)d, ts_recv_ns);
+        else negative_++;
+    }
+    if (ts_in_delta > 0) {
+        ps.series[(int)FeedLatencySeries::InDelta].record((uint64_t)ts_in_delta, ts_recv_ns);
+    }
+    if (apply_wall_ns > 0) {
+        int64_t d = apply_wall_ns - ts_recv_ns;
+        if (!apply_base_set_) {
+            apply_base_set_ = true;
+            apply_offset_ns_ = (d > kLiveThresholdNs || d < -kLiveThresholdNs) ? d : 0;
+        }
+        if (apply_offset_ns_ != 0 && d < apply_offset_ns_) apply_offset_ns_ = d;  // faster than any so far
+        d -= apply_offset_ns_;
+        if (d >= 0) ps.series[(int)FeedLatencySeries::ApplyMinusRecv].record((uint64_t)d, ts_recv_ns);
+        else negative_++;
+    }
+}
+
+std::string FeedLatencyTracker::to_json() const {
+    std::ostringstream os;
+    os << "{";
+    bool first = true;
+    for (const auto& [sym, ps] : by_symbol_) {
+        if (!first) os << ",";
+        first = false;
+        os << "\"" << sym << "\":{";
+        bool f2 = true;
+        for (int s = 0; s < kFeedLatencySeries; ++s) {
+            const HdrHistogram& h = ps.series[s].total();
+            if (h.count() == 0) continue;
+            if (!f2) os << ",";
+            f2 = false;
+            os << "\"" << feed_latency_series_name((FeedLatencySeries)s) << "\":" << h.to_json(1e3);
+        }
+        os << "}";
+    }
+    os << "}";
+    return os.str();
+}
+
+std::string FeedLatencyTracker::to_prometheus() const {
+    static const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+    std::ostringstream os;
+    os.precision(9);
+    if (by_symbol_.empty()) return {};
+    os << "# HELP mbo_feed_latency_seconds Feed timestamps per symbol: ts_recv-ts_event, ts_in_delta, "
+          "apply-ts_recv (quantiles over the rolling event-time window).\n"
+       << "# TYPE mbo_feed_latency_seconds summary\n";
+    for (const auto& [sym, ps] : by_symbol_) {
+        for (int s = 0; s < kFeedLatencySeries; ++s) {
+            const HdrHistogram& tot = ps.series[s].total();
+            if (tot.count() == 0) continue;
+            const char* name = feed_latency_series_name((FeedLatencySeries)s);
+            const HdrHistogram roll = ps.series[s].rolling();
+            for (double q : kQuantiles) {
+                os << "mbo_feed_latency_seconds{symbol=\"" << sym << "\",series=\"" << name
+                   << "\",quantile=\"" << q << "\"} " << (double)roll.value_at_percentile(q * 100.0) / 1e9 << "\n";
+            }
+            os << "mbo_feed_latency_seconds_sum{symbol=\"" << sym << "\",series=\"" << name << "\"} "
+               << tot.mean() * (double)tot.count() / 1e9 << "\n";
+            os << "mbo_feed_latency_seconds_count{symbol=\"" << sym << "\",series=\"" << name << "\"} "
+               << tot.count() << "\n";
+        }
+    }
+    return os.str();
+}
+
+} // namespace mbo
@@ -1,6 +1,6 @@
 #include "mbo/file_output.hpp"
+#include "mbo/logger.hpp"
 #include <fstream>
-#include <iostream>
 #include <system_error>
 
 namespace mbo {
@@ -35,7 +35,7 @@ static void write_file_atomic_like(const std::filesystem::path& out, const std::
     {
         std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
         if (!ofs) {
-            std::cerr << "[final] failed to open: " << tmp.string() << "\n";
+            MBO_LOG_ERROR("[final] failed to open: {}", tmp.string());
             return;
         }
         ofs.write(data.data(), (std::streamsize)data.size());
@@ -48,7 +48,7 @@ static void write_file_atomic_like(const std::filesystem::path& out, const std::
         // fallback: if rename failed (e.g. across FS), try direct write
         std::ofstream ofs(out, std::ios::binary | std::ios::trunc);
         if (!ofs) {
-            std::cerr << "[final] failed to open: " << out.string() << "\n";
+            MBO_LOG_ERROR("[final] failed to open: {}", out.string());
             return;
         }
         ofs.write(data.data(), (std::streamsize)data.size());
@@ -57,8 +57,7 @@ static void write_file_atomic_like(const std::filesystem::path& out, const std::
         std::filesystem::remove(tmp, ec);
     }
 
-    std::cerr << "[final] wrote " << out.string()
-              << " (" << data.size() << " bytes)\n";
+    MBO_LOG_INFO("[final] wrote {} ({} bytes)", out.string(), data.size());
 }
 
 void write_final_books_json(const std::string& book_json, const std::string& symbol, int /*depth_full*/) {
@@ -1,6 +1,7 @@
 #include "mbo/jsonl_writer.hpp"
 #include <filesystem>
 #include <iostream>
+#include <sstream>
 
 namespace mbo {
 
@@ -51,10 +52,8 @@ void JsonlWriter::write_feed(const FeedLine& line) {
         << "}\n";
 }
 
-void JsonlWriter::write_bench(const BenchLine& b) {
-    if (!is_open()) return;
-
-    ofs_
+static void write_bench_json(std::ostream& os, const BenchLine& b) {
+    os
         << "{"
         << "\"ts_wall_us\":" << b.ts_wall_us
         << ",\"host\":\"" << b.host << "\""
@@ -71,8 +70,76 @@ void JsonlWriter::write_bench(const BenchLine& b) {
         << ",\"apply_p99_us\":" << b.apply_p99_us
         << ",\"snap_p50_ms\":" << b.snap_p50_ms
         << ",\"snap_p95_ms\":" << b.snap_p95_ms
-        << ",\"snap_p99_ms\":" << b.snap_p99_ms
-        << "}\n";
+        << ",\"snap_p99_ms\":" << b.snap_p99_ms;
+    if (!b.apply_hist_json.empty()) os << ",\"apply_hist_us\":" << b.apply_hist_json;
+    if (!b.snap_hist_json.empty()) os << ",\"snap_hist_ms\":" << b.snap_hist_json;
+    if (!b.stages_json.empty()) os << ",\"stages_us\":" << b.stages_json;
+    if (!b.feed_latency_json.empty()) os << ",\"feed_latency_us\":" << b.feed_latency_json;
+    if (!b.rx_json.empty()) os << ",\"rx_us\":" << b.rx_json;
+    if (!b.book_arena_json.empty()) os << ",\"book_arena\":" << b.book_arena_json;
+    if (b.e2e_stamped > 0) {
+        os
+            << ",\"e2e_stamped\":" << b.e2e_stamped
+            << ",\"e2e_send_apply_p50_us\":" << b.e2e_send_apply_p50_us
+            << ",\"e2e_send_apply_p99_us\":" << b.e2e_send_apply_p99_us
+            << ",\"e2e_send_publish_p50_us\":" << b.e2e_send_publish_p50_us
+            << ",\"e2e_send_publish_p99_us\":" << b.e2e_send_publish_p99_us;
+    }
+    if (b.catchup_entries > 0) {
+        os
+            << ",\"catchup_entries\":" << b.catchup_entries
+            << ",\"catchup_s\":" << b.catchup_s
+            << ",\"snapshots_conflated\":" << b.snapshots_conflated;
+    }
+    if (!b.alloc_json.empty()) os << ",\"alloc\":" << b.alloc_json;
+    if (!b.perf_apply_json.empty()) os << ",\"perf_apply\":" << b.perf_apply_json;
+    if (!b.perf_snap_json.empty()) os << ",\"perf_snap\":" << b.perf_snap_json;
+    os << "}";
+}
+
+
+void JsonlWriter::write_bench(const BenchLine& b) {
+    if (!is_open()) return;
+    write_bench_json(ofs_, b);
+    ofs_ << "\n";
+}
+
+std::string to_json(const BenchLine& b) {
+    std::ostringstream oss;
+    write_bench_json(oss, b);
+    return oss.str();
+}
+
+std::string to_json(const IntervalLine& b) {
+    std::ostringstream os;
+    os.precision(12);
+    os << "{\"type\":\"interval\""
+       << ",\"ts_wall_us\":" << b.ts_wall_us
+       << ",\"host\":\"" << b.host << "\""
+       << ",\"port\":" << b.port
+       << ",\"session\":" << b.session
+       << ",\"interval\":" << b.interval
+       << ",\"interval_s\":" << b.interval_s
+       << ",\"elapsed_s\":" << b.elapsed_s
+       << ",\"events\":" << b.events
+       << ",\"events_total\":" << b.events_total
+       << ",\"parse_errors\":" << b.parse_errors
+       << ",\"bytes\":" << b.bytes
+       << ",\"throughput_msgs_per_s\":" << b.throughput_msgs_per_s
+       << ",\"event_lag_ms\":" << b.event_lag_ms
+       << ",\"event_time_advance_s\":" << b.event_time_advance_s
+       << ",\"read_backlog_hwm_bytes\":" << b.read_backlog_hwm_bytes
+       << ",\"pg_queue_hwm\":" << b.pg_queue_hwm
+       << ",\"pg_dropped\":" << b.pg_dropped
+       << ",\"feed_backlog_bytes\":" << b.feed_backlog_bytes
+       << ",\"event_drift_ms\":" << b.event_drift_ms
+       << ",\"catchup\":" << (b.catchup ? "true" : "false")
+       << ",\"catchup_s\":" << b.catchup_s
+       << ",\"rss_bytes\":" << b.rss_bytes
+       << ",\"rss_peak_bytes\":" << b.rss_peak_bytes;
+    if (!b.stages_json.empty()) os << ",\"stages_us\":" << b.stages_json;
+    os << "}";
+    return os.str();
 }
 
 } // namespace mbo
@@ -0,0 +1,301 @@
+#include "mbo/logger.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mbo {
+
+namespace {
+
+LogLevel level_from_env() {
+    LogLevel lvl = LogLevel::Info;
+    if (const char* s = std::getenv("LOG_LEVEL"); s && *s) parse_log_level(s, lvl);
+    return lvl;
+}
+
+// Single-producer (the owning thread) / single-consumer (the log thread) ring.
+struct LogRing {
+    alignas(64) std::atomic<uint64_t> head{0};   // next slot to write (producer)
+    alignas(64) std::atomic<uint64_t> tail{0};   // next slot to read (consumer)
+    std::atomic<bool> orphaned{false};           // owning thread has exited
+    LogRecord slots[kLogRingSlots];
+};
+
+class LogBackend {
+public:
+    static LogBackend& get() {
+        // leaked on purpose: thread_local ring holders and atexit may run after
+        // static destructors
+        static LogBackend* b = new LogBackend();
+        return *b;
+    }
+
+    LogRing* register_ring() {
+        auto* r = new LogRing();
+        std::lock_guard<std::mutex> lk(mtx_);
+        rings_.push_back(r);
+        if (!thread_.joinable() && !stopped_) {
+            thread_ = std::thread([this] { run(); });
+            std::atexit([] { log_shutdown(); });
+        }
+        return r;
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lk(mtx_);
+        if (!thread_.joinable()) return;
+        const uint64_t req = ++flush_req_;
+        cv_.notify_all();
+        done_cv_.wait(lk, [&] { return flush_done_ >= req || !thread_.joinable(); });
+    }
+
+    void shutdown() {
+        std::thread t;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (!thread_.joinable()) return;
+            stop_ = true;
+            stopped_ = true;  // no restart by a late log call
+            t = std::move(thread_);
+        }
+        cv_.notify_all();
+        t.join();
+        done_cv_.notify_all();
+    }
+
+    std::atomic<uint64_t> dropped{0};
+
+private:
+    LogBackend() {
+        if (const char* p = std::getenv("LOG_PATH"); p && *p) {
+            out_ = std::fopen(p, "a");
+            if (!out_) std::fprintf(stderr, "[log] failed to open LOG_PATH=%s, using stderr\n", p);
+        }
+        if (!out_) out_ = stderr;
+    }
+
+    void run() {
+        std::vector<std::pair<uint64_t, std::string>> batch;
+        std::string buf;
+        uint64_t reported_drops = 0;
+
+        while (true) {
+            uint64_t req;
+            bool stopping;
+            std::vector<LogRing*> rings;
+            {
+                std::unique_lock<std::mutex> lk(mtx_);
+                cv_.wait_for(lk, std::chrono::milliseconds(2),
+                             [&] { return stop_ || flush_req_ > flush_done_; });
+                req = flush_req_;
+                stopping = stop_;
+                rings = rings_;
+            }
+
+            // drain every ring; records are formatted here, never on the producer
+            batch.clear();
+            int sources = 0;
+            for (LogRing* r : rings) {
+                const uint64_t head = r->head.load(std::memory_order_acquire);
+                uint64_t tail = r->tail.load(std::memory_order_relaxed);
+                if (tail != head) ++sources;
+                for (; tail != head; ++tail) {
+                    const LogRecord& rec = r->slots[tail & (kLogRingSlots - 1)];
+                    batch.emplace_back(rec.ts_ns, std::string());
+                    format_log_record(rec, batch.back().second);
+                }
+                r->tail.store(tail, std::memory_order_release);
+            }
+            reap_orphans();
+
+            const uint64_t d = dropped.load(std::memory_order_relaxed);
+            if (d != reported_drops) {
+                std::string line = "[log] " + std::to_string(d - reported_drops) +
+                                   " record(s) dropped (ring full)\n";
+                batch.emplace_back(batch.empty() ? 0 : batch.back().first, std::move(line));
+                reported_drops = d;
+            }
+
+            if (!batch.empty()) {
+                if (sources > 1) {
+                    std::stable_sort(batch.begin(), batch.end(),
+                                     [](const auto& a, const auto& b) { return a.first < b.first; });
+                }
+                buf.clear();
+                for (const auto& e : batch) buf += e.second;
+                std::fwrite(buf.data(), 1, buf.size(), out_);
+                std::fflush(out_);
+            }
+
+            {
+                std::lock_guard<std::mutex> lk(mtx_);
+                if (req > flush_done_) flush_done_ = req;
+            }
+            done_cv_.notify_all();
+            if (stopping) break;
+        }
+    }
+
+    // free rings whose thread has exited, once they are drained
+    void reap_orphans() {
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto it = std::remove_if(rings_.begin(), rings_.end(), [](LogRing* r) {
+            if (!r->orphaned.load(std::memory_order_acquire)) return false;
+            if (r->tail.load(std::memory_order_relaxed) != r->head.load(std::memory_order_acquire)) return false;
+            delete r;
+            return true;
+        });
+        rings_.erase(it, rings_.end());
+    }
+
+    std::FILE* out_ = nullptr;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::vector<LogRing*> rings_;
+    std::thread thread_;
+    bool stop_ = false;
+    bool stopped_ = false;
+    uint64_t flush_req_ = 0;
+    uint64_t flush_done_ = 0;
+};
+
+struct ThreadRing {
+    LogRing* ring = nullptr;
+    ~ThreadRing() {
+        if (ring) ring->orphaned.store(true, std::memory_order_release);
+    }
+};
+
+thread_local ThreadRing t_ring;
+
+void append_u64(std::string& out, uint64_t v) {
+    char tmp[24];
+    const int n = std::snprintf(tmp, sizeof tmp, "%llu", (unsigned long long)v);
+    out.append(tmp, (size_t)n);
+}
+
+void append_arg(std::string& out, const LogRecord& r, int i) {
+    char tmp[40];
+    int n = 0;
+    switch (r.kind[i]) {
+        case LogArgKind::I64:
+            n = std::snprintf(tmp, sizeof tmp, "%lld", (long long)(int64_t)r.arg[i]);
+            break;
+        case LogArgKind::U64:
+            append_u64(out, r.arg[i]);
+            return;
+        case LogArgKind::F64: {
+            double d;
+            std::memcpy(&d, &r.arg[i], sizeof d);
+            n = std::snprintf(tmp, sizeof tmp, "%g", d);
+            break;
+        }
+        case LogArgKind::Bool:
+            out += r.arg[i] ? "true" : "false";
+            return;
+        case LogArgKind::Str:
+            out.append(r.text + (r.arg[i] >> 16), (size_t)(r.arg[i] & 0xffff));
+            return;
+    }
+    out.append(tmp, (size_t)n);
+}
+
+} // namespace
+
+namespace detail {
+
+std::atomic<uint8_t> g_log_level{(uint8_t)level_from_env()};
+
+void log_submit(const LogRecord& rec) {
+    LogRing* r = t_ring.ring;
+    if (!r) r = t_ring.ring = LogBackend::get().register_ring();
+
+    const uint64_t head = r->head.load(std::memory_order_relaxed);
+    if (head - r->tail.load(std::memory_order_acquire) >= kLogRingSlots) {
+        LogBackend::get().dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    LogRecord& slot = r->slots[head & (kLogRingSlots - 1)];
+    // copy only the used part of the text area
+    std::memcpy(&slot, &rec, offsetof(LogRecord, text));
+    std::memcpy(slot.text, rec.text, rec.text_len);
+    r->head.store(head + 1, std::memory_order_release);
+}
+
+} // namespace detail
+
+LogLevel log_level() { return (LogLevel)detail::g_log_level.load(std::memory_order_relaxed); }
+
+void set_log_level(LogLevel lvl) { detail::g_log_level.store((uint8_t)lvl, std::memory_order_relaxed); }
+
+bool parse_log_level(const char* s, LogLevel& out) {
+    std::string v(s ? s : "");
+    for (auto& c : v) c = (char)std::tolower((unsigned char)c);
+    if (v == "error") out = LogLevel::Error;
+    else if (v == "warn" || v == "warning") out = LogLevel::Warn;
+    else if (v == "info") out = LogLevel::Info;
+    else if (v == "debug") out = LogLevel::Debug;
+    else if (v == "trace") out = LogLevel::Trace;
+    else return false;
+    return true;
+}
+
+const char* log_level_name(LogLevel lvl) {
+    switch (lvl) {
+        case LogLevel::Error: return "error";
+        case LogLevel::Warn:  return "warn";
+        case LogLevel::Info:  return "info";
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Trace: return "trace";
+    }
+    return "?";
+}
+
+void log_flush() { LogBackend::get().flush(); }
+
+void log_shutdown() { LogBackend::get().shutdown(); }
+
+uint64_t log_dropped() { return LogBackend::get().dropped.load(std::memory_order_relaxed); }
+
+void format_log_record(const LogRecord& r, std::string& out) {
+    // 2026-01-02T03:04:05.123456Z
+    const time_t sec = (time_t)(r.ts_ns / 1'000'000'000ull);
+    std::tm tm{};
+    gmtime_r(&sec, &tm);
+    char ts[40];
+    const int n = std::snprintf(ts, sizeof ts, "%04d-%02d-%02dT%02d:%02d:%02d.%06uZ ",
+                                tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                                tm.tm_hour, tm.tm_min, tm.tm_sec,
+                                (unsigned)((r.ts_ns / 1000) % 1'000'000));
+    out.append(ts, (size_t)n);
+    out += "EWIDT"[(int)r.level];
+    out += ' ';
+
+    int next = 0;
+    for (const char* p = r.fmt ? r.fmt : ""; *p; ++p) {
+        if (p[0] == '{' && p[1] == '}') {
+            if (next < r.nargs) append_arg(out, r, next++);
+            ++p;
+        } else {
+            out += *p;
+        }
+    }
+    if (r.suppressed) {
+        out += " (";
+        append_u64(out, r.suppressed);
+        out += " suppressed)";
+    }
+    if (out.empty() || out.back() != '\n') out += '\n';
+}
+
+} // namespace mbo
@@ -4,8 +4,50 @@
 #include <iomanip>
 #include <algorithm>
 
-MboOrderBook::MboOrderBook(std::string sym)
-    : symbol_(std::move(sym)) {}
+MboOrderBook::MboOrderBook(std::string sym, mbo::BookArena* arena, size_t expected_orders)
+    : symbol_(std::move(sym)),
+      arena_(arena),
+      expected_orders_(expected_orders),
+      bids_(std::greater<int64_t>(), mbo::ArenaAllocator<std::pair<const int64_t, OrderQueue>>(arena)),
+      asks_(std::less<int64_t>(), mbo::ArenaAllocator<std::pair<const int64_t, OrderQueue>>(arena)),
+      index_(0, std::hash<int64_t>(), std::equal_to<int64_t>(),
+             mbo::ArenaAllocator<std::pair<const int64_t, OrderRef>>(arena)) {
+    // one bucket array up front instead of a rehash cascade during the first burst
+    if (expected_orders > 0) index_.reserve(expected_orders);
+}
+
+template <typename Cmp>
+OrderQueue& MboOrderBook::level_(Levels<Cmp>& side, int64_t price) {
+    auto it = side.lower_bound(price);
+    if (it == side.end() || it->first != price) {
+        it = side.emplace_hint(it, price, OrderQueue(mbo::ArenaAllocator<Order>(arena_)));
+    }
+    return it->second;
+}
+
+template <typename Cmp>
+bool MboOrderBook::restore_level_(Levels<Cmp>& side, bool is_buy, int64_t price, const Order* orders, size_t n) {
+    if (n == 0) return true;
+    if (!side.empty() && !side.key_comp()(std::prev(side.end())->first, price)) return false;
+
+    // strictly worse than every existing level: the end is the right hint
+    auto lvl = side.emplace_hint(side.end(), price, OrderQueue(mbo::ArenaAllocator<Order>(arena_)));
+    OrderQueue& q = lvl->second;
+    for (size_t i = 0; i < n; ++i) {
+        q.push_back(Order{orders[i].order_id, price, orders[i].qty});
+        if (!index_.emplace(orders[i].order_id, OrderRef{is_buy, price, std::prev(q.end())}).second) {
+            q.pop_back();
+            if (q.empty()) side.erase(lvl);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MboOrderBook::restore_level(bool is_buy, int64_t price, const Order* orders, size_t n) {
+    return is_buy ? restore_level_(bids_, true, price, orders, n)
+                  : restore_level_(asks_, false, price, orders, n);
+}
 
 static inline bool is_buy_side(char side) {
     return side == 'B';
@@ -66,12 +108,12 @@ void MboOrderBook::add_(const MboEvent& e) {
 
     // Insert at end of FIFO queue for this price level
     if (is_buy) {
-        auto& q = bids_[e.price];
+        auto& q = level_(bids_, e.price);
         q.push_back(Order{e.order_id, e.price, e.size});
         auto it = std::prev(q.end());
         index_.emplace(e.order_id, OrderRef{true, e.price, it});
     } else {
-        auto& q = asks_[e.price];
+        auto& q = level_(asks_, e.price);
         q.push_back(Order{e.order_id, e.price, e.size});
         auto it = std::prev(q.end());
         index_.emplace(e.order_id, OrderRef{false, e.price, it});
@@ -138,7 +180,7 @@ void MboOrderBook::modify_(const MboEvent& e) {
                 if (oldLvlIt->second.empty()) bids_.erase(oldLvlIt);
             }
 
-            auto& newQ = bids_[e.price];
+            auto& newQ = level_(bids_, e.price);
             newQ.push_back(Order{e.order_id, e.price, e.size});
             ref.price = e.price;
             ref.it = std::prev(newQ.end());
@@ -167,7 +209,7 @@ void MboOrderBook::modify_(const MboEvent& e) {
                 if (oldLvlIt->second.empty()) asks_.erase(oldLvlIt);
             }
 
-            auto& newQ = asks_[e.price];
+            auto& newQ = level_(asks_, e.price);
             newQ.push_back(Order{e.order_id, e.price, e.size});
             ref.price = e.price;
             ref.it = std::prev(newQ.end());
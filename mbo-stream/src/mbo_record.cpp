@@ -0,0 +1,116 @@
+#include "mbo/mbo_record.hpp"
+#include "mbo/timestamp.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace mbo {
+
+bool valid_mbo_file_header(const MboFileHeader& h) {
+    return std::memcmp(h.magic, "MBOB", 4) == 0 &&
+           h.version == 1 &&
+           h.record_size == sizeof(MboRecord);
+}
+
+void set_record_symbol(MboRecord& r, const std::string& symbol) {
+    std::memset(r.symbol, 0, sizeof(r.symbol));
+    std::memcpy(r.symbol, symbol.data(), std::min(symbol.size(), sizeof(r.symbol)));
+}
+
+std::string record_symbol(const MboRecord& r) {
+    return std::string(r.symbol, strnlen(r.symbol, sizeof(r.symbol)));
+}
+
+void event_from_record(const MboRecord& r, MboEvent& out) {
+    out.ts_recv = iso8601_ns(r.ts_recv_ns);
+    out.ts_event = iso8601_ns(r.ts_event_ns);
+    out.publisher_id = r.publisher_id;
+    out.instrument_id = r.instrument_id;
+    out.action = r.action;
+    out.side = r.side;
+    out.price = r.price;
+    out.size = r.size;
+    out.order_id = r.order_id;
+    out.flags = r.flags;
+    out.ts_in_delta = r.ts_in_delta;
+    out.sequence = r.sequence;
+    out.symbol = record_symbol(r);
+    out.ts_send_ns = 0;
+}
+
+bool record_from_event(const MboEvent& e, MboRecord& out) {
+    int64_t recv_ns = 0, event_ns = 0;
+    if (!parse_iso8601_ns(e.ts_recv, recv_ns)) return false;
+    if (!parse_iso8601_ns(e.ts_event, event_ns)) return false;
+    record_from_event(e, recv_ns, event_ns, out);
+    return true;
+}
+
+void record_from_event(const MboEvent& e, int64_t ts_recv_ns, int64_t ts_event_ns, MboRecord& out) {
+    out = MboRecord{};
+    out.ts_recv_ns = ts_recv_ns;
+    out.ts_event_ns = ts_event_ns;
+    out.publisher_id = (uint16_t)e.publisher_id;
+    out.instrument_id = e.instrument_id;
+    out.action = e.action;
+    out.side = e.side;
+    out.price = e.price;
+    out.size = e.size;
+    out.order_id = e.order_id;
+    out.flags = e.flags;
+    out.ts_in_delta = e.ts_in_delta;
+    out.sequence = e.sequence;
+    set_record_symbol(out, e.symbol);
+}
+
+void book_event_from_record(const MboRecord& r, MboEvent& out) {
+    out.action = r.action;
+    out.side = r.side;
+    out.price = r.price;
+    out.size = r.size;
+    out.order_id = r.order_id;
+    out.flags = r.flags;
+    out.sequence = r.sequence;
+}
+
+size_t mbo_file_record_count(const MboFileHeader& h, size_t file_bytes) {
+    const size_t n = file_bytes > sizeof(h) ? (file_bytes - sizeof(h)) / sizeof(MboRecord) : 0;
+    if (h.flags & kMboFileCounted) return std::min<size_t>(n, h.record_count);
+    return n;
+}
+
+bool read_mbo_records(const std::string& path, std::vector<MboRecord>& out) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        std::cerr << "[mbob] failed to open: " << path << "\n";
+        return false;
+    }
+
+    MboFileHeader h;
+    if (std::fread(&h, sizeof(h), 1, f) != 1 || !valid_mbo_file_header(h)) {
+        std::cerr << "[mbob] bad header: " << path << "\n";
+        std::fclose(f);
+        return false;
+    }
+
+    std::fseek(f, 0, SEEK_END);
+    const long end = std::ftell(f);
+    std::fseek(f, (long)sizeof(h), SEEK_SET);
+    const size_t n = mbo_file_record_count(h, end > 0 ? (size_t)end : 0);
+
+    out.resize(n);
+    const size_t got = n ? std::fread(out.data(), sizeof(MboRecord), n, f) : 0;
+    std::fclose(f);
+    out.resize(got);
+    return true;
+}
+
+bool is_mbo_record_path(const std::string& path) {
+    static const std::string ext = ".mbob";
+    return path.size() >= ext.size() &&
+           path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+} // namespace mbo
@@ -0,0 +1,167 @@
+#include "mbo/metrics.hpp"
+
+#include <mutex>
+#include <sstream>
+
+namespace mbo {
+
+const uint64_t StageMetric::kBoundsNs[StageMetric::kBuckets] = {
+    50, 100, 250, 500,
+    1'000, 2'500, 5'000, 10'000, 25'000, 50'000, 100'000, 250'000, 500'000,
+    1'000'000, 2'500'000, 5'000'000, 10'000'000, 25'000'000, 50'000'000, 100'000'000,
+};
+
+EngineMetrics& metrics() {
+    static EngineMetrics m;
+    return m;
+}
+
+namespace {
+std::mutex g_feed_latency_mtx;
+std::string g_feed_latency_text;
+} // namespace
+
+void set_feed_latency_prometheus(std::string text) {
+    std::lock_guard<std::mutex> lk(g_feed_latency_mtx);
+    g_feed_latency_text = std::move(text);
+}
+
+namespace {
+
+uint64_t rd(const std::atomic<uint64_t>& a) { return a.load(std::memory_order_relaxed); }
+
+void header(std::ostringstream& os, const char* name, const char* type, const char* help) {
+    os << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+}
+
+void counter(std::ostringstream& os, const char* name, const char* help, const std::atomic<uint64_t>& v) {
+    header(os, name, "counter", help);
+    os << name << " " << rd(v) << "\n";
+}
+
+void gauge(std::ostringstream& os, const char* name, const char* help, const std::atomic<uint64_t>& v) {
+    header(os, name, "gauge", help);
+    os << name << " " << rd(v) << "\n";
+}
+
+// one labelled series of a StageMetric histogram (HELP/TYPE written by the caller)
+void histogram(std::ostringstream& os, const char* name, const char* label, const char* value,
+               const StageMetric& sm) {
+    uint64_t cum = 0;
+    for (int b = 0; b < StageMetric::kBuckets; ++b) {
+        cum += rd(sm.bucket[b]);
+        os << name << "_bucket{" << label << "=\"" << value << "\",le=\""
+           << (double)StageMetric::kBoundsNs[b] / 1e9 << "\"} " << cum << "\n";
+    }
+    cum += rd(sm.bucket[StageMetric::kBuckets]);
+    os << name << "_bucket{" << label << "=\"" << value << "\",le=\"+Inf\"} " << cum << "\n";
+    os << name << "_sum{" << label << "=\"" << value << "\"} " << (double)rd(sm.sum_ns) / 1e9 << "\n";
+    os << name << "_count{" << label << "=\"" << value << "\"} " << rd(sm.count) << "\n";
+}
+
+} // namespace
+
+const char* rx_leg_name(RxLeg leg) {
+    switch (leg) {
+        case RxLeg::RxToParse:    return "rx_to_parse";
+        case RxLeg::ParseToApply: return "parse_to_apply";
+        case RxLeg::RxToApply:    return "rx_to_apply";
+    }
+    return "?";
+}
+
+std::string render_prometheus(const EngineMetrics& m) {
+    std::ostringstream os;
+    os.precision(9);
+
+    // ingest
+    counter(os, "mbo_feed_sessions_total", "Replay feed sessions started.", m.sessions_total);
+    gauge(os, "mbo_feed_connected", "1 while a feed session is active.", m.feed_connected);
+    counter(os, "mbo_feed_bytes_total", "Bytes read from the feed socket.", m.bytes_read_total);
+    counter(os, "mbo_feed_resumes_total", "Feed sessions resumed on the kept book after a drop (FEED_RESUME).",
+            m.feed_resumes_total);
+    counter(os, "mbo_feed_empty_polls_total", "Busy-poll reads that found the feed socket empty (BUSY_POLL).",
+            m.feed_empty_polls_total);
+    counter(os, "mbo_feed_lines_total", "Data lines received (headers excluded).", m.lines_total);
+    counter(os, "mbo_events_total", "Events applied to the book.", m.events_total);
+    gauge(os, "mbo_events_per_second", "Events applied over the last second.", m.events_per_s);
+    counter(os, "mbo_parse_errors_total", "Lines that failed to parse.", m.parse_errors_total);
+    counter(os, "mbo_snapshots_total", "Book snapshots built and published.", m.snapshots_total);
+
+    // lag / catch-up
+    gauge(os, "mbo_feed_backlog_bytes", "Unread bytes in the feed socket receive queue (FIONREAD).",
+          m.feed_backlog_bytes);
+    header(os, "mbo_event_time_drift_seconds", "gauge",
+           "Wall-clock progress beyond event-time progress since the session baseline.");
+    os << "mbo_event_time_drift_seconds " << (double)rd(m.event_drift_us) / 1e6 << "\n";
+    gauge(os, "mbo_catchup_active", "1 while the engine is in catch-up mode (apply only).", m.catchup_active);
+    header(os, "mbo_catchup_transitions_total", "counter", "Catch-up mode transitions.");
+    os << "mbo_catchup_transitions_total{to=\"catchup\"} " << rd(m.catchup_entries_total) << "\n";
+    os << "mbo_catchup_transitions_total{to=\"normal\"} " << rd(m.catchup_exits_total) << "\n";
+    header(os, "mbo_catchup_seconds_total", "counter", "Time spent in catch-up mode.");
+    os << "mbo_catchup_seconds_total " << (double)rd(m.catchup_ns_total) / 1e9 << "\n";
+    counter(os, "mbo_snapshots_conflated_total",
+            "Snapshot boundaries skipped in catch-up mode.", m.snapshots_conflated_total);
+
+    // book
+    gauge(os, "mbo_book_orders", "Resting orders in the book (as of the last snapshot).", m.book_orders);
+    header(os, "mbo_book_levels", "gauge", "Price levels per side (as of the last snapshot).");
+    os << "mbo_book_levels{side=\"bid\"} " << rd(m.book_bid_levels) << "\n";
+    os << "mbo_book_levels{side=\"ask\"} " << rd(m.book_ask_levels) << "\n";
+
+    // checkpoints
+    counter(os, "mbo_checkpoints_total", "Book checkpoints written (CHECKPOINT_PATH).", m.checkpoints_total);
+    counter(os, "mbo_checkpoint_failures_total", "Book checkpoints that failed (fork or write).",
+            m.checkpoint_failures_total);
+    header(os, "mbo_checkpoint_fork_seconds", "gauge", "Ingest-thread stall of the last checkpoint fork().");
+    os << "mbo_checkpoint_fork_seconds " << (double)rd(m.checkpoint_fork_us) / 1e6 << "\n";
+    gauge(os, "mbo_checkpoint_bytes", "Size of the last good book checkpoint.", m.checkpoint_bytes);
+
+    // journal
+    counter(os, "mbo_journal_records_total", "Events written to the event journal (JOURNAL_DIR).",
+            m.journal_records_total);
+    counter(os, "mbo_journal_dropped_total", "Events not journaled because the journal writer fell behind.",
+            m.journal_dropped_total);
+    counter(os, "mbo_journal_segments_total", "Journal segment files created.", m.journal_segments_total);
+
+    // stages
+    header(os, "mbo_stage_duration_seconds", "histogram",
+           "Sampled per-stage latency on the ingest thread (STAGE_SAMPLE_EVERY).");
+    for (int s = 0; s < kStageCount; ++s) {
+        histogram(os, "mbo_stage_duration_seconds", "stage", stage_name((Stage)s), m.stage[s]);
+    }
+
+    // kernel receive timestamp -> parse -> apply
+    header(os, "mbo_rx_latency_seconds", "histogram",
+           "Sampled latency from the kernel receive timestamp of a read batch to parse start / apply done.");
+    for (int l = 0; l < kRxLegCount; ++l) {
+        histogram(os, "mbo_rx_latency_seconds", "leg", rx_leg_name((RxLeg)l), m.rx[l]);
+    }
+
+    // persistence
+    gauge(os, "mbo_pg_queue_depth", "Snapshot rows waiting for the PG writer.", m.pg_queue_depth);
+    gauge(os, "mbo_pg_queue_high_water", "Largest PG queue depth seen.", m.pg_queue_high_water);
+    counter(os, "mbo_pg_rows_enqueued_total", "Snapshot rows handed to the PG queue.", m.pg_rows_enqueued);
+    counter(os, "mbo_pg_rows_written_total", "Snapshot rows written to PostgreSQL.", m.pg_rows_written);
+    counter(os, "mbo_pg_rows_failed_total", "Snapshot rows whose INSERT failed.", m.pg_rows_failed);
+    counter(os, "mbo_pg_rows_dropped_total", "Snapshot rows evicted because the queue was full.", m.pg_rows_dropped);
+
+    // websocket
+    gauge(os, "mbo_ws_sessions", "Open WebSocket sessions.", m.ws_sessions_active);
+    counter(os, "mbo_ws_sessions_total", "WebSocket sessions accepted.", m.ws_sessions_total);
+    counter(os, "mbo_ws_frames_total", "Snapshot frames written to WebSocket clients.", m.ws_frames_total);
+    counter(os, "mbo_ws_bytes_total", "Snapshot bytes written to WebSocket clients.", m.ws_bytes_total);
+    counter(os, "mbo_ws_conflations_total",
+            "Push ticks skipped because the previous frame was still being written.", m.ws_conflations_total);
+    counter(os, "mbo_ws_write_errors_total", "WebSocket writes that failed.", m.ws_write_errors_total);
+
+    // per-symbol feed latency (rendered by the ingest thread)
+    {
+        std::lock_guard<std::mutex> lk(g_feed_latency_mtx);
+        os << g_feed_latency_text;
+    }
+
+    return os.str();
+}
+
+} // namespace mbo
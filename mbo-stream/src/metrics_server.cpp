@@ -0,0 +1,201 @@
+#include "mbo/metrics_server.hpp"
+#include "mbo/as_of.hpp"
+#include "mbo/metrics.hpp"
+
+#include <boost/beast.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+using boost::asio::ip::tcp;
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+class MetricsSession : public std::enable_shared_from_this<MetricsSession> {
+public:
+    explicit MetricsSession(tcp::socket socket) : stream_(std::move(socket)) {}
+
+    void run() { do_read(); }
+
+private:
+    beast::tcp_stream stream_;
+    beast::flat_buffer buf_;
+    http::request<http::string_body> req_;
+    std::shared_ptr<http::response<http::string_body>> res_;
+
+    void do_read() {
+        req_ = {};
+        stream_.expires_after(std::chrono::seconds(30));
+        http::async_read(stream_, buf_, req_,
+                         beast::bind_front_handler(&MetricsSession::on_read, shared_from_this()));
+    }
+
+    // value of `key` in a query string ("a=1&b=2"), %XX / '+' decoded
+    static bool query_param(std::string_view q, std::string_view key, std::string& out) {
+        while (!q.empty()) {
+            const size_t amp = q.find('&');
+            const std::string_view kv = q.substr(0, amp);
+            q = amp == std::string_view::npos ? std::string_view{} : q.substr(amp + 1);
+            const size_t eq = kv.find('=');
+            if (kv.substr(0, eq) != key) continue;
+            out.clear();
+            const std::string_view v = eq == std::string_view::npos ? std::string_view{} : kv.substr(eq + 1);
+            for (size_t i = 0; i < v.size(); ++i) {
+                if (v[i] == '%' && i + 2 < v.size() && std::isxdigit((unsigned char)v[i + 1]) &&
+                    std::isxdigit((unsigned char)v[i + 2])) {
+                    out += (char)std::stoi(std::string(v.substr(i + 1, 2)), nullptr, 16);
+                    i += 2;
+                } else {
+                    out += v[i] == '+' ? ' ' : v[i];
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // GET /asof?ts=<ISO-8601 | epoch ns>&depth=N: answered by the as-of
+    // service thread, written back on this session's strand
+    void handle_asof(std::string_view query) {
+        auto* svc = mbo::asof_service();
+        if (!svc) {
+            reply(http::status::not_found, "text/plain", "as-of queries need JOURNAL_DIR (and ASOF=1)\n");
+            return;
+        }
+        std::string ts_s, depth_s;
+        int64_t ts_ns = 0;
+        if (!query_param(query, "ts", ts_s) || !mbo::parse_asof_time(ts_s, ts_ns)) {
+            reply(http::status::bad_request, "application/json",
+                  mbo::asof_error_json("ts must be ISO-8601 (2025-09-24T19:30:00.123Z) or epoch ns"));
+            return;
+        }
+        int depth = 10;
+        if (query_param(query, "depth", depth_s)) depth = std::atoi(depth_s.c_str());
+        depth = std::max(1, std::min(depth, 10000));
+
+        svc->submit(ts_ns, depth, [self = shared_from_this()](bool ok, std::string json) {
+            boost::asio::post(self->stream_.get_executor(), [self, ok, json = std::move(json)]() mutable {
+                self->reply(ok ? http::status::ok : http::status::bad_request, "application/json", std::move(json));
+            });
+        });
+    }
+
+    void reply(http::status status, const char* content_type, std::string body) {
+        auto res = std::make_shared<http::response<http::string_body>>();
+        res->version(req_.version());
+        res->keep_alive(req_.keep_alive());
+        res->set(http::field::server, "tcp_main_ws");
+        res->result(status);
+        res->set(http::field::content_type, content_type);
+        res->body() = std::move(body);
+        res->prepare_payload();
+
+        res_ = res;
+        http::async_write(stream_, *res_,
+                          beast::bind_front_handler(&MetricsSession::on_write, shared_from_this()));
+    }
+
+    void on_read(beast::error_code ec, std::size_t) {
+        if (ec) return;  // closed / timeout
+
+        const std::string_view target(req_.target().data(), req_.target().size());
+        if (req_.method() == http::verb::get && target.substr(0, target.find('?')) == "/asof") {
+            const size_t q = target.find('?');
+            handle_asof(q == std::string_view::npos ? std::string_view{} : target.substr(q + 1));
+            return;
+        }
+
+        if (req_.method() != http::verb::get) {
+            reply(http::status::method_not_allowed, "text/plain", "GET only\n");
+        } else if (target == "/metrics" || target == "/") {
+            reply(http::status::ok, "text/plain; version=0.0.4; charset=utf-8",
+                  mbo::render_prometheus(mbo::metrics()));
+        } else {
+            reply(http::status::not_found, "text/plain", "not found\n");
+        }
+    }
+
+    void on_write(beast::error_code ec, std::size_t) {
+        if (ec) return;
+        if (!res_->keep_alive()) {
+            stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+            return;
+        }
+        res_.reset();
+        do_read();
+    }
+};
+
+class MetricsListener : public std::enable_shared_from_this<MetricsListener> {
+public:
+    MetricsListener(boost::asio::io_context& ioc, tcp::endpoint ep)
+        : ioc_(ioc), acceptor_(ioc), rate_timer_(ioc) {
+        beast::error_code ec;
+
+        acceptor_.open(ep.protocol(), ec);
+        if (ec) throw std::runtime_error("acceptor.open: " + ec.message());
+
+        acceptor_.set_option(boost::asio::socket_base::reuse_address(true), ec);
+        if (ec) throw std::runtime_error("acceptor.set_option: " + ec.message());
+
+        acceptor_.bind(ep, ec);
+        if (ec) throw std::runtime_error("acceptor.bind: " + ec.message());
+
+        acceptor_.listen(boost::asio::socket_base::max_listen_connections, ec);
+        if (ec) throw std::runtime_error("acceptor.listen: " + ec.message());
+    }
+
+    void run() {
+        do_accept();
+        schedule_rate();
+    }
+
+private:
+    boost::asio::io_context& ioc_;
+    tcp::acceptor acceptor_;
+    boost::asio::steady_timer rate_timer_;
+    uint64_t last_events_ = 0;
+    std::chrono::steady_clock::time_point last_t_ = std::chrono::steady_clock::now();
+
+    void do_accept() {
+        acceptor_.async_accept(
+            boost::asio::make_strand(ioc_),
+            beast::bind_front_handler(&MetricsListener::on_accept, shared_from_this())
+        );
+    }
+
+    void on_accept(beast::error_code ec, tcp::socket socket) {
+        if (!ec) std::make_shared<MetricsSession>(std::move(socket))->run();
+        do_accept();
+    }
+
+    // events/s gauge: derived here so the ingest thread only bumps a counter
+    void schedule_rate() {
+        rate_timer_.expires_after(std::chrono::seconds(1));
+        rate_timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+            if (ec) return;
+            auto& m = mbo::metrics();
+            const auto now = std::chrono::steady_clock::now();
+            const uint64_t ev = m.events_total.load(std::memory_order_relaxed);
+            const double dt = std::chrono::duration<double>(now - self->last_t_).count();
+            const uint64_t d = ev - self->last_events_;
+            mbo::set_gauge(m.events_per_s, dt > 0 ? (uint64_t)((double)d / dt) : 0);
+            self->last_events_ = ev;
+            self->last_t_ = now;
+            self->schedule_rate();
+        });
+    }
+};
+
+void start_metrics_server(boost::asio::io_context& ioc, int port) {
+    auto listener = std::make_shared<MetricsListener>(
+        ioc, tcp::endpoint(tcp::v4(), static_cast<unsigned short>(port))
+    );
+    listener->run();
+}
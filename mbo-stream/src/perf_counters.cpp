@@ -0,0 +1,165 @@
+#include "mbo/perf_counters.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mbo {
+
+const char* perf_event_name(PerfEvent ev) {
+    switch (ev) {
+        case PerfEvent::Cycles:       return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::L1dMisses:    return "l1d_misses";
+        case PerfEvent::LlcMisses:    return "llc_misses";
+        case PerfEvent::BranchMisses: return "branch_misses";
+        case PerfEvent::DtlbMisses:   return "dtlb_misses";
+    }
+    return "unknown";
+}
+
+#if defined(__linux__)
+
+static void fill_attr(PerfEvent ev, perf_event_attr& a) {
+    std::memset(&a, 0, sizeof(a));
+    a.size = sizeof(a);
+    a.disabled = 1;
+    a.exclude_kernel = 1;
+    a.exclude_hv = 1;
+    a.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    auto cache = [](uint64_t id, uint64_t op, uint64_t result) {
+        return id | (op << 8) | (result << 16);
+    };
+
+    switch (ev) {
+        case PerfEvent::Cycles:
+            a.type = PERF_TYPE_HARDWARE;
+            a.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::Instructions:
+            a.type = PERF_TYPE_HARDWARE;
+            a.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::L1dMisses:
+            a.type = PERF_TYPE_HW_CACHE;
+            a.config = cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                             PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PerfEvent::LlcMisses:
+            a.type = PERF_TYPE_HARDWARE;
+            a.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PerfEvent::BranchMisses:
+            a.type = PERF_TYPE_HARDWARE;
+            a.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PerfEvent::DtlbMisses:
+            a.type = PERF_TYPE_HW_CACHE;
+            a.config = cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                             PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+    }
+}
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < kPerfEventCount; ++i) {
+        fds_[i] = -1;
+
+        perf_event_attr attr;
+        fill_attr((PerfEvent)i, attr);
+        long fd = syscall(__NR_perf_event_open, &attr, 0 /*this thread*/, -1 /*any cpu*/,
+                          -1 /*no group*/, 0);
+        if (fd < 0) {
+            if (error_.empty()) {
+                error_ = std::string(perf_event_name((PerfEvent)i)) + ": " + std::strerror(errno);
+            }
+            continue;
+        }
+        fds_[i] = (int)fd;
+        opened_++;
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+void PerfCounters::start() {
+    for (int fd : fds_) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void PerfCounters::stop() {
+    for (int fd : fds_) {
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+}
+
+PerfSample PerfCounters::read() const {
+    PerfSample s;
+    for (int i = 0; i < kPerfEventCount; ++i) {
+        if (fds_[i] < 0) continue;
+
+        uint64_t buf[3] = {0, 0, 0}; // value, time_enabled, time_running
+        if (::read(fds_[i], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) continue;
+
+        // counter was multiplexed with others: extrapolate to the full window
+        if (buf[2] > 0 && buf[2] < buf[1]) {
+            s.v[i] = (uint64_t)((double)buf[0] * (double)buf[1] / (double)buf[2]);
+        } else {
+            s.v[i] = buf[0];
+        }
+    }
+    return s;
+}
+
+#else // !__linux__
+
+PerfCounters::PerfCounters() : error_("perf_event_open not supported on this platform") {
+    for (int i = 0; i < kPerfEventCount; ++i) fds_[i] = -1;
+}
+PerfCounters::~PerfCounters() = default;
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+PerfSample PerfCounters::read() const { return PerfSample{}; }
+
+#endif
+
+std::string PerfTotals::to_json(const PerfCounters& pc) const {
+    std::ostringstream oss;
+    oss.precision(6);
+    oss << "{";
+    bool first = true;
+    for (int i = 0; i < kPerfEventCount; ++i) {
+        if (!pc.has((PerfEvent)i)) continue;
+        if (!first) oss << ",";
+        first = false;
+        oss << "\"" << perf_event_name((PerfEvent)i) << "\":{"
+            << "\"total\":" << v[i]
+            << ",\"per_item\":" << per_item((PerfEvent)i)
+            << "}";
+    }
+    if (pc.has(PerfEvent::Cycles) && pc.has(PerfEvent::Instructions) &&
+        v[(int)PerfEvent::Cycles] > 0) {
+        if (!first) oss << ",";
+        oss << "\"ipc\":"
+            << (double)v[(int)PerfEvent::Instructions] / (double)v[(int)PerfEvent::Cycles];
+    }
+    oss << "}";
+    return oss.str();
+}
+
+} // namespace mbo
@@ -1,6 +1,6 @@
 #include "mbo/pg_writer.hpp"
+#include "mbo/logger.hpp"
 #include <postgresql/libpq-fe.h>
-#include <iostream>
 #include <sstream>
 
 struct PgWriter::Impl {
@@ -12,8 +12,7 @@ PgWriter::PgWriter(const std::string& conninfo) : impl_(new Impl) {
     impl_->conn = PQconnectdb(conninfo.c_str());
 
     if (PQstatus(impl_->conn) != CONNECTION_OK) {
-        std::cerr << "[pg] connection failed: "
-                  << PQerrorMessage(impl_->conn) << "\n";
+        MBO_LOG_ERROR("[pg] connection failed: {}", PQerrorMessage(impl_->conn));
         PQfinish(impl_->conn);
         impl_->conn = nullptr;
         return;
@@ -35,8 +34,7 @@ PgWriter::PgWriter(const std::string& conninfo) : impl_(new Impl) {
     );
 
     if (PQresultStatus(impl_->prep) != PGRES_COMMAND_OK) {
-        std::cerr << "[pg] prepare failed: "
-                  << PQerrorMessage(impl_->conn) << "\n";
+        MBO_LOG_ERROR("[pg] prepare failed: {}", PQerrorMessage(impl_->conn));
     }
 }
 
@@ -86,8 +84,8 @@ bool PgWriter::write_snapshot(
 
     bool ok = (PQresultStatus(res) == PGRES_COMMAND_OK);
     if (!ok) {
-        std::cerr << "[pg] insert failed: "
-                  << PQerrorMessage(impl_->conn) << "\n";
+        // one failure per row when the DB is down: keep it to a few lines a second
+        MBO_LOG_RATELIMITED(mbo::LogLevel::Warn, 5, "[pg] insert failed: {}", PQerrorMessage(impl_->conn));
     }
 
     PQclear(res);
@@ -0,0 +1,74 @@
+#include "mbo/rx_timestamp.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <sys/socket.h>
+
+namespace mbo {
+
+const char* rx_timestamp_mode_name(RxTimestampMode m) {
+    switch (m) {
+        case RxTimestampMode::Timestamping: return "SO_TIMESTAMPING";
+        case RxTimestampMode::TimestampNs:  return "SO_TIMESTAMPNS";
+        case RxTimestampMode::None:         break;
+    }
+    return "none";
+}
+
+RxTimestampMode enable_rx_timestamps(int fd) {
+    const int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof flags) == 0) {
+        return RxTimestampMode::Timestamping;
+    }
+    const int on = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof on) == 0) {
+        return RxTimestampMode::TimestampNs;
+    }
+    return RxTimestampMode::None;
+}
+
+static inline int64_t ts_to_ns(const struct timespec& ts) {
+    return (int64_t)ts.tv_sec * 1'000'000'000LL + (int64_t)ts.tv_nsec;
+}
+
+ssize_t recv_with_rx_timestamp(int fd, char* buf, size_t len, int64_t& rx_ns) {
+    rx_ns = 0;
+
+    struct iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = len;
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(struct scm_timestamping)) +
+                                         CMSG_SPACE(sizeof(struct timespec))];
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    ssize_t n;
+    do {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof control;
+        n = ::recvmsg(fd, &msg, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return n;
+
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level != SOL_SOCKET) continue;
+        if (c->cmsg_type == SCM_TIMESTAMPING) {
+            struct scm_timestamping st;
+            std::memcpy(&st, CMSG_DATA(c), sizeof st);
+            if (st.ts[0].tv_sec || st.ts[0].tv_nsec) rx_ns = ts_to_ns(st.ts[0]);  // [0] = software
+        } else if (c->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            std::memcpy(&ts, CMSG_DATA(c), sizeof ts);
+            rx_ns = ts_to_ns(ts);
+        }
+    }
+    return n;
+}
+
+} // namespace mbo
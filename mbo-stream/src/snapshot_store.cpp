@@ -1,52 +1,173 @@
 #include "mbo/snapshot_store.hpp"
 
+#include <atomic>
 #include <shared_mutex>
 #include <mutex>
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <vector>
+
+namespace {
+
+// ----------------------- shared_mutex store (default) -----------------------
 
 // Thread-safe store: symbol -> latest snapshot string
-static std::shared_mutex g_mtx;
-static std::unordered_map<std::string, std::shared_ptr<const std::string>> g_latest_by_symbol;
+class SharedMutexSnapshotStore final : public SnapshotStore {
+public:
+    const char* name() const override { return "shared_mutex"; }
+
+    // Backward compatible: publish global snapshot
+    void publish(std::string s) override {
+        auto p = std::make_shared<const std::string>(std::move(s));
+        std::unique_lock lock(mtx_);
+        latest_global_ = std::move(p);
+    }
+
+    // New: publish per-symbol snapshot
+    void publish(const std::string& symbol, std::string s) override {
+        auto p = std::make_shared<const std::string>(std::move(s));
+        std::unique_lock lock(mtx_);
+        latest_by_symbol_[symbol] = std::move(p);
+    }
+
+    std::shared_ptr<const std::string> load() const override {
+        std::shared_lock lock(mtx_);
+        return latest_global_;
+    }
+
+    std::shared_ptr<const std::string> load(const std::string& symbol) const override {
+        std::shared_lock lock(mtx_);
+
+        auto it = latest_by_symbol_.find(symbol);
+        if (it != latest_by_symbol_.end()) {
+            return it->second;
+        }
+
+        // fallback: global (so old behavior still works)
+        return latest_global_;
+    }
+
+private:
+    mutable std::shared_mutex mtx_;
+    std::unordered_map<std::string, std::shared_ptr<const std::string>> latest_by_symbol_;
+
+    // Fallback "global" snapshot (backward compatible)
+    std::shared_ptr<const std::string> latest_global_ =
+        std::make_shared<const std::string>(std::string{"{}"});
+};
+
+// ----------------------- atomic-slot store -----------------------
+
+// Symbols are added rarely and never removed, so the symbol -> slot index is
+// copy-on-write: readers follow an atomic pointer to an immutable map and then
+// swap / load the slot's shared_ptr atomically. Retired index versions are
+// kept until the store dies (one per new symbol), which keeps readers free of
+// reclamation concerns.
+class AtomicSnapshotStore final : public SnapshotStore {
+public:
+    AtomicSnapshotStore() {
+        index_versions_.push_back(std::make_unique<Index>());
+        index_.store(index_versions_.back().get(), std::memory_order_release);
+        std::atomic_store(&global_.p, std::make_shared<const std::string>(std::string{"{}"}));
+    }
+
+    const char* name() const override { return "atomic"; }
+
+    void publish(std::string s) override {
+        std::atomic_store_explicit(&global_.p, std::make_shared<const std::string>(std::move(s)),
+                                   std::memory_order_release);
+    }
+
+    void publish(const std::string& symbol, std::string s) override {
+        auto p = std::make_shared<const std::string>(std::move(s));
+        Slot* slot = find(symbol);
+        if (!slot) slot = insert(symbol);
+        std::atomic_store_explicit(&slot->p, std::move(p), std::memory_order_release);
+    }
+
+    std::shared_ptr<const std::string> load() const override {
+        return std::atomic_load_explicit(&global_.p, std::memory_order_acquire);
+    }
+
+    std::shared_ptr<const std::string> load(const std::string& symbol) const override {
+        const Slot* slot = find(symbol);
+        if (!slot) return load();
+        auto p = std::atomic_load_explicit(&slot->p, std::memory_order_acquire);
+        return p ? p : load();
+    }
+
+private:
+    // one slot per cache line so publishers of different symbols don't false-share
+    struct alignas(64) Slot {
+        std::shared_ptr<const std::string> p;
+    };
+    using Index = std::unordered_map<std::string, Slot*>;
+
+    Slot* find(const std::string& symbol) const {
+        const Index* idx = index_.load(std::memory_order_acquire);
+        auto it = idx->find(symbol);
+        return it == idx->end() ? nullptr : it->second;
+    }
 
-// Fallback "global" snapshot (backward compatible)
-static std::shared_ptr<const std::string> g_latest_global =
-    std::make_shared<const std::string>(std::string{"{}"});
+    Slot* insert(const std::string& symbol) {
+        std::lock_guard<std::mutex> lk(insert_mtx_);
+        const Index* cur = index_.load(std::memory_order_acquire);
+        auto it = cur->find(symbol);
+        if (it != cur->end()) return it->second;
+
+        slots_.push_back(std::make_unique<Slot>());
+        Slot* slot = slots_.back().get();
+        auto next = std::make_unique<Index>(*cur);
+        (*next)[symbol] = slot;
+        index_.store(next.get(), std::memory_order_release);
+        index_versions_.push_back(std::move(next));
+        return slot;
+    }
+
+    std::atomic<const Index*> index_{nullptr};
+    Slot global_;
+
+    std::mutex insert_mtx_;  // serialises symbol inserts only
+    std::vector<std::unique_ptr<Index>> index_versions_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+};
+
+std::unique_ptr<SnapshotStore>& global_store() {
+    static std::unique_ptr<SnapshotStore> s = std::make_unique<SharedMutexSnapshotStore>();
+    return s;
+}
+
+} // namespace
+
+std::unique_ptr<SnapshotStore> make_snapshot_store(const std::string& kind) {
+    if (kind.empty() || kind == "shared_mutex") return std::make_unique<SharedMutexSnapshotStore>();
+    if (kind == "atomic") return std::make_unique<AtomicSnapshotStore>();
+    return nullptr;
+}
+
+SnapshotStore& snapshot_store() { return *global_store(); }
+
+void set_snapshot_store(std::unique_ptr<SnapshotStore> store) {
+    if (store) global_store() = std::move(store);
+}
 
 // ----------------------- Publish APIs -----------------------
 
 // Backward compatible: publish global snapshot
-void publish_snapshot(std::string s) {
-    auto p = std::make_shared<const std::string>(std::move(s));
-    std::unique_lock lock(g_mtx);
-    g_latest_global = std::move(p);
-}
+void publish_snapshot(std::string s) { snapshot_store().publish(std::move(s)); }
 
 // New: publish per-symbol snapshot
 void publish_snapshot(const std::string& symbol, std::string s) {
-    auto p = std::make_shared<const std::string>(std::move(s));
-    std::unique_lock lock(g_mtx);
-    g_latest_by_symbol[symbol] = std::move(p);
+    snapshot_store().publish(symbol, std::move(s));
 }
 
 // ----------------------- Load APIs -----------------------
 
 // Backward compatible: load global snapshot
-std::shared_ptr<const std::string> load_snapshot() {
-    std::shared_lock lock(g_mtx);
-    return g_latest_global;
-}
+std::shared_ptr<const std::string> load_snapshot() { return snapshot_store().load(); }
 
 // New: load per-symbol snapshot; if missing, fall back to global or "{}"
 std::shared_ptr<const std::string> load_snapshot(const std::string& symbol) {
-    std::shared_lock lock(g_mtx);
-
-    auto it = g_latest_by_symbol.find(symbol);
-    if (it != g_latest_by_symbol.end()) {
-        return it->second;
-    }
-
-    // fallback: global (so old behavior still works)
-    return g_latest_global;
+    return snapshot_store().load(symbol);
 }
@@ -0,0 +1,118 @@
+#include "mbo/stage_timer.hpp"
+#include "mbo/metrics.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace mbo {
+
+const char* stage_name(Stage s) {
+    switch (s) {
+        case Stage::Read: return "read";
+        case Stage::Frame: return "frame";
+        case Stage::Parse: return "parse";
+        case Stage::Apply: return "apply";
+        case Stage::SnapshotBuild: return "snapshot_build";
+        case Stage::Publish: return "publish";
+        case Stage::Feed: return "feed";
+        case Stage::Enqueue: return "enqueue";
+    }
+    return "?";
+}
+
+namespace {
+
+// constant_tsc + nonstop_tsc: rate is fixed and keeps ticking in deep C-states,
+// so ticks from any core convert with one factor.
+bool tsc_invariant() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("flags", 0) != 0) continue;
+        return line.find(" constant_tsc") != std::string::npos &&
+               line.find(" nonstop_tsc") != std::string::npos;
+    }
+    return false;
+}
+
+TscClock calibrate() {
+    TscClock c;
+#if MBO_HAVE_TSC
+    if (!tsc_invariant()) return c;
+
+    // Two ~10 ms windows; keep the second (first one warms up the path).
+    double ns_per_tick = 0.0;
+    for (int i = 0; i < 2; ++i) {
+        const uint64_t n0 = steady_now_ns();
+        const uint64_t t0 = __rdtsc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const uint64_t n1 = steady_now_ns();
+        const uint64_t t1 = __rdtsc();
+        if (t1 <= t0 || n1 <= n0) return c;
+        ns_per_tick = (double)(n1 - n0) / (double)(t1 - t0);
+    }
+    c.use_tsc = true;
+    c.ns_per_tick = ns_per_tick;
+    c.ghz = 1.0 / ns_per_tick;
+#endif
+    return c;
+}
+
+} // namespace
+
+const TscClock& TscClock::get() {
+    static const TscClock clock = calibrate();
+    return clock;
+}
+
+StageTimers::StageTimers(int sample_every, int hist_digits)
+    : every_(sample_every < 0 ? 0 : sample_every),
+      use_tsc_(false),
+      clock_(nullptr) {
+    for (auto& h : interval_) h = HdrHistogram(hist_digits);
+    for (auto& h : total_) h = HdrHistogram(hist_digits);
+    for (auto& c : countdown_) c = 1;
+    if (enabled()) {
+        clock_ = &TscClock::get();
+        use_tsc_ = clock_->use_tsc;
+    }
+}
+
+void StageTimers::record_ticks(Stage s, uint64_t ticks) {
+    const uint64_t ns = clock_->to_ns(ticks);
+    interval_[(int)s].record(ns);
+    if (sinks_) sinks_[(int)s].record(ns);
+}
+
+void StageTimers::roll_interval() {
+    for (int i = 0; i < kStageCount; ++i) {
+        total_[i].merge(interval_[i]);
+        interval_[i].reset();
+    }
+}
+
+void StageTimers::reset() {
+    for (auto& h : interval_) h.reset();
+    for (auto& h : total_) h.reset();
+}
+
+std::string StageTimers::to_json() const { return json_of(total_); }
+
+std::string StageTimers::interval_json() const { return json_of(interval_); }
+
+std::string StageTimers::json_of(const HdrHistogram* hs) const {
+    std::ostringstream oss;
+    oss.precision(6);
+    oss << "{\"sample_every\":" << every_
+        << ",\"clock\":\"" << (use_tsc_ ? "tsc" : "steady") << "\"";
+    if (use_tsc_) oss << ",\"tsc_ghz\":" << clock_->ghz;
+    for (int i = 0; i < kStageCount; ++i) {
+        if (hs[i].count() == 0) continue;
+        oss << ",\"" << stage_name((Stage)i) << "\":" << hs[i].to_json(1e3);
+    }
+    oss << "}";
+    return oss.str();
+}
+
+} // namespace mbo
@@ -1,16 +1,37 @@
 #include "mbo/mbo_order_book.hpp"
-#include "mbo/pow2_histogram.hpp"
+#include "mbo/hdr_histogram.hpp"
 #include "mbo/csv_parser.hpp"
 #include "mbo/snapshot_store.hpp"
 #include "mbo/ws_server.hpp"
 #include "mbo/pg_writer.hpp"
 #include "mbo/app_config.hpp"
 #include "mbo/jsonl_writer.hpp"
+#include "mbo/async_jsonl_writer.hpp"
+#include "mbo/process_stats.hpp"
 #include "mbo/file_output.hpp"
+#include "mbo/perf_counters.hpp"
+#include "mbo/alloc_counter.hpp"
+#include "mbo/stage_timer.hpp"
+#include "mbo/metrics.hpp"
+#include "mbo/metrics_server.hpp"
+#include "mbo/lag_monitor.hpp"
+#include "mbo/logger.hpp"
+#include "mbo/rx_timestamp.hpp"
+#include "mbo/feed_latency.hpp"
+#include "mbo/timestamp.hpp"
+#include "mbo/thread_tuning.hpp"
+#include "mbo/book_arena.hpp"
+#include "mbo/book_checkpoint.hpp"
+#include "mbo/event_journal.hpp"
+#include "mbo/as_of.hpp"
 
 #include <boost/asio.hpp>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
 #include <deque>
@@ -33,39 +54,238 @@ struct SnapshotWrite {
     TopOfBook tob;
 };
 
+// ----------------------- Hardware counters (optional) -----------------------
+// Counters are per-thread, so this lives on the ingest thread's session.
+struct SessionPerf {
+    mbo::PerfCounters pc;
+    int sample_every = 64;
+    mbo::PerfTotals apply;  // sampled 1-in-N apply calls
+    mbo::PerfTotals snap;   // every snapshot
+};
+
+// ----------------------- End-to-end latency (optional) -----------------------
+// Populated only when the streamer stamps ts_send_ns (STAMP_SEND=1). All
+// values are wall-clock, so streamer and engine must share a clock (same host).
+struct SessionE2E {
+    explicit SessionE2E(int digits) : send_apply(digits), send_publish(digits) {}
+
+    mbo::HdrHistogram send_apply;    // ts_send -> book.apply done
+    mbo::HdrHistogram send_publish;  // ts_send of last applied event -> snapshot published
+    int64_t last_send_ns = 0;
+    int64_t last_apply_ns = 0;
+    uint64_t stamped = 0;
+};
+
+// ----------------------- Allocation counting (make ALLOC_COUNT=1) -----------------------
+// Heap allocations per stage on the ingest thread; compiled away otherwise.
+struct SessionAlloc {
+    mbo::AllocTotals frame;  // per line: carving the line out of the read buffer
+    mbo::AllocTotals parse;  // per line: MboEvent + CSV parse
+    mbo::AllocTotals apply;  // per event: book.apply
+    mbo::AllocTotals snap;   // per snapshot: to_json + publish + DB enqueue + feed
+
+    std::string to_json() const {
+        return "{\"frame\":" + frame.to_json() + ",\"parse\":" + parse.to_json() +
+               ",\"apply\":" + apply.to_json() + ",\"snapshot\":" + snap.to_json() + "}";
+    }
+};
+
+// ----------------------- Kernel receive timestamps (RX_TIMESTAMPS) -----------------------
+// Every read batch carries the kernel arrival time of its newest bytes; lines
+// framed from that batch are measured against it, 1-in-STAGE_SAMPLE_EVERY.
+// Both ends are CLOCK_REALTIME. rx_to_parse is the time a line spent queued in
+// the socket buffer and in `carry` before we looked at it.
+struct SessionRx {
+    SessionRx(int sample_every, int digits)
+        : every(sample_every), rx_parse(digits), parse_apply(digits), rx_apply(digits) {}
+
+    mbo::RxTimestampMode mode = mbo::RxTimestampMode::None;
+    int every;
+    int countdown = 1;
+    int64_t batch_rx_ns = 0;       // current read batch, 0 = not stamped
+    uint64_t stamped_batches = 0;
+
+    mbo::HdrHistogram rx_parse;
+    mbo::HdrHistogram parse_apply;
+    mbo::HdrHistogram rx_apply;
+
+    bool sample() {
+        if (every <= 0 || batch_rx_ns == 0) return false;
+        if (--countdown > 0) return false;
+        countdown = every;
+        return true;
+    }
+
+    void record(int64_t parse_ns, int64_t apply_ns) {
+        auto& m = mbo::metrics();
+        auto leg = [&](mbo::HdrHistogram& h, mbo::RxLeg l, int64_t d) {
+            if (d < 0) return;  // clock stepped
+            h.record((uint64_t)d);
+            m.rx[(int)l].record((uint64_t)d);
+        };
+        leg(rx_parse, mbo::RxLeg::RxToParse, parse_ns - batch_rx_ns);
+        leg(parse_apply, mbo::RxLeg::ParseToApply, apply_ns - parse_ns);
+        leg(rx_apply, mbo::RxLeg::RxToApply, apply_ns - batch_rx_ns);
+    }
+
+    std::string to_json() const {
+        return std::string("{\"mode\":\"") + mbo::rx_timestamp_mode_name(mode) +
+               "\",\"stamped_batches\":" + std::to_string(stamped_batches) +
+               ",\"rx_to_parse\":" + rx_parse.to_json(1e3) +
+               ",\"parse_to_apply\":" + parse_apply.to_json(1e3) +
+               ",\"rx_to_apply\":" + rx_apply.to_json(1e3) + "}";
+    }
+};
+
+// ----------------------- Catch-up mode (CATCHUP_*) -----------------------
+// While the LagMonitor reports catch-up, snapshot boundaries only apply: no
+// PG rows, no feed lines, no BBO dump. The WS still gets the latest book at
+// most every CATCHUP_PUBLISH_MS, and the first boundary after catching up
+// takes a full snapshot again.
+struct SessionCatchup {
+    explicit SessionCatchup(const AppConfig& cfg)
+        : lag((uint64_t)cfg.catchup_backlog_bytes, cfg.catchup_lag_ms * 1000),
+          publish_every(std::chrono::milliseconds(cfg.catchup_publish_ms)) {}
+
+    mbo::LagMonitor lag;
+    SteadyClock::duration publish_every;
+    SteadyClock::time_point next_publish{};
+    bool pending = false;      // a boundary was conflated since the last full snapshot
+    uint64_t conflated = 0;
+};
+
+static inline int64_t now_wall_ns() {
+    using namespace std::chrono;
+    return (int64_t)duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// WS frame = book JSON prefixed with publish metadata:
+//   {"seq":<processed>,"ts_pub_ns":..[,"ts_send_ns":..,"ts_apply_ns":..],"symbol":..,"bids":..}
+// seq / ts_pub_ns let subscribers measure staleness; the send/apply stamps are
+// those of the last event applied before this snapshot.
+static std::string make_ws_frame(const std::string& book_json, int64_t seq,
+                                 int64_t ts_pub_ns, const SessionE2E& e2e) {
+    std::string frame;
+    frame.reserve(book_json.size() + 96);
+    frame += "{\"seq\":";
+    frame += std::to_string(seq);
+    frame += ",\"ts_pub_ns\":";
+    frame += std::to_string(ts_pub_ns);
+    if (e2e.last_send_ns > 0) {
+        frame += ",\"ts_send_ns\":";
+        frame += std::to_string(e2e.last_send_ns);
+        frame += ",\"ts_apply_ns\":";
+        frame += std::to_string(e2e.last_apply_ns);
+    }
+    if (book_json.size() > 2) frame += ',';
+    frame.append(book_json, 1, std::string::npos);
+    return frame;
+}
+
+// Build the frame, publish it, and record send -> publish when stamped.
+static void publish_frame(const std::string& sym, const std::string& book_json,
+                          int64_t seq, SessionE2E& e2e) {
+    const int64_t pub_ns = now_wall_ns();
+    std::string frame = make_ws_frame(book_json, seq, pub_ns, e2e);
+    if (!sym.empty()) publish_snapshot(sym, std::move(frame));
+    else publish_snapshot(std::move(frame));
+    if (e2e.last_send_ns > 0 && pub_ns > e2e.last_send_ns) {
+        e2e.send_publish.add((uint64_t)(pub_ns - e2e.last_send_ns));
+    }
+}
+
 static inline int64_t now_wall_us() {
     using namespace std::chrono;
     return (int64_t)duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
 }
 
-static inline int64_t ts_event_to_us(const std::string& ts) {
-    int Y=0,M=0,D=0,h=0,m=0,s=0;
-    long ns = 0;
-
-    if (sscanf(ts.c_str(), "%d-%d-%dT%d:%d:%d", &Y,&M,&D,&h,&m,&s) != 6) return 0;
+// ----------------------- Interval bench lines (BENCH_INTERVAL_S) -----------------------
+// Baselines at the start of the current interval; session totals live in the
+// session's own counters.
+struct IntervalState {
+    SteadyClock::time_point start;
+    SteadyClock::time_point next;
+    SteadyClock::duration len{};
+    int64_t index = 0;
+    int64_t processed0 = 0;
+    int64_t parse_err0 = 0;
+    uint64_t bytes0 = 0;
+    int64_t ts0_us = 0;
+    uint64_t pg_dropped0 = 0;
+    uint64_t carry_hwm = 0;
+    uint64_t catchup_ns0 = 0;
+};
 
-    auto dot = ts.find('.');
-    if (dot != std::string::npos) {
-        size_t z = ts.find('Z', dot);
-        std::string frac = ts.substr(dot+1, (z==std::string::npos? ts.size(): z) - (dot+1));
-        while (frac.size() < 9) frac.push_back('0');
-        if (frac.size() > 9) frac.resize(9);
-        ns = std::strtol(frac.c_str(), nullptr, 10);
+static void emit_interval(
+    const AppConfig& cfg,
+    mbo::AsyncJsonlWriter& out,
+    mbo::StageTimers& stages,
+    const mbo::LagMonitor& lag,
+    IntervalState& iv,
+    SteadyClock::time_point now,
+    SteadyClock::time_point session_t0,
+    int64_t processed,
+    int64_t parse_errors,
+    uint64_t bytes_total,
+    int64_t last_ts_us
+) {
+    auto& m = mbo::metrics();
+    const double secs = std::chrono::duration<double>(now - iv.start).count();
+
+    mbo::IntervalLine il;
+    il.ts_wall_us = now_wall_us();
+    il.host = cfg.host;
+    il.port = cfg.port;
+    il.session = (int64_t)m.sessions_total.load(std::memory_order_relaxed);
+    il.interval = ++iv.index;
+    il.interval_s = secs;
+    il.elapsed_s = std::chrono::duration<double>(now - session_t0).count();
+
+    il.events = processed - iv.processed0;
+    il.events_total = processed;
+    il.parse_errors = parse_errors - iv.parse_err0;
+    il.bytes = bytes_total - iv.bytes0;
+    il.throughput_msgs_per_s = secs > 0 ? (double)il.events / secs : 0.0;
+
+    if (last_ts_us > 0) {
+        il.event_lag_ms = (double)(il.ts_wall_us - last_ts_us) / 1e3;
+        if (iv.ts0_us > 0) il.event_time_advance_s = (double)(last_ts_us - iv.ts0_us) / 1e6;
     }
 
-    std::tm t{};
-    t.tm_year = Y - 1900;
-    t.tm_mon  = M - 1;
-    t.tm_mday = D;
-    t.tm_hour = h;
-    t.tm_min  = m;
-    t.tm_sec  = s;
-
-    time_t sec = timegm(&t);
-    if (sec < 0) return 0;
+    il.read_backlog_hwm_bytes = iv.carry_hwm;
+    il.pg_queue_hwm = m.pg_queue_interval_hwm.load(std::memory_order_relaxed);
+    const uint64_t dropped = m.pg_rows_dropped.load(std::memory_order_relaxed);
+    il.pg_dropped = dropped - iv.pg_dropped0;
+
+    il.feed_backlog_bytes = lag.backlog_bytes();
+    il.event_drift_ms = (double)lag.drift_us() / 1e3;
+    il.catchup = lag.catchup();
+    il.catchup_s = (double)(lag.catchup_ns() - iv.catchup_ns0) / 1e9;
+
+    il.rss_bytes = mbo::process_rss_bytes();
+    il.rss_peak_bytes = std::max(mbo::process_peak_rss_bytes(), il.rss_bytes);
+
+    if (stages.enabled()) il.stages_json = stages.interval_json();
+    out.write_interval(il);
+
+    // next interval: fold histograms into session totals, re-baseline counters
+    stages.roll_interval();
+    mbo::set_gauge(m.pg_queue_interval_hwm, m.pg_queue_depth.load(std::memory_order_relaxed));
+    iv.start = now;
+    while (iv.next <= now) iv.next += iv.len;
+    iv.processed0 = processed;
+    iv.parse_err0 = parse_errors;
+    iv.bytes0 = bytes_total;
+    iv.ts0_us = last_ts_us;
+    iv.pg_dropped0 = dropped;
+    iv.carry_hwm = 0;
+    iv.catchup_ns0 = lag.catchup_ns();
+}
 
-    int64_t us = (int64_t)sec * 1000000LL + (int64_t)(ns / 1000);
-    return us;
+// ISO-8601 feed timestamp -> epoch ns (0 if malformed)
+static inline int64_t feed_ts_to_ns(const std::string& ts) {
+    int64_t ns = 0;
+    return (!ts.empty() && mbo::parse_iso8601_ns(ts, ns)) ? ns : 0;
 }
 
 static void enqueue_snapshot_write(
@@ -85,21 +305,103 @@ static void enqueue_snapshot_write(
     item.symbol = symbol;
     item.tob = tob;
 
+    auto& m = mbo::metrics();
     {
         std::lock_guard<std::mutex> lk(q_mtx);
-        while (q.size() >= max_q) q.pop_front();
+        while (q.size() >= max_q) {
+            q.pop_front();
+            mbo::bump(m.pg_rows_dropped);
+        }
         q.push_back(std::move(item));
+        mbo::set_gauge(m.pg_queue_depth, q.size());
+        if (q.size() > m.pg_queue_high_water.load(std::memory_order_relaxed)) {
+            mbo::set_gauge(m.pg_queue_high_water, q.size());
+        }
+        if (q.size() > m.pg_queue_interval_hwm.load(std::memory_order_relaxed)) {
+            mbo::set_gauge(m.pg_queue_interval_hwm, q.size());
+        }
     }
+    mbo::bump(m.pg_rows_enqueued);
     q_cv.notify_one();
 }
 
+// ----------------------- Resumable feed (FEED_RESUME) -----------------------
+// The book and the feed position outlive a session. When a connection drops
+// before the streamer's "#END" marker, the next session sends
+// "RESUME <seq> <count> <run>" and continues on the same book; otherwise it
+// sends "HELLO" and starts a fresh replay on a fresh book. <run> is the
+// streamer run id from its "#SESSION <run> FRESH|RESUMED" greeting: a
+// restarted streamer answers FRESH and the kept book is dropped. After a
+// checkpoint warm start the run is unknown and RESUME goes without it.
+//
+// The venue sequence is non-decreasing but not unique, so the position is the
+// last sequence applied plus how many records with that sequence were applied.
+struct FeedPosition {
+    uint64_t last_seq = 0;
+    uint64_t seq_count = 0;
+    uint64_t applied = 0;     // records applied since the replay started
+    int64_t last_ts_ns = 0;   // ts_event of the last record applied
+
+    void advance(uint64_t seq, int64_t ts_ns) {
+        if (applied > 0 && seq == last_seq) {
+            seq_count++;
+        } else {
+            last_seq = seq;
+            seq_count = 1;
+        }
+        applied++;
+        last_ts_ns = ts_ns;
+    }
+};
+
+struct FeedState {
+    FeedState(mbo::BookArena* a, size_t expected) : arena(a), expected_orders(expected), book("", a, expected) {}
+
+    mbo::BookArena* arena;
+    size_t expected_orders;
+    MboOrderBook book;
+    std::string book_symbol;
+    bool has_symbol = false;
+    FeedPosition pos;
+    bool dropped = false;                   // last session ended without "#END"
+    SteadyClock::time_point dropped_at{};
+    std::string feed_run;                   // streamer run that fed the book ("" = unknown)
+
+    // periodic checkpoint of book + position (CHECKPOINT_PATH); not reset
+    std::unique_ptr<mbo::CheckpointForker> ckpt;
+    SteadyClock::duration ckpt_every{};
+    SteadyClock::time_point ckpt_next{};
+
+    // journal of applied events (JOURNAL_DIR); not reset
+    std::unique_ptr<mbo::EventJournal> journal;
+
+    bool resumable() const { return dropped && pos.applied > 0; }
+
+    void reset() {
+        book = MboOrderBook("", arena, expected_orders);
+        book_symbol.clear();
+        has_symbol = false;
+        pos = FeedPosition{};
+        dropped = false;
+        feed_run.clear();
+        // a fresh replay starts here: a journal replay clears its book too
+        if (journal) {
+            mbo::MboRecord& r = journal->stage();
+            r.action = 'R';
+            r.rtype = mbo::kRtypeJournalReset;
+            journal->commit();
+        }
+    }
+};
+
 static bool handle_line(
     std::string& line,
     MboOrderBook& book,
     std::string& book_symbol,
     bool& has_symbol,
-    Pow2Histogram& apply_hist,        // Benchmark 1
-    Pow2Histogram& snap_hist,         // Benchmark 2
+    FeedPosition& feed_pos,
+    mbo::StageTimers& stages,         // Benchmark 1 (sampled per-stage timers)
+    mbo::HdrHistogram& snap_hist,     // Benchmark 2
     int depth,
     int64_t snapshot_every,
     int64_t& processed,
@@ -111,14 +413,21 @@ static bool handle_line(
     std::condition_variable& q_cv,
     std::deque<SnapshotWrite>& q,
     size_t max_q,
-    mbo::JsonlWriter* feed_writer     // optional
+    mbo::JsonlWriter* feed_writer,    // optional
+    SessionPerf* perf,                // optional
+    SessionE2E& e2e,
+    SessionAlloc& allocs,
+    SessionCatchup& cu,
+    SessionRx& rx,
+    mbo::FeedLatencyTracker* flat,     // optional
+    mbo::EventJournal* journal         // optional
 ) {
     if (!line.empty() && line.back() == '\r') line.pop_back();
     if (line.empty()) return false;
 
     static bool printed_hdr = false;
     if (!printed_hdr) {
-        std::cerr << "[hdr] " << line << "\n";
+        MBO_LOG_DEBUG("[hdr] {}", line);
         printed_hdr = true;
     }
 
@@ -130,51 +439,128 @@ static bool handle_line(
     }
 
     lines_total++;
+    auto& m = mbo::metrics();
+    mbo::bump(m.lines_total);
+
+    mbo::AllocCounts ac0;
+    if constexpr (mbo::kAllocCounting) ac0 = mbo::thread_alloc_counts();
+
+    const bool rx_sample = rx.sample();
+    const int64_t rx_parse_ns = rx_sample ? now_wall_ns() : 0;
 
     MboEvent e;
-    if (!parse_mbo_csv_line(line, e)) return false;
+    bool ok;
+    {
+        mbo::StageScope st(stages, mbo::Stage::Parse);
+        ok = parse_mbo_csv_line(line, e);
+    }
+    if (!ok) {
+        mbo::bump(m.parse_errors_total);
+        return false;
+    }
     parsed_ok++;
 
+    if constexpr (mbo::kAllocCounting) {
+        const auto ac1 = mbo::thread_alloc_counts();
+        allocs.parse.add(ac0, ac1, 1);
+        ac0 = ac1;
+    }
+
+    const int64_t ts_event_ns = feed_ts_to_ns(e.ts_event);
+    // parsed once for the latency tracker and the journal record
+    const int64_t ts_recv_ns = (flat || journal) ? feed_ts_to_ns(e.ts_recv) : 0;
     if (!e.ts_event.empty()) {
-        last_ts_us = ts_event_to_us(e.ts_event);
+        last_ts_us = ts_event_ns / 1000;
     }
 
     if (!has_symbol && !e.symbol.empty()) {
         book_symbol = e.symbol;
-        book = MboOrderBook(e.symbol);
+        book = MboOrderBook(e.symbol, book.arena(), book.expected_orders());
         has_symbol = true;
     }
 
-    // Benchmark 1: apply latency
-    auto s = SteadyClock::now();
-    book.apply(e);
-    auto f = SteadyClock::now();
-    uint64_t apply_ns =
-        (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(f - s).count();
-    apply_hist.add(apply_ns);
+    // Benchmark 1: apply latency (sampled 1-in-STAGE_SAMPLE_EVERY)
+    const bool perf_sample = perf && (processed % perf->sample_every == 0);
+    mbo::PerfSample pc0;
+    if (perf_sample) pc0 = perf->pc.read();
+
+    if constexpr (mbo::kAllocCounting) ac0 = mbo::thread_alloc_counts();
+    {
+        mbo::StageScope st(stages, mbo::Stage::Apply);
+        book.apply(e);
+    }
+    if constexpr (mbo::kAllocCounting) allocs.apply.add(ac0, mbo::thread_alloc_counts(), 1);
+
+    if (perf_sample) perf->apply.add(pc0, perf->pc.read(), 1);
+    if (rx_sample) rx.record(rx_parse_ns, now_wall_ns());
+
+    // exchange -> capture -> engine (apply side sampled)
+    if (flat) {
+        const int64_t apply_ns = flat->want_apply_sample() ? now_wall_ns() : 0;
+        flat->record(e.symbol, ts_recv_ns, ts_event_ns, e.ts_in_delta, apply_ns);
+    }
+
+    // staged locally; handed to the journal writer once per socket read
+    if (journal) mbo::record_from_event(e, ts_recv_ns, ts_event_ns, journal->stage());
+
+    if (e.ts_send_ns > 0) {
+        const int64_t apply_ns_wall = now_wall_ns();
+        if (apply_ns_wall > e.ts_send_ns) e2e.send_apply.add((uint64_t)(apply_ns_wall - e.ts_send_ns));
+        e2e.last_send_ns = e.ts_send_ns;
+        e2e.last_apply_ns = apply_ns_wall;
+        e2e.stamped++;
+    }
 
     processed++;
+    feed_pos.advance(e.sequence, ts_event_ns);
+    mbo::bump(m.events_total);
 
     if (snapshot_every > 0 && (processed % snapshot_every == 0)) {
         const std::string& sym = (!book_symbol.empty() ? book_symbol : std::string(""));
 
+        if (cu.lag.catchup()) {
+            cu.pending = true;
+            cu.conflated++;
+            mbo::bump(m.snapshots_conflated_total);
+            if (cu.publish_every.count() > 0) {
+                const auto now = SteadyClock::now();
+                if (now >= cu.next_publish) {
+                    publish_frame(sym, book.to_json(depth), processed, e2e);
+                    cu.next_publish = now + cu.publish_every;
+                }
+            }
+            return true;
+        }
+        cu.pending = false;
+
         // Benchmark 2: snapshot latency = to_json + publish + db enqueue + feed write
+        mbo::PerfSample sc0;
+        if (perf) sc0 = perf->pc.read();
+        if constexpr (mbo::kAllocCounting) ac0 = mbo::thread_alloc_counts();
         auto t0 = SteadyClock::now();
 
-        std::string book_json = book.to_json(depth);
+        std::string book_json;
+        {
+            mbo::StageScope st(stages, mbo::Stage::SnapshotBuild);
+            book_json = book.to_json(depth);
+        }
 
         // 1) WS publish
-        if (!sym.empty()) publish_snapshot(sym, book_json);
-        else publish_snapshot(book_json);
+        {
+            mbo::StageScope st(stages, mbo::Stage::Publish);
+            publish_frame(sym, book_json, processed, e2e);
+        }
 
         // 2) DB enqueue (Top-of-Book only)
-        if (!sym.empty() && last_ts_us > 0) {
+        if (pg && !sym.empty() && last_ts_us > 0) {
+            mbo::StageScope st(stages, mbo::Stage::Enqueue);
             TopOfBook tob = book.top_of_book();
             enqueue_snapshot_write(pg, q_mtx, q_cv, q, max_q, last_ts_us, sym, tob);
         }
 
         // 3) JSONL feed
         if (feed_writer && !sym.empty() && last_ts_us > 0) {
+            mbo::StageScope st(stages, mbo::Stage::Feed);
             mbo::FeedLine fl;
             fl.ts_us = last_ts_us;
             fl.symbol = sym;
@@ -188,13 +574,143 @@ static bool handle_line(
         uint64_t snap_ns =
             (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
         snap_hist.add(snap_ns);
+        if (perf) perf->snap.add(sc0, perf->pc.read(), 1);
+        if constexpr (mbo::kAllocCounting) allocs.snap.add(ac0, mbo::thread_alloc_counts(), 1);
+
+        mbo::bump(m.snapshots_total);
+        mbo::set_gauge(m.book_orders, book.order_count());
+        mbo::set_gauge(m.book_bid_levels, book.bid_levels());
+        mbo::set_gauge(m.book_ask_levels, book.ask_levels());
 
-        std::cerr << book.to_pretty_bbo() << "\n";
+        MBO_LOG_DEBUG("{}", book.to_pretty_bbo());
     }
 
     return true;
 }
 
+// ----------------------- Thread placement (INGEST_CPUS / WS_CPUS / WRITER_CPUS) -----------------------
+// Names the thread and pins it; failures are logged, never fatal.
+static void place_thread(const char* name, const std::vector<int>& cpus, pthread_t t = pthread_self()) {
+    if (pthread_equal(t, pthread_self())) mbo::name_current_thread(name);
+    if (cpus.empty()) return;
+    std::string err;
+    if (mbo::pin_thread(t, cpus, err)) {
+        MBO_LOG_INFO("[cpu] {} pinned to cpus {}", name, mbo::format_cpu_list(cpus));
+    } else {
+        MBO_LOG_WARN("[cpu] {} not pinned: {}", name, err);
+    }
+}
+
+// For threads started after the ingest thread was placed: drops the ingest
+// CPU set and SCHED_FIFO they inherited, then places them like place_thread.
+static void place_helper_thread(const char* name, const std::vector<int>& cpus, pthread_t t) {
+    std::string err;
+    if (!mbo::restore_default_placement(t, err)) MBO_LOG_WARN("[cpu] {} keeps the ingest placement: {}", name, err);
+    place_thread(name, cpus, t);
+}
+
+static bool would_block(const boost::system::error_code& ec) {
+    return ec == boost::asio::error::would_block || ec == boost::asio::error::try_again;
+}
+
+// Startup recovery: applies journal records [from, end) to the book the way
+// handle_line would (book, symbol, position); a reset marker starts over.
+static void recover_from_journal(const std::string& dir, FeedState& fs, uint64_t from) {
+    mbo::JournalReader reader;
+    std::string err;
+    if (!reader.open(dir, err) || reader.segments().empty()) return;   // nothing journaled yet
+    const uint64_t end = reader.end_index();
+    if (from < reader.first_index()) {
+        MBO_LOG_WARN("[journal] {} starts at index {}, the book needs {}: not replaying",
+                     dir, reader.first_index(), from);
+        return;
+    }
+    if (from >= end) return;
+
+    const auto t0 = SteadyClock::now();
+    MboEvent e;
+    const uint64_t n = reader.scan(from, end, [&](const mbo::MboRecord* recs, size_t k, uint64_t) {
+        for (size_t i = 0; i < k; ++i) {
+            const mbo::MboRecord& r = recs[i];
+            if (r.rtype == mbo::kRtypeJournalReset) {
+                fs.reset();
+                continue;
+            }
+            if (!fs.has_symbol && r.symbol[0]) {
+                fs.book_symbol = mbo::record_symbol(r);
+                fs.book = MboOrderBook(fs.book_symbol, fs.arena, fs.expected_orders);
+                fs.has_symbol = true;
+            }
+            mbo::book_event_from_record(r, e);
+            fs.book.apply(e);
+            fs.pos.advance(r.sequence, r.ts_event_ns);
+        }
+        return true;
+    }, &err);
+    if (!err.empty()) MBO_LOG_WARN("[journal] replay stopped: {}", err);
+
+    fs.dropped = fs.pos.applied > 0;
+    fs.dropped_at = SteadyClock::now();
+    MBO_LOG_INFO("[journal] replayed {} records [{}, {}) in {} ms: book {} orders, seq {} (+{})",
+                 n, from, from + n, std::chrono::duration<double, std::milli>(SteadyClock::now() - t0).count(),
+                 fs.book.order_count(), fs.pos.last_seq, fs.pos.seq_count);
+}
+
+// Hands the records staged since the last read to the journal writer.
+static void commit_journal(FeedState& fs) {
+    if (!fs.journal) return;
+    fs.journal->commit();
+    auto& m = mbo::metrics();
+    mbo::set_gauge(m.journal_records_total, fs.journal->records_written());
+    mbo::set_gauge(m.journal_dropped_total, fs.journal->records_dropped());
+    mbo::set_gauge(m.journal_segments_total, fs.journal->segments_opened());
+}
+
+// Reaps the previous checkpoint child and, when one is due, forks the next.
+// Called once per socket read, between lines, so the book and the position
+// always agree; `force` skips the interval (on a drop).
+static void maybe_checkpoint(FeedState& fs, bool force = false) {
+    if (!fs.ckpt) return;
+    auto& m = mbo::metrics();
+    switch (fs.ckpt->poll()) {
+        case mbo::CheckpointForker::Reap::Ok:
+            mbo::bump(m.checkpoints_total);
+            mbo::set_gauge(m.checkpoint_bytes, fs.ckpt->last_bytes());
+            MBO_LOG_DEBUG("[checkpoint] {} bytes in {} ms", fs.ckpt->last_bytes(),
+                          (double)fs.ckpt->last_write_ns() / 1e6);
+            if (fs.ckpt->last_journal_pruned() > 0) {
+                MBO_LOG_INFO("[journal] pruned {} segment(s) behind the oldest kept checkpoint",
+                             fs.ckpt->last_journal_pruned());
+            }
+            break;
+        case mbo::CheckpointForker::Reap::Failed:
+            mbo::bump(m.checkpoint_failures_total);
+            MBO_LOG_WARN("[checkpoint] child failed, {} kept as is", fs.ckpt->last_path());
+            break;
+        case mbo::CheckpointForker::Reap::None:
+            break;
+    }
+
+    const auto now = SteadyClock::now();
+    if ((!force && now < fs.ckpt_next) || fs.ckpt->running() || fs.pos.applied == 0) return;
+    fs.ckpt_next = now + fs.ckpt_every;
+
+    mbo::CheckpointMeta meta;
+    meta.symbol = fs.book_symbol;
+    meta.last_seq = fs.pos.last_seq;
+    meta.seq_count = fs.pos.seq_count;
+    meta.applied = fs.pos.applied;
+    meta.last_ts_ns = fs.pos.last_ts_ns;
+    if (fs.journal) meta.journal_index = fs.journal->next_index();
+    std::string err;
+    if (fs.ckpt->start(fs.book, meta, err)) {
+        mbo::set_gauge(m.checkpoint_fork_us, fs.ckpt->last_fork_ns() / 1000);
+    } else {
+        mbo::bump(m.checkpoint_failures_total);
+        MBO_LOG_WARN("[checkpoint] {}", err);
+    }
+}
+
 static void run_one_replay_session(
     const AppConfig& cfg,
     PgWriter* pg,
@@ -202,7 +718,8 @@ static void run_one_replay_session(
     std::condition_variable& q_cv,
     std::deque<SnapshotWrite>& q,
     size_t max_q,
-    mbo::JsonlWriter* bench_writer // optional
+    mbo::AsyncJsonlWriter* bench_writer, // optional
+    FeedState& fs                        // book + feed position, kept across reconnects
 ) {
     boost::asio::io_context io;
     tcp::resolver resolver(io);
@@ -212,7 +729,30 @@ static void run_one_replay_session(
     auto endpoints = resolver.resolve(cfg.host, std::to_string(cfg.port));
     boost::asio::connect(socket, endpoints);
     socket.set_option(tcp::no_delay(true));
-    std::cerr << "[tcp_main] connected to " << cfg.host << ":" << cfg.port << "\n";
+    MBO_LOG_INFO("[tcp_main] connected to {}:{}", cfg.host, cfg.port);
+
+    // handshake: resume on the kept book, or start over
+    bool resuming = cfg.feed_resume && fs.resumable();
+    if (resuming) {
+        const std::string msg = "RESUME " + std::to_string(fs.pos.last_seq) + " " +
+                                std::to_string(fs.pos.seq_count) +
+                                (fs.feed_run.empty() ? "" : " " + fs.feed_run) + "\n";
+        boost::asio::write(socket, boost::asio::buffer(msg));
+        mbo::bump(mbo::metrics().feed_resumes_total);
+        MBO_LOG_INFO("[resume] after seq {} (+{}), {} records applied, book {} orders, {} ms since the drop",
+                     fs.pos.last_seq, fs.pos.seq_count, fs.pos.applied, fs.book.order_count(),
+                     std::chrono::duration<double, std::milli>(SteadyClock::now() - fs.dropped_at).count());
+    } else {
+        fs.reset();
+        boost::asio::write(socket, boost::asio::buffer(std::string("HELLO\n")));
+    }
+    fs.dropped = false;
+
+    mbo::bump(mbo::metrics().sessions_total);
+    mbo::set_gauge(mbo::metrics().feed_connected, 1);
+    struct FeedGauge {
+        ~FeedGauge() { mbo::set_gauge(mbo::metrics().feed_connected, 0); }
+    } feed_gauge;
 
     // per-session feed writer (append)
     mbo::JsonlWriter feed_writer;
@@ -220,20 +760,67 @@ static void run_one_replay_session(
     if (cfg.feed_enabled && !cfg.feed_path.empty()) {
         if (feed_writer.open(cfg.feed_path, /*append=*/true)) {
             feed_ptr = &feed_writer;
-            std::cerr << "[feed] appending snapshots to: " << feed_writer.path() << "\n";
+            MBO_LOG_INFO("[feed] appending snapshots to: {}", feed_writer.path());
         } else {
-            std::cerr << "[feed] disabled (open failed)\n";
+            MBO_LOG_WARN("[feed] disabled (open failed)");
         }
     }
 
-    // reset per-session state
-    MboOrderBook book("");
-    bool has_symbol = false;
-    std::string book_symbol;
-    book_symbol.reserve(16);
+    // the book lives in FeedState (fresh unless resuming); the rest is per session
+    MboOrderBook& book = fs.book;
+    bool& has_symbol = fs.has_symbol;
+    std::string& book_symbol = fs.book_symbol;
+    bool feed_complete = false;   // saw the streamer's "#END"
+
+    mbo::StageTimers stages(cfg.stage_sample_every, cfg.hist_digits); // Benchmark 1 + per-stage
+    stages.attach(mbo::metrics().stage);                               // live /metrics histograms
+    mbo::HdrHistogram snap_hist(cfg.hist_digits);  // Benchmark 2
+    SessionE2E e2e(cfg.hist_digits);               // wire -> apply -> publish (stamped feeds only)
+    SessionAlloc allocs;      // heap allocations per stage (ALLOC_COUNT=1 builds)
+    SessionCatchup cu(cfg);   // lag monitor + catch-up mode
+    SessionRx rx(cfg.stage_sample_every, cfg.hist_digits);  // kernel rx -> parse -> apply
+
+    // per-symbol ts_recv - ts_event / ts_in_delta / apply - ts_recv
+    std::unique_ptr<mbo::FeedLatencyTracker> flat_state;
+    mbo::FeedLatencyTracker* flat = nullptr;
+    if (cfg.feed_latency_window_s > 0) {
+        flat_state = std::make_unique<mbo::FeedLatencyTracker>(
+            cfg.hist_digits, (int64_t)(cfg.feed_latency_window_s * 1e9), cfg.stage_sample_every);
+        flat = flat_state.get();
+    }
+    const bool flat_publish = flat && cfg.metrics_port > 0;
+    auto flat_next = SteadyClock::now();
 
-    Pow2Histogram apply_hist; // Benchmark 1
-    Pow2Histogram snap_hist;  // Benchmark 2
+    if (cfg.rx_timestamps) {
+        rx.mode = mbo::enable_rx_timestamps(socket.native_handle());
+        MBO_LOG_INFO("[rx] kernel receive timestamps: {}", mbo::rx_timestamp_mode_name(rx.mode));
+    }
+
+    // busy-poll: never sleep in read; an empty socket is retried in a spin loop
+    uint64_t empty_polls = 0;
+    if (cfg.busy_poll) {
+        socket.non_blocking(true);
+        std::string err;
+        if (!mbo::enable_socket_busy_poll(socket.native_handle(), cfg.busy_poll_us, err)) {
+            MBO_LOG_WARN("[cpu] {} (spinning without it)", err);
+        }
+        MBO_LOG_INFO("[cpu] busy-poll ingest (SO_BUSY_POLL={} us)", cfg.busy_poll_us);
+    }
+
+    // optional hardware counters (ingest thread only)
+    std::unique_ptr<SessionPerf> perf_state;
+    SessionPerf* perf = nullptr;
+    if (cfg.perf_counters) {
+        perf_state = std::make_unique<SessionPerf>();
+        if (perf_state->pc.available()) {
+            perf_state->sample_every = cfg.perf_sample_every;
+            perf_state->pc.start();
+            perf = perf_state.get();
+            MBO_LOG_INFO("[perf] counters enabled (apply sampled 1/{})", perf->sample_every);
+        } else {
+            MBO_LOG_WARN("[perf] counters unavailable: {}", perf_state->pc.error());
+        }
+    }
 
     int64_t processed = 0, parsed_ok = 0;
     uint64_t bytes_total = 0;
@@ -247,17 +834,55 @@ static void run_one_replay_session(
     auto t0 = SteadyClock::now();
     boost::system::error_code ec;
 
+    // interval bench lines (checked once per socket read, not per event)
+    const bool intervals = bench_writer && bench_writer->is_open() && cfg.bench_interval_s > 0;
+    IntervalState iv;
+    iv.start = t0;
+    iv.len = std::chrono::duration_cast<SteadyClock::duration>(
+        std::chrono::duration<double>(cfg.bench_interval_s > 0 ? cfg.bench_interval_s : 1.0));
+    iv.next = t0 + iv.len;
+    iv.pg_dropped0 = mbo::metrics().pg_rows_dropped.load(std::memory_order_relaxed);
+    mbo::set_gauge(mbo::metrics().pg_queue_interval_hwm, 0);
+
     while (true) {
-        std::size_t n = socket.read_some(boost::asio::buffer(buf), ec);
+        std::size_t n;
+        {
+            // in busy-poll mode the spin is part of the read, as the sleep is
+            // in a blocking read
+            mbo::StageScope st(stages, mbo::Stage::Read);
+            uint64_t spins = 0;
+            while (true) {
+                if (rx.mode != mbo::RxTimestampMode::None) {
+                    const ssize_t r = mbo::recv_with_rx_timestamp(socket.native_handle(), buf.data(), buf.size(),
+                                                                  rx.batch_rx_ns);
+                    n = r > 0 ? (std::size_t)r : 0;
+                    if (r < 0) ec = boost::system::error_code(errno, boost::system::system_category());
+                    else if (r == 0) ec = boost::asio::error::eof;
+                } else {
+                    n = socket.read_some(boost::asio::buffer(buf), ec);
+                }
+                if (!cfg.busy_poll || !would_block(ec)) break;
+                ec.clear();
+                ++spins;
+                mbo::cpu_relax();
+            }
+            if (rx.batch_rx_ns) rx.stamped_batches++;
+            if (spins) {
+                empty_polls += spins;
+                mbo::bump(mbo::metrics().feed_empty_polls_total, spins);
+            }
+        }
 
         if (ec && ec != boost::asio::error::eof) {
-            std::cerr << "[tcp_main] read error: " << ec.message() << "\n";
+            MBO_LOG_WARN("[tcp_main] read error: {}", ec.message());
             break;
         }
 
         if (n > 0) {
             bytes_total += n;
+            mbo::bump(mbo::metrics().bytes_read_total, n);
             carry.append(buf.data(), n);
+            if (carry.size() > iv.carry_hwm) iv.carry_hwm = carry.size();
 
             std::size_t pos = 0;
             while (true) {
@@ -267,47 +892,132 @@ static void run_one_replay_session(
                     break;
                 }
 
-                std::string line = carry.substr(pos, nl - pos);
+                mbo::AllocCounts fa0;
+                if constexpr (mbo::kAllocCounting) fa0 = mbo::thread_alloc_counts();
+                std::string line;
+                {
+                    mbo::StageScope st(stages, mbo::Stage::Frame);
+                    line = carry.substr(pos, nl - pos);
+                }
                 pos = nl + 1;
+                if constexpr (mbo::kAllocCounting) allocs.frame.add(fa0, mbo::thread_alloc_counts(), 1);
+
+                if (line == "#END") {
+                    feed_complete = true;
+                    continue;
+                }
+                if (line.compare(0, 9, "#SESSION ") == 0) {
+                    // "#SESSION <run> FRESH|RESUMED", before any data
+                    const size_t sp = line.find(' ', 9);
+                    const std::string run = line.substr(9, sp == std::string::npos ? std::string::npos : sp - 9);
+                    const bool fresh = sp == std::string::npos || line.compare(sp + 1, 5, "FRESH") == 0;
+                    if (resuming && fresh) {
+                        MBO_LOG_WARN("[resume] streamer run {} started a fresh replay; dropping the kept book", run);
+                        fs.reset();
+                        resuming = false;
+                    }
+                    fs.feed_run = run;
+                    continue;
+                }
 
                 if (cfg.max_msgs < 0 || processed < cfg.max_msgs) {
-                    handle_line(line, book, book_symbol, has_symbol,
-                                apply_hist, snap_hist,
+                    handle_line(line, book, book_symbol, has_symbol, fs.pos,
+                                stages, snap_hist,
                                 cfg.depth, cfg.snapshot_every,
                                 processed, parsed_ok, lines_total,
                                 last_ts_us,
                                 pg, q_mtx, q_cv, q, max_q,
-                                feed_ptr);
+                                feed_ptr, perf, e2e, allocs, cu, rx, flat, fs.journal.get());
+                    if (iv.ts0_us == 0) iv.ts0_us = last_ts_us;  // event-time baseline of interval 1
                 } else {
                     lines_total++;
                 }
             }
         }
 
+        // Lag check. read_some returns everything queued up to buf.size(), so
+        // the receive queue can only be non-empty after a full read: that is
+        // the only case that pays for the FIONREAD ioctl.
+        if (cu.lag.enabled() && n > 0) {
+            uint64_t backlog = 0;
+            if (n == buf.size()) {
+                int avail = 0;
+                if (::ioctl(socket.native_handle(), FIONREAD, &avail) == 0 && avail > 0) backlog = (uint64_t)avail;
+            }
+            auto& m = mbo::metrics();
+            const uint64_t ns0 = cu.lag.catchup_ns();
+            if (cu.lag.update(backlog, last_ts_us, now_wall_us(), SteadyClock::now())) {
+                const bool on = cu.lag.catchup();
+                mbo::bump(on ? m.catchup_entries_total : m.catchup_exits_total);
+                mbo::set_gauge(m.catchup_active, on ? 1 : 0);
+                if (on) cu.next_publish = SteadyClock::time_point{};
+                MBO_LOG_RATELIMITED(mbo::LogLevel::Info, 10, "[catchup] {} backlog={}B drift={}ms processed={}",
+                                    on ? "enter" : "exit", cu.lag.backlog_bytes(),
+                                    (double)cu.lag.drift_us() / 1e3, processed);
+            }
+            mbo::bump(m.catchup_ns_total, cu.lag.catchup_ns() - ns0);
+            mbo::set_gauge(m.feed_backlog_bytes, cu.lag.backlog_bytes());
+            mbo::set_gauge(m.event_drift_us, (uint64_t)cu.lag.drift_us());
+        }
+
+        // rolling feed-latency quantiles for /metrics, about once a second
+        if (flat_publish) {
+            const auto now = SteadyClock::now();
+            if (now >= flat_next) {
+                mbo::set_feed_latency_prometheus(flat->to_prometheus());
+                flat_next = now + std::chrono::seconds(1);
+            }
+        }
+
+        if (intervals) {
+            const auto now = SteadyClock::now();
+            if (now >= iv.next) {
+                emit_interval(cfg, *bench_writer, stages, cu.lag, iv, now, t0,
+                              processed, (int64_t)lines_total - parsed_ok, bytes_total, last_ts_us);
+            }
+        }
+
+        commit_journal(fs);
+        maybe_checkpoint(fs);
+
         if (ec == boost::asio::error::eof) break;
     }
 
-    // trailing partial line
-    if (!carry.empty() && (cfg.max_msgs < 0 || processed < cfg.max_msgs)) {
+    // the session ends the mode: the final flush below takes a full snapshot
+    if (cu.lag.catchup()) mbo::set_gauge(mbo::metrics().catchup_active, 0);
+
+    // a drop before "#END" keeps the book for the next session to resume
+    if (cfg.feed_resume && !feed_complete && fs.pos.applied > 0) {
+        fs.dropped = true;
+        fs.dropped_at = SteadyClock::now();
+        MBO_LOG_WARN("[resume] feed dropped after seq {} ({} records applied); book kept for resume",
+                     fs.pos.last_seq, fs.pos.applied);
+        maybe_checkpoint(fs, /*force=*/true);   // the kept book also survives a restart
+    }
+
+    // trailing partial line (a dropped connection's tail is resent on resume)
+    if (!carry.empty() && !fs.dropped && (cfg.max_msgs < 0 || processed < cfg.max_msgs)) {
         std::string tail = carry;
         carry.clear();
-        handle_line(tail, book, book_symbol, has_symbol,
-                    apply_hist, snap_hist,
+        handle_line(tail, book, book_symbol, has_symbol, fs.pos,
+                    stages, snap_hist,
                     cfg.depth, cfg.snapshot_every,
                     processed, parsed_ok, lines_total,
                     last_ts_us,
                     pg, q_mtx, q_cv, q, max_q,
-                    feed_ptr);
+                    feed_ptr, perf, e2e, allocs, cu, rx, flat, fs.journal.get());
     }
+    commit_journal(fs);
 
-    // final flush if remainder exists (also measure snapshot latency once)
-    if (processed > 0 && (cfg.snapshot_every <= 0 || (processed % cfg.snapshot_every != 0))) {
+    // final flush if remainder exists (also measure snapshot latency once);
+    // a resumable drop is mid-replay, so it only checkpoints (above)
+    if (!fs.dropped && processed > 0 &&
+        (cfg.snapshot_every <= 0 || (processed % cfg.snapshot_every != 0) || cu.pending)) {
         auto t0s = SteadyClock::now();
 
         std::string json = book.to_json(cfg.depth);
 
-        if (!book_symbol.empty()) publish_snapshot(book_symbol, json);
-        else publish_snapshot(json);
+        publish_frame(book_symbol, json, processed, e2e);
 
         if (pg && !book_symbol.empty() && last_ts_us > 0) {
             TopOfBook tob = book.top_of_book();
@@ -329,47 +1039,83 @@ static void run_one_replay_session(
             (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1s - t0s).count();
         snap_hist.add(snap_ns);
 
-        std::cerr << "[final] forced snapshot flush (remainder)\n";
+        MBO_LOG_INFO("[final] forced snapshot flush (remainder)");
     }
 
     // final BBO
-    std::cerr << book.to_pretty_bbo() << "\n";
+    MBO_LOG_INFO("{}", book.to_pretty_bbo());
 
-    // ✅ NEW: dump full book json via file_output module
-    {
+    // ✅ NEW: dump full book json via file_output module (not for a mid-replay book kept for resume)
+    if (!fs.dropped) {
         std::string full_json = book.to_json(1'000'000);
         mbo::write_final_books_json(full_json, book_symbol);
     }
 
     if (feed_ptr) {
         feed_ptr->flush();
-        std::cerr << "[feed] flushed\n";
+        MBO_LOG_INFO("[feed] flushed");
     }
 
     auto t1 = SteadyClock::now();
     double secs = std::chrono::duration<double>(t1 - t0).count();
+
+    // close the last (partial) interval, then fold it into the session totals
+    if (intervals && processed > iv.processed0) {
+        emit_interval(cfg, *bench_writer, stages, cu.lag, iv, t1, t0,
+                      processed, (int64_t)lines_total - parsed_ok, bytes_total, last_ts_us);
+    }
+    stages.roll_interval();
     double mps = (secs > 0) ? (processed / secs) : 0.0;
 
     auto ns_to_us = [](uint64_t ns) -> double { return (double)ns / 1000.0; };
     auto ns_to_ms = [](uint64_t ns) -> double { return (double)ns / 1e6; };
 
-    auto apply_p50 = apply_hist.percentile(0.50);
-    auto apply_p95 = apply_hist.percentile(0.95);
-    auto apply_p99 = apply_hist.percentile(0.99);
+    const mbo::HdrHistogram& apply_hist = stages.hist(mbo::Stage::Apply);
+    auto apply_p50 = apply_hist.value_at_percentile(50);
+    auto apply_p95 = apply_hist.value_at_percentile(95);
+    auto apply_p99 = apply_hist.value_at_percentile(99);
 
-    auto snap_p50 = snap_hist.percentile(0.50);
-    auto snap_p95 = snap_hist.percentile(0.95);
-    auto snap_p99 = snap_hist.percentile(0.99);
+    auto snap_p50 = snap_hist.value_at_percentile(50);
+    auto snap_p95 = snap_hist.value_at_percentile(95);
+    auto snap_p99 = snap_hist.value_at_percentile(99);
 
+    // the stats report goes straight to stderr; let pending log lines out first
+    mbo::log_flush();
     std::cerr << "=== TCP Main Stats (session) ===\n";
     std::cerr << "bytes_total: " << bytes_total << "\n";
     std::cerr << "lines_total: " << lines_total << "\n";
     std::cerr << "processed: " << processed << " (parsed_ok=" << parsed_ok << ")\n";
+    if (resuming || fs.dropped) {
+        std::cerr << "feed_position: seq " << fs.pos.last_seq << " (+" << fs.pos.seq_count << "), "
+                  << fs.pos.applied << " records since replay start"
+                  << (resuming ? ", resumed" : "") << (fs.dropped ? ", dropped" : "") << "\n";
+    }
+    if (fs.journal) {
+        std::cerr << "journal: next index " << fs.journal->next_index() << ", "
+                  << fs.journal->records_written() << " written, " << fs.journal->records_dropped()
+                  << " dropped, " << fs.journal->segments_opened() << " segment(s)\n";
+    }
     std::cerr << "elapsed_s: " << secs << "\n";
     std::cerr << "throughput_msgs_per_s: " << mps << "\n";
     std::cerr << "apply_latency_est_p50: " << ns_to_us(apply_p50) << " us\n";
     std::cerr << "apply_latency_est_p95: " << ns_to_us(apply_p95) << " us\n";
     std::cerr << "apply_latency_est_p99: " << ns_to_us(apply_p99) << " us\n";
+    std::cerr << "apply_latency_p999: " << ns_to_us(apply_hist.value_at_percentile(99.9))
+              << " us (max " << ns_to_us(apply_hist.max()) << " us, mean " << apply_hist.mean() / 1e3
+              << " us, n=" << apply_hist.count() << ")\n";
+
+    std::string stages_json;
+    if (stages.enabled()) {
+        stages_json = stages.to_json();
+        for (int i = 0; i < mbo::kStageCount; ++i) {
+            const auto st = (mbo::Stage)i;
+            const auto& h = stages.hist(st);
+            if (h.count() == 0) continue;
+            std::cerr << "stage_" << mbo::stage_name(st) << ": p50=" << ns_to_us(h.value_at_percentile(50))
+                      << " us p99=" << ns_to_us(h.value_at_percentile(99))
+                      << " us max=" << ns_to_us(h.max()) << " us (n=" << h.count() << ")\n";
+        }
+    }
 
     if (cfg.snapshot_every > 0) {
         std::cerr << "snapshot_latency_est_p50: " << ns_to_ms(snap_p50) << " ms\n";
@@ -377,6 +1123,68 @@ static void run_one_replay_session(
         std::cerr << "snapshot_latency_est_p99: " << ns_to_ms(snap_p99) << " ms\n";
     }
 
+    if (e2e.stamped > 0) {
+        std::cerr << "e2e_stamped_events: " << e2e.stamped << "\n";
+        std::cerr << "e2e_send_apply_est_p50: " << ns_to_us(e2e.send_apply.value_at_percentile(50)) << " us\n";
+        std::cerr << "e2e_send_apply_est_p99: " << ns_to_us(e2e.send_apply.value_at_percentile(99)) << " us\n";
+        std::cerr << "e2e_send_publish_est_p50: " << ns_to_us(e2e.send_publish.value_at_percentile(50)) << " us\n";
+        std::cerr << "e2e_send_publish_est_p99: " << ns_to_us(e2e.send_publish.value_at_percentile(99)) << " us\n";
+    }
+
+    std::string feed_latency_json;
+    if (flat && !flat->empty()) {
+        if (flat_publish) mbo::set_feed_latency_prometheus(flat->to_prometheus());
+        feed_latency_json = flat->to_json();
+        std::cerr << "feed_latency_us: " << feed_latency_json << "\n";
+    }
+
+    std::string rx_json;
+    if (rx.rx_apply.count() > 0) {
+        rx_json = rx.to_json();
+        std::cerr << "rx_to_parse_p50: " << ns_to_us(rx.rx_parse.value_at_percentile(50))
+                  << " us p99=" << ns_to_us(rx.rx_parse.value_at_percentile(99)) << " us\n";
+        std::cerr << "rx_to_apply_p50: " << ns_to_us(rx.rx_apply.value_at_percentile(50))
+                  << " us p99=" << ns_to_us(rx.rx_apply.value_at_percentile(99))
+                  << " us (n=" << rx.rx_apply.count() << ", " << rx.stamped_batches << " stamped reads)\n";
+    }
+
+    std::string book_arena_json;
+    if (fs.arena) {
+        book_arena_json = fs.arena->to_json();
+        std::cerr << "book_arena: " << book_arena_json << "\n";
+    }
+
+    if (cfg.busy_poll) {
+        std::cerr << "busy_poll_empty_reads: " << empty_polls << "\n";
+    }
+
+    if (cu.lag.entries() > 0) {
+        std::cerr << "catchup_entries: " << cu.lag.entries()
+                  << " (catchup_s=" << (double)cu.lag.catchup_ns() / 1e9
+                  << ", snapshots_conflated=" << cu.conflated << ")\n";
+    }
+
+    std::string alloc_json;
+    if constexpr (mbo::kAllocCounting) {
+        alloc_json = allocs.to_json();
+        std::cerr << "allocs_per_line_frame: " << allocs.frame.allocs_per_item() << "\n";
+        std::cerr << "allocs_per_line_parse: " << allocs.parse.allocs_per_item()
+                  << " (" << allocs.parse.bytes_per_item() << " B)\n";
+        std::cerr << "allocs_per_event_apply: " << allocs.apply.allocs_per_item()
+                  << " (" << allocs.apply.bytes_per_item() << " B)\n";
+        std::cerr << "allocs_per_snapshot: " << allocs.snap.allocs_per_item()
+                  << " (" << allocs.snap.bytes_per_item() << " B)\n";
+    }
+
+    std::string perf_apply_json, perf_snap_json;
+    if (perf) {
+        perf->pc.stop();
+        perf_apply_json = perf->apply.to_json(perf->pc);
+        perf_snap_json = perf->snap.to_json(perf->pc);
+        std::cerr << "perf_apply_per_event: " << perf_apply_json << "\n";
+        std::cerr << "perf_snapshot_per_snapshot: " << perf_snap_json << "\n";
+    }
+
     // JSONL bench summary (one line per session)
     if (bench_writer && bench_writer->is_open()) {
         mbo::BenchLine bl;
@@ -400,56 +1208,110 @@ static void run_one_replay_session(
         bl.snap_p95_ms = ns_to_ms(snap_p95);
         bl.snap_p99_ms = ns_to_ms(snap_p99);
 
+        bl.e2e_stamped = (int64_t)e2e.stamped;
+        bl.e2e_send_apply_p50_us = ns_to_us(e2e.send_apply.value_at_percentile(50));
+        bl.e2e_send_apply_p99_us = ns_to_us(e2e.send_apply.value_at_percentile(99));
+        bl.e2e_send_publish_p50_us = ns_to_us(e2e.send_publish.value_at_percentile(50));
+        bl.e2e_send_publish_p99_us = ns_to_us(e2e.send_publish.value_at_percentile(99));
+
+        bl.apply_hist_json = apply_hist.to_json(1e3);
+        bl.stages_json = stages_json;
+        bl.snap_hist_json = snap_hist.to_json(1e6);
+
+        bl.rx_json = rx_json;
+        bl.book_arena_json = book_arena_json;
+        bl.feed_latency_json = feed_latency_json;
+
+        bl.catchup_entries = (int64_t)cu.lag.entries();
+        bl.catchup_s = (double)cu.lag.catchup_ns() / 1e9;
+        bl.snapshots_conflated = (int64_t)cu.conflated;
+
+        bl.alloc_json = alloc_json;
+        bl.perf_apply_json = perf_apply_json;
+        bl.perf_snap_json = perf_snap_json;
+
         bench_writer->write_bench(bl);
         bench_writer->flush();
     }
 
-    std::cerr << "[tcp_main] session done, back to waiting...\n";
+    MBO_LOG_INFO("[tcp_main] session done, back to waiting...");
 }
 
 int main(int argc, char** argv) {
     AppConfig cfg = parse_config(argc, argv);
     if (argc < 4) return 1;
+    mbo::capture_default_placement();   // before any thread is pinned
 
     if (cfg.feed_enabled) {
-        std::cerr << "[feed] enabled, path=" << cfg.feed_path << "\n";
+        MBO_LOG_INFO("[feed] enabled, path={}", cfg.feed_path);
+    } else {
+        MBO_LOG_INFO("[feed] disabled (set FEED_ENABLED=1)");
+    }
+
+    // ---- Snapshot store (before any publisher / WS thread) ----
+    if (auto store = make_snapshot_store(cfg.snapshot_store)) {
+        set_snapshot_store(std::move(store));
     } else {
-        std::cerr << "[feed] disabled (set FEED_ENABLED=1)\n";
+        MBO_LOG_WARN("[store] unknown SNAPSHOT_STORE={}, using {}", cfg.snapshot_store, snapshot_store().name());
     }
+    MBO_LOG_INFO("[store] {}", snapshot_store().name());
 
     // ---- Start WebSocket server ----
     boost::asio::io_context ws_ioc;
     try {
         start_ws_server(ws_ioc, cfg.ws_port, cfg.push_ms);
     } catch (const std::exception& e) {
-        std::cerr << "[ws] failed to start: " << e.what() << "\n";
+        MBO_LOG_ERROR("[ws] failed to start: {}", e.what());
+        mbo::log_flush();
         return 1;
     }
 
     std::thread ws_thread([&]{
-        std::cerr << "[ws] listening on port " << cfg.ws_port
-                  << " (push every " << cfg.push_ms << " ms)\n";
+        place_thread("mbo-ws", cfg.ws_cpus);
+        MBO_LOG_INFO("[ws] listening on port {} (push every {} ms)", cfg.ws_port, cfg.push_ms);
         ws_ioc.run();
     });
 
+    // ---- Metrics listener (optional) ----
+    boost::asio::io_context metrics_ioc;
+    std::thread metrics_thread;
+    if (cfg.metrics_port > 0) {
+        try {
+            start_metrics_server(metrics_ioc, cfg.metrics_port);
+            metrics_thread = std::thread([&]{
+                place_thread("mbo-metrics", cfg.writer_cpus);
+                metrics_ioc.run();
+            });
+            MBO_LOG_INFO("[metrics] serving http://0.0.0.0:{}/metrics", cfg.metrics_port);
+        } catch (const std::exception& e) {
+            MBO_LOG_ERROR("[metrics] failed to start: {}", e.what());
+        }
+    } else {
+        MBO_LOG_INFO("[metrics] disabled (set METRICS_PORT)");
+    }
+
     // ---- PG Writer init (optional) ----
     std::unique_ptr<PgWriter> pg;
     if (!cfg.pg_conninfo.empty()) {
         pg = std::make_unique<PgWriter>(cfg.pg_conninfo);
-        std::cerr << "[pg] enabled\n";
+        MBO_LOG_INFO("[pg] enabled");
     } else {
-        std::cerr << "[pg] disabled (set PG_CONNINFO)\n";
+        MBO_LOG_INFO("[pg] disabled (set PG_CONNINFO)");
     }
 
     // ---- Bench writer (append) ----
-    mbo::JsonlWriter bench_writer;
-    mbo::JsonlWriter* bench_ptr = nullptr;
+    mbo::AsyncJsonlWriter bench_writer;
+    mbo::AsyncJsonlWriter* bench_ptr = nullptr;
     if (!cfg.bench_log_path.empty()) {
         if (bench_writer.open(cfg.bench_log_path, /*append=*/true)) {
             bench_ptr = &bench_writer;
-            std::cerr << "[bench] logging to: " << bench_writer.path() << "\n";
+            if (cfg.bench_interval_s > 0) {
+                MBO_LOG_INFO("[bench] logging to: {} (interval lines every {} s)", bench_writer.path(), cfg.bench_interval_s);
+            } else {
+                MBO_LOG_INFO("[bench] logging to: {}", bench_writer.path());
+            }
         } else {
-            std::cerr << "[bench] disabled (open failed)\n";
+            MBO_LOG_WARN("[bench] disabled (open failed)");
         }
     }
 
@@ -463,6 +1325,7 @@ int main(int argc, char** argv) {
     std::thread pg_thread;
     if (pg) {
         pg_thread = std::thread([&]{
+            place_thread("mbo-pg", cfg.writer_cpus);
             while (true) {
                 SnapshotWrite item;
                 {
@@ -476,35 +1339,185 @@ int main(int argc, char** argv) {
 
                     item = std::move(q.front());
                     q.pop_front();
+                    mbo::set_gauge(mbo::metrics().pg_queue_depth, q.size());
                 }
-                pg->write_snapshot(item.ts_us, item.symbol, item.tob);
+                const bool ok = pg->write_snapshot(item.ts_us, item.symbol, item.tob);
+                mbo::bump(ok ? mbo::metrics().pg_rows_written : mbo::metrics().pg_rows_failed);
             }
-            std::cerr << "[pg] writer thread exit\n";
+            MBO_LOG_INFO("[pg] writer thread exit");
         });
     }
 
-    // Main loop: wait for streamer forever (retry connect)
-    while (true) {
+    // ---- Ingest thread placement (after the long-lived helper threads have
+    // started, so they don't inherit the ingest CPU set or priority; threads
+    // started later go through place_helper_thread) ----
+    if (bench_ptr) place_thread("bench writer", cfg.writer_cpus, bench_writer.native_handle());
+    place_thread("mbo-ingest", cfg.ingest_cpus);
+    if (cfg.ingest_rt_prio > 0) {
+        std::string err;
+        if (mbo::set_current_thread_fifo(cfg.ingest_rt_prio, err)) {
+            MBO_LOG_INFO("[cpu] ingest thread SCHED_FIFO priority {}", cfg.ingest_rt_prio);
+            if (cfg.busy_poll && cfg.ingest_cpus.empty()) {
+                MBO_LOG_WARN("[cpu] BUSY_POLL + SCHED_FIFO without INGEST_CPUS: the spinning ingest thread "
+                             "can starve everything else on its core");
+            }
+        } else {
+            MBO_LOG_WARN("[cpu] ingest thread keeps default scheduling: {}", err);
+        }
+    }
+
+    // ---- Book arena: mapped and pre-faulted once, on the (pinned) ingest
+    // thread so first-touch places it on the ingest core's NUMA node; reused
+    // by every session's book ----
+    std::unique_ptr<mbo::BookArena> arena;
+    if (cfg.book_arena_orders > 0) {
+        mbo::BookArenaOptions ao;
+        ao.bytes = mbo::book_arena_bytes_for_orders((size_t)cfg.book_arena_orders);
+        ao.pages = cfg.book_arena_pages == "hugetlb" ? mbo::ArenaPages::Hugetlb
+                 : cfg.book_arena_pages == "4k"      ? mbo::ArenaPages::Normal
+                                                     : mbo::ArenaPages::Thp;
+        ao.prefault = cfg.book_arena_prefault;
+        ao.mlock = cfg.book_arena_mlock;
+        const auto a0 = SteadyClock::now();
+        arena = std::make_unique<mbo::BookArena>(ao);
+        const double setup_ms = std::chrono::duration<double, std::milli>(SteadyClock::now() - a0).count();
+        if (!arena->error().empty()) MBO_LOG_WARN("[arena] {}", arena->error());
+        if (arena->ok()) {
+            MBO_LOG_INFO("[arena] {} MB for {} orders, pages={} huge={} MB prefault={} mlock={} ({} ms)",
+                         arena->capacity() >> 20, cfg.book_arena_orders, mbo::arena_pages_name(arena->pages()),
+                         arena->huge_page_bytes() >> 20, ao.prefault, arena->locked(), setup_ms);
+        } else {
+            arena.reset();
+        }
+    }
+
+    FeedState fs(arena.get(), (size_t)cfg.book_arena_orders);
+
+    // ---- Book checkpoint: warm start from the last one, then keep writing
+    // them. A loaded checkpoint is treated like a dropped session, so the
+    // first connect sends RESUME from its position ----
+    uint64_t journal_from = 0;   // journal records already in the book
+    const bool keep_history = !cfg.journal_dir.empty() && cfg.checkpoint_keep > 0;
+    if (!cfg.checkpoint_path.empty() || keep_history) {
+        fs.ckpt = std::make_unique<mbo::CheckpointForker>(cfg.checkpoint_path);
+        if (keep_history) {
+            fs.ckpt->keep_history(cfg.journal_dir, (size_t)cfg.checkpoint_keep);
+            fs.ckpt->prune_journal(cfg.journal_prune);
+        }
+        fs.ckpt_every = std::chrono::duration_cast<SteadyClock::duration>(
+            std::chrono::duration<double>(cfg.checkpoint_interval_s));
+        fs.ckpt_next = SteadyClock::now() + fs.ckpt_every;
+    }
+    if (!cfg.checkpoint_path.empty()) {
+
+        struct stat st{};
+        if (cfg.checkpoint_load && !cfg.feed_resume) {
+            MBO_LOG_WARN("[checkpoint] FEED_RESUME=0: not loading {}", cfg.checkpoint_path);
+        } else if (cfg.checkpoint_load && ::stat(cfg.checkpoint_path.c_str(), &st) == 0) {
+            const auto c0 = SteadyClock::now();
+            mbo::CheckpointMeta meta;
+            mbo::CheckpointStats cs;
+            std::string err;
+            if (mbo::read_book_checkpoint(cfg.checkpoint_path, fs.book, meta, err, &cs)) {
+                fs.book_symbol = meta.symbol;
+                fs.has_symbol = !meta.symbol.empty();
+                fs.pos.last_seq = meta.last_seq;
+                fs.pos.seq_count = meta.seq_count;
+                fs.pos.applied = meta.applied;
+                fs.pos.last_ts_ns = meta.last_ts_ns;
+                fs.dropped = true;
+                fs.dropped_at = SteadyClock::now();
+                journal_from = meta.journal_index;
+                MBO_LOG_INFO("[checkpoint] warm start from {}: {} orders, {} KB in {} ms",
+                             cfg.checkpoint_path, cs.orders, cs.bytes >> 10,
+                             std::chrono::duration<double, std::milli>(SteadyClock::now() - c0).count());
+                MBO_LOG_INFO("[checkpoint] resuming after seq {} (+{}), {} records applied",
+                             meta.last_seq, meta.seq_count, meta.applied);
+            } else {
+                fs.reset();
+                MBO_LOG_WARN("[checkpoint] ignoring {}: {} (cold start)", cfg.checkpoint_path, err);
+            }
+        }
+    }
+
+    // ---- Event journal: roll the book forward over what was journaled after
+    // the checkpoint (the whole journal without one), then append from there ----
+    if (!cfg.journal_dir.empty()) {
+        if (cfg.journal_recover && cfg.feed_resume) {
+            if (journal_from == mbo::CheckpointMeta::kNoJournalIndex) {
+                MBO_LOG_WARN("[journal] checkpoint has no journal index, not replaying {}", cfg.journal_dir);
+            } else {
+                recover_from_journal(cfg.journal_dir, fs, journal_from);
+            }
+        }
+
+        mbo::EventJournalOptions jo;
+        jo.dir = cfg.journal_dir;
+        jo.segment_records = std::max<size_t>(1, ((size_t)cfg.journal_segment_mb << 20) / sizeof(mbo::MboRecord));
+        jo.sync_on_rotate = cfg.journal_sync;
+        fs.journal = std::make_unique<mbo::EventJournal>();
+        std::string err;
+        if (fs.journal->open(jo, err)) {
+            place_helper_thread("mbo-journal", cfg.writer_cpus, fs.journal->native_handle());
+            MBO_LOG_INFO("[journal] appending to {} from index {} ({} records per segment)",
+                         cfg.journal_dir, fs.journal->next_index(), jo.segment_records);
+        } else {
+            MBO_LOG_WARN("[journal] disabled: {}", err);
+            fs.journal.reset();
+            if (cfg.checkpoint_path.empty()) fs.ckpt.reset();   // history only: nothing to write
+        }
+    }
+
+    // ---- As-of queries over the journal + checkpoint history (GET /asof,
+    // WS {"type":"asof"}), answered on their own thread ----
+    std::unique_ptr<mbo::AsOfService> asof;
+    if (fs.journal && cfg.asof) {
+        asof = std::make_unique<mbo::AsOfService>(cfg.journal_dir);
+        place_helper_thread("mbo-asof", cfg.writer_cpus, asof->native_handle());
+        mbo::set_asof_service(asof.get());
+        MBO_LOG_INFO("[asof] serving book-at-time queries from {} ({} history checkpoints every {} s)",
+                     cfg.journal_dir, cfg.checkpoint_keep, cfg.checkpoint_interval_s);
+    }
+
+    // Main loop: wait for streamer forever (retry connect),
+    // or until MAX_SESSIONS sessions have completed. A session that dropped
+    // mid-feed is resumed (not counted) and retried with a short backoff.
+    int sessions_done = 0;
+    int retry_ms = 0;
+    while (cfg.max_sessions <= 0 || sessions_done < cfg.max_sessions) {
         try {
-            std::cerr << "[tcp_main] waiting for feed " << cfg.host << ":" << cfg.port << " ...\n";
+            MBO_LOG_INFO("[tcp_main] waiting for feed {}:{} ...", cfg.host, cfg.port);
             run_one_replay_session(
                 cfg,
                 pg.get(),
                 q_mtx, q_cv, q, max_q,
-                bench_ptr
+                bench_ptr,
+                fs
             );
+            retry_ms = 0;
+            if (!fs.resumable()) sessions_done++;
         } catch (const std::exception& e) {
-            std::cerr << "[tcp_main] connect/session failed: " << e.what()
-                      << " (retry in 2000ms)\n";
-            std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+            retry_ms = fs.resumable() ? std::min(retry_ms > 0 ? retry_ms * 2 : 10, 2000) : 2000;
+            MBO_LOG_WARN("[tcp_main] connect/session failed: {} (retry in {}ms)", e.what(), retry_ms);
+            std::this_thread::sleep_for(std::chrono::milliseconds(retry_ms));
         }
     }
 
-    // unreachable normally
+    MBO_LOG_INFO("[tcp_main] {} session(s) done, exiting", sessions_done);
+    if (fs.ckpt && fs.ckpt->wait() == mbo::CheckpointForker::Reap::Failed) {
+        MBO_LOG_WARN("[checkpoint] last checkpoint failed");
+    }
     stop.store(true);
     q_cv.notify_all();
     if (pg_thread.joinable()) pg_thread.join();
+    // as-of queries still queued are answered ("shutting down") through the
+    // WS / metrics executors, so stop the service while those still run
+    mbo::set_asof_service(nullptr);
+    asof.reset();
     ws_ioc.stop();
     if (ws_thread.joinable()) ws_thread.join();
+    metrics_ioc.stop();
+    if (metrics_thread.joinable()) metrics_thread.join();
+    mbo::log_shutdown();
     return 0;
 }
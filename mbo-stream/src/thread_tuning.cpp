@@ -0,0 +1,138 @@
+#include "mbo/thread_tuning.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+
+namespace mbo {
+
+namespace {
+
+// process default placement (capture_default_placement)
+bool g_default_captured = false;
+cpu_set_t g_default_cpus;
+int g_default_policy = SCHED_OTHER;
+sched_param g_default_param{};
+
+} // namespace
+
+bool parse_cpu_list(const std::string& s, std::vector<int>& out) {
+    out.clear();
+    size_t i = 0;
+    auto number = [&](int& v) {
+        if (i >= s.size() || s[i] < '0' || s[i] > '9') return false;
+        v = 0;
+        while (i < s.size() && s[i] >= '0' && s[i] <= '9') {
+            v = v * 10 + (s[i++] - '0');
+            if (v >= CPU_SETSIZE) return false;
+        }
+        return true;
+    };
+    while (i < s.size()) {
+        if (s[i] == ' ' || s[i] == ',') { ++i; continue; }
+        int lo = 0, hi = 0;
+        if (!number(lo)) return false;
+        hi = lo;
+        if (i < s.size() && s[i] == '-') {
+            ++i;
+            if (!number(hi) || hi < lo) return false;
+        }
+        for (int c = lo; c <= hi; ++c) out.push_back(c);
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return true;
+}
+
+std::string format_cpu_list(const std::vector<int>& cpus) {
+    std::string s;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (!s.empty()) s += ',';
+        s += std::to_string(cpus[i]);
+        if (j > i) s += '-' + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return s;
+}
+
+bool pin_thread(pthread_t t, const std::vector<int>& cpus, std::string& err) {
+    if (cpus.empty()) return true;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) CPU_SET(c, &set);
+    const int rc = pthread_setaffinity_np(t, sizeof set, &set);
+    if (rc != 0) {
+        err = std::string("pthread_setaffinity_np: ") + std::strerror(rc);
+        return false;
+    }
+    return true;
+}
+
+bool set_current_thread_fifo(int priority, std::string& err) {
+    if (priority <= 0) return true;
+    const int lo = sched_get_priority_min(SCHED_FIFO);
+    const int hi = sched_get_priority_max(SCHED_FIFO);
+    sched_param sp{};
+    sp.sched_priority = std::clamp(priority, lo, hi);
+    const int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    if (rc != 0) {
+        err = std::string("pthread_setschedparam(SCHED_FIFO): ") + std::strerror(rc);
+        return false;
+    }
+    return true;
+}
+
+void capture_default_placement() {
+    CPU_ZERO(&g_default_cpus);
+    if (pthread_getaffinity_np(pthread_self(), sizeof g_default_cpus, &g_default_cpus) != 0) return;
+    if (pthread_getschedparam(pthread_self(), &g_default_policy, &g_default_param) != 0) return;
+    g_default_captured = true;
+}
+
+bool restore_default_placement(pthread_t t, std::string& err) {
+    if (!g_default_captured) return true;
+    int rc = pthread_setaffinity_np(t, sizeof g_default_cpus, &g_default_cpus);
+    if (rc != 0) {
+        err = std::string("pthread_setaffinity_np: ") + std::strerror(rc);
+        return false;
+    }
+    rc = pthread_setschedparam(t, g_default_policy, &g_default_param);
+    if (rc != 0) {
+        err = std::string("pthread_setschedparam: ") + std::strerror(rc);
+        return false;
+    }
+    return true;
+}
+
+void restore_default_placement_self() {
+    if (!g_default_captured) return;
+    (void)sched_setaffinity(0, sizeof g_default_cpus, &g_default_cpus);
+    (void)sched_setscheduler(0, g_default_policy, &g_default_param);
+}
+
+bool enable_socket_busy_poll(int fd, int usec, std::string& err) {
+    if (usec <= 0) return true;
+    if (::setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof usec) != 0) {
+        err = std::string("setsockopt(SO_BUSY_POLL): ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void name_current_thread(const char* name) {
+    char buf[16];
+    std::strncpy(buf, name, sizeof buf - 1);
+    buf[sizeof buf - 1] = '\0';
+    pthread_setname_np(pthread_self(), buf);
+}
+
+} // namespace mbo
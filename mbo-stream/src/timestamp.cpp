@@ -0,0 +1,122 @@
+#include "mbo/timestamp.hpp"
+
+namespace mbo {
+
+// days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant's algorithm)
+static inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+static inline void civil_from_days(int64_t z, int64_t& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    y = (int64_t)yoe + era * 400;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp + (mp < 10 ? 3 : -9);
+    y += (m <= 2);
+}
+
+static inline bool digits(std::string_view s, std::size_t pos, std::size_t n, int64_t& out) {
+    if (pos + n > s.size()) return false;
+    int64_t v = 0;
+    for (std::size_t i = pos; i < pos + n; ++i) {
+        const char c = s[i];
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + (c - '0');
+    }
+    out = v;
+    return true;
+}
+
+bool parse_iso8601_ns(std::string_view s, int64_t& out_ns) {
+    // 0123456789012345678
+    // YYYY-MM-DDTHH:MM:SS
+    if (s.size() < 19) return false;
+    if (s[4] != '-' || s[7] != '-' || (s[10] != 'T' && s[10] != ' ') ||
+        s[13] != ':' || s[16] != ':') {
+        return false;
+    }
+
+    int64_t Y, M, D, h, m, sec;
+    if (!digits(s, 0, 4, Y) || !digits(s, 5, 2, M) || !digits(s, 8, 2, D) ||
+        !digits(s, 11, 2, h) || !digits(s, 14, 2, m) || !digits(s, 17, 2, sec)) {
+        return false;
+    }
+    if (M < 1 || M > 12 || D < 1 || D > 31 || h > 23 || m > 59 || sec > 60) return false;
+
+    int64_t frac = 0;
+    std::size_t i = 19;
+    if (i < s.size() && s[i] == '.') {
+        ++i;
+        int nd = 0;
+        while (i < s.size() && s[i] >= '0' && s[i] <= '9') {
+            if (nd < 9) { frac = frac * 10 + (s[i] - '0'); ++nd; }
+            ++i;
+        }
+        if (nd == 0) return false;
+        for (; nd < 9; ++nd) frac *= 10;
+    }
+
+    const int64_t days = days_from_civil(Y, (unsigned)M, (unsigned)D);
+    out_ns = ((days * 86400 + h * 3600 + m * 60 + sec) * 1'000'000'000LL) + frac;
+    return true;
+}
+
+static inline void put2(char* p, unsigned v) {
+    p[0] = (char)('0' + v / 10);
+    p[1] = (char)('0' + v % 10);
+}
+
+std::size_t format_iso8601_ns(int64_t ns, char* out) {
+    int64_t secs = ns / 1'000'000'000LL;
+    int64_t frac = ns % 1'000'000'000LL;
+    if (frac < 0) { frac += 1'000'000'000LL; secs -= 1; }
+
+    int64_t days = secs / 86400;
+    int64_t rem = secs % 86400;
+    if (rem < 0) { rem += 86400; days -= 1; }
+
+    int64_t y;
+    unsigned mo, d;
+    civil_from_days(days, y, mo, d);
+
+    const unsigned yy = (unsigned)(y < 0 ? 0 : (y > 9999 ? 9999 : y));
+    out[0] = (char)('0' + yy / 1000);
+    out[1] = (char)('0' + (yy / 100) % 10);
+    out[2] = (char)('0' + (yy / 10) % 10);
+    out[3] = (char)('0' + yy % 10);
+    out[4] = '-';
+    put2(out + 5, mo);
+    out[7] = '-';
+    put2(out + 8, d);
+    out[10] = 'T';
+    put2(out + 11, (unsigned)(rem / 3600));
+    out[13] = ':';
+    put2(out + 14, (unsigned)((rem / 60) % 60));
+    out[16] = ':';
+    put2(out + 17, (unsigned)(rem % 60));
+    out[19] = '.';
+    for (int k = 28; k >= 20; --k) {
+        out[k] = (char)('0' + frac % 10);
+        frac /= 10;
+    }
+    out[29] = 'Z';
+    return kIsoNsLen;
+}
+
+std::string iso8601_ns(int64_t ns) {
+    char buf[kIsoNsLen];
+    format_iso8601_ns(ns, buf);
+    return std::string(buf, kIsoNsLen);
+}
+
+} // namespace mbo
@@ -0,0 +1,113 @@
+#include "mbo/work_stealing_pool.hpp"
+#include "mbo/thread_tuning.hpp"
+
+#include <algorithm>
+
+namespace mbo {
+
+namespace {
+thread_local const WorkStealingPool* tl_pool = nullptr;
+thread_local int tl_worker = -1;
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned threads, const std::string& name) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    workers_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) workers_.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_[i]->thread = std::thread([this, i, n = name + "-" + std::to_string(i)] { run_(i, n); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lk(idle_m_);
+        stop_ = true;
+    }
+    idle_cv_.notify_all();
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+int WorkStealingPool::current_worker() const { return tl_pool == this ? tl_worker : -1; }
+
+void WorkStealingPool::submit(Task t) {
+    {
+        std::lock_guard<std::mutex> lk(idle_m_);
+        ++pending_;   // before the push: a worker may run it right away
+    }
+    const int self = current_worker();
+    const unsigned target = self >= 0 ? (unsigned)self : next_.fetch_add(1, std::memory_order_relaxed) % size();
+    {
+        std::lock_guard<std::mutex> lk(workers_[target]->m);
+        workers_[target]->q.push_back(std::move(t));
+    }
+    {
+        std::lock_guard<std::mutex> lk(idle_m_);
+        queued_.fetch_add(1, std::memory_order_relaxed);
+    }
+    idle_cv_.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lk(idle_m_);
+    done_cv_.wait(lk, [&] { return pending_ == 0; });
+    if (error_) {
+        std::exception_ptr e = error_;
+        error_ = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+bool WorkStealingPool::pop_local_(unsigned self, Task& out) {
+    Worker& w = *workers_[self];
+    std::lock_guard<std::mutex> lk(w.m);
+    if (w.q.empty()) return false;
+    out = std::move(w.q.back());
+    w.q.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal_(unsigned self, Task& out) {
+    const unsigned n = size();
+    for (unsigned k = 1; k < n; ++k) {
+        Worker& w = *workers_[(self + k) % n];
+        std::lock_guard<std::mutex> lk(w.m);
+        if (w.q.empty()) continue;
+        out = std::move(w.q.front());
+        w.q.pop_front();
+        steal_total_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::run_(unsigned self, std::string name) {
+    tl_pool = this;
+    tl_worker = (int)self;
+    name_current_thread(name.c_str());
+
+    for (;;) {
+        Task t;
+        if (pop_local_(self, t) || steal_(self, t)) {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            try {
+                t();
+            } catch (...) {
+                std::lock_guard<std::mutex> lk(idle_m_);
+                if (!error_) error_ = std::current_exception();
+            }
+            t = nullptr;   // release captures before reporting done
+            run_total_.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lk(idle_m_);
+            if (--pending_ == 0) done_cv_.notify_all();
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(idle_m_);
+        idle_cv_.wait(lk, [&] { return stop_ || queued_.load(std::memory_order_relaxed) > 0; });
+        if (stop_ && queued_.load(std::memory_order_relaxed) <= 0) return;
+    }
+}
+
+} // namespace mbo
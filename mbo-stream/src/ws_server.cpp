@@ -1,10 +1,13 @@
 #include "mbo/ws_server.hpp"
+#include "mbo/as_of.hpp"
 #include "mbo/snapshot_store.hpp"
+#include "mbo/metrics.hpp"
 
 #include <boost/beast.hpp>
 #include <boost/beast/websocket.hpp>
 
 #include <chrono>
+#include <deque>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -21,6 +24,10 @@ public:
         , timer_(ioc)
         , push_ms_(default_push_ms) {}
 
+    ~WsSession() {
+        if (accepted_) mbo::metrics().ws_sessions_active.fetch_sub(1, std::memory_order_relaxed);
+    }
+
     void run() {
         ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
         ws_.set_option(websocket::stream_base::decorator(
@@ -46,13 +53,17 @@ private:
     // ---- Data plane bookkeeping ----
     beast::flat_buffer read_buf_;
     std::shared_ptr<const std::string> last_sent_;
+    std::shared_ptr<const std::string> pending_ack_;  // sent once no write is in flight
+    std::deque<std::shared_ptr<const std::string>> replies_;  // as-of answers, same rule
     bool write_in_flight_ = false;
+    bool accepted_ = false;
 
     // ---------------- Minimal JSON-lite parsing ----------------
     // We only need: type (string), symbol (string), depth (int), push_ms (int)
     // Example payloads:
     // {"type":"subscribe","symbol":"CLX5","depth":10,"push_ms":50}
     // {"type":"update","depth":20}
+    // {"type":"asof","ts":"2025-09-24T19:30:05.123Z","depth":20}   (one-off reply)
     static void skip_ws(const std::string& s, size_t& i) {
         while (i < s.size() && std::isspace(static_cast<unsigned char>(s[i]))) ++i;
     }
@@ -150,6 +161,11 @@ private:
     void on_accept(beast::error_code ec) {
         if (ec) return;
 
+        accepted_ = true;
+        auto& m = mbo::metrics();
+        m.ws_sessions_active.fetch_add(1, std::memory_order_relaxed);
+        m.ws_sessions_total.fetch_add(1, std::memory_order_relaxed);
+
         // Start reading control messages (subscribe/update)
         do_read();
 
@@ -179,26 +195,74 @@ private:
         read_buf_.consume(read_buf_.size());
 
         std::string type;
-        if (parse_control_message(msg, type)) {
+        if (parse_string_value_after_key(msg, "type", type) && type == "asof") {
+            handle_asof(msg);
+        } else if (parse_control_message(msg, type)) {
             // Optional debug:
             // std::cerr << "[WS] " << type << " symbol=" << symbol_
             //           << " depth=" << depth_ << " push_ms=" << push_ms_ << "\n";
 
-            // Send ack (fire-and-forget; does not block snapshot loop)
-            auto ack_str = std::make_shared<std::string>(make_ack_json(symbol_, depth_, push_ms_));
-            ws_.text(true);
-            ws_.async_write(
-                boost::asio::buffer(*ack_str),
-                [self = shared_from_this(), ack_str](beast::error_code, std::size_t) {
-                    // ignore errors for MVP
-                }
-            );
+            // Send ack (does not block snapshot loop). Beast allows one write at a
+            // time, so if a snapshot is in flight the ack goes out after it.
+            pending_ack_ = std::make_shared<const std::string>(make_ack_json(symbol_, depth_, push_ms_));
+            if (!write_in_flight_) flush_ack();
         }
 
         // keep reading
         do_read();
     }
 
+    // As-of query: runs on the as-of service thread; the reply comes back on
+    // this session's strand and is queued like an ack. Snapshots keep flowing.
+    void handle_asof(const std::string& msg) {
+        auto* svc = mbo::asof_service();
+        std::string ts_s;
+        int64_t ts_ns = 0;
+        int depth = depth_;
+        if (!svc) {
+            queue_reply(mbo::asof_error_json("as-of queries need JOURNAL_DIR (and ASOF=1)"));
+            return;
+        }
+        if (!parse_string_value_after_key(msg, "ts", ts_s) || !mbo::parse_asof_time(ts_s, ts_ns)) {
+            queue_reply(mbo::asof_error_json("ts must be ISO-8601 (2025-09-24T19:30:00.123Z) or epoch ns"));
+            return;
+        }
+        int d = 0;
+        if (parse_int_value_after_key(msg, "depth", d) && d > 0 && d <= 10000) depth = d;
+
+        svc->submit(ts_ns, depth, [self = shared_from_this()](bool, std::string json) {
+            boost::asio::post(self->ws_.get_executor(), [self, json = std::move(json)]() mutable {
+                self->queue_reply(std::move(json));
+            });
+        });
+    }
+
+    void queue_reply(std::string json) {
+        replies_.push_back(std::make_shared<const std::string>(std::move(json)));
+        if (!write_in_flight_) flush_ack();
+    }
+
+    // sends the pending ack, else the oldest queued reply
+    void flush_ack() {
+        std::shared_ptr<const std::string> ack_str;
+        if (pending_ack_) {
+            ack_str = std::move(pending_ack_);
+        } else {
+            ack_str = std::move(replies_.front());
+            replies_.pop_front();
+        }
+        write_in_flight_ = true;
+        ws_.text(true);
+        ws_.async_write(
+            boost::asio::buffer(*ack_str),
+            [self = shared_from_this(), ack_str](beast::error_code ec, std::size_t) {
+                self->write_in_flight_ = false;
+                if (!ec && (self->pending_ack_ || !self->replies_.empty())) self->flush_ack();
+                // errors ignored for MVP; the snapshot loop notices a dead socket
+            }
+        );
+    }
+
     // ---------------- Data plane: push snapshots ----------------
     void schedule_send_now() {
         timer_.expires_after(std::chrono::milliseconds(0));
@@ -214,7 +278,9 @@ private:
         if (ec) return;
 
         // Backpressure: if last async_write not finished, skip this tick
+        // (conflation: the next frame will carry the latest book instead)
         if (write_in_flight_) {
+            mbo::metrics().ws_conflations_total.fetch_add(1, std::memory_order_relaxed);
             schedule_next();
             return;
         }
@@ -242,9 +308,16 @@ private:
         );
     }
 
-    void on_write(beast::error_code ec, std::size_t) {
+    void on_write(beast::error_code ec, std::size_t bytes) {
         write_in_flight_ = false;
-        if (ec) return;
+        auto& m = mbo::metrics();
+        if (ec) {
+            m.ws_write_errors_total.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        m.ws_frames_total.fetch_add(1, std::memory_order_relaxed);
+        m.ws_bytes_total.fetch_add(bytes, std::memory_order_relaxed);
+        if (pending_ack_ || !replies_.empty()) flush_ack();
         schedule_next();
     }
 };
@@ -0,0 +1,106 @@
+#include "line_index.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <string_view>
+
+template <typename T>
+static bool parse_num(const char* b, const char* e, T& out) {
+    if (b == e) return false;
+    return std::from_chars(b, e, out).ec == std::errc{};
+}
+
+// what std::stod accepts (the engine parses the price with it)
+static bool parse_price(const char* b, const char* e) {
+    if (b == e) return false;
+    const std::string px(b, e);
+    char* stop = nullptr;
+    errno = 0;
+    std::strtod(px.c_str(), &stop);
+    return stop != px.c_str() && errno != ERANGE;
+}
+
+// The rules of the engine's parse_mbo_csv_line (mbo-stream/src/csv_parser.cpp)
+// and the header skip in its handle_line, field for field: a line counts
+// towards the resume position exactly when the engine applies it. Keep the
+// two in sync.
+bool LineIndex::record_seq(const std::string& line, uint64_t& seq) const {
+    const char* p = line.data();
+    const char* end = p + line.size();
+    if (p != end && end[-1] == '\r') --end;
+    if (p == end) return false;
+    const std::string_view s(p, (size_t)(end - p));
+    for (const char* hdr : {"ts_recv,", "ts_event", "publisher_id", "instrument_id"}) {
+        if (s.rfind(hdr, 0) == 0) return false;
+    }
+
+    // field boundaries of the first 15 columns (the engine needs at least 15)
+    const char* f[16];
+    int nf = 0;
+    f[nf++] = p;
+    for (; p != end && nf < 16; ++p) {
+        if (*p == ',') f[nf++] = p + 1;
+    }
+    if (nf < 15) return false;
+    auto fe = [&](int i) { return i + 1 < nf ? f[i + 1] - 1 : end; };
+
+    // the columns the engine rejects a line over
+    int32_t i32;
+    int64_t i64;
+    uint32_t u32;
+    if (!parse_num(f[3], fe(3), i32) || !parse_num(f[4], fe(4), i32) || !parse_num(f[8], fe(8), i32) ||
+        !parse_num(f[10], fe(10), i64) || !parse_num(f[11], fe(11), u32) || !parse_price(f[7], fe(7))) {
+        return false;
+    }
+
+    // an unparsable sequence is applied as 0
+    seq = 0;
+    if (seq_col_ >= nf || !parse_num(f[seq_col_], fe(seq_col_), seq)) seq = 0;
+    return true;
+}
+
+void LineIndex::observe(std::streamoff offset, uint64_t line_no, const std::string& line) {
+    if (line_no < next_sample_) return;
+    uint64_t seq = 0;
+    if (!record_seq(line, seq)) return;   // try the next line
+    if (!entries_.empty() && seq < entries_.back().seq) seq = entries_.back().seq;
+    entries_.push_back(Entry{offset, line_no, seq});
+    next_sample_ = line_no + every_;
+}
+
+LineIndex::Position LineIndex::seek(std::istream& in, std::streamoff data_start, uint64_t seq,
+                                    uint64_t count) const {
+    // last entry strictly before seq: every record with seq comes after it
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), seq,
+                               [](const Entry& e, uint64_t s) { return e.seq < s; });
+    Position pos;
+    pos.offset = data_start;
+    if (it != entries_.begin()) {
+        --it;
+        pos.offset = it->offset;
+        pos.line_no = it->line_no;
+    }
+
+    in.clear();
+    in.seekg(pos.offset);
+    std::string line;
+    uint64_t same = 0;
+    while (std::getline(in, line)) {
+        const std::streamoff next = pos.offset + (std::streamoff)line.size() + 1;
+        uint64_t s = 0;
+        if (record_seq(line, s) && s >= seq) {
+            if (s > seq) break;
+            pos.exact = true;
+            if (same == count) break;
+            ++same;
+        }
+        pos.offset = next;
+        ++pos.line_no;
+    }
+    pos.eof = !in;
+    in.clear();
+    in.seekg(pos.offset);
+    return pos;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+// Sparse resume index over the CSV, filled in as lines are streamed, used to
+// resume a session where the engine left off.
+//
+// Every `every`-th data line records (byte offset, line number, sequence);
+// a resume seeks to the last entry before the target sequence and scans at
+// most a few thousand lines from there, so reconnects cost milliseconds and
+// memory is ~24 bytes per `every` lines.
+//
+// The venue `sequence` column is non-decreasing but not unique (several
+// records can share one), so a resume position is (last sequence applied,
+// records with that sequence already applied): the next record is the one
+// after the count-th record with that sequence. Lines the engine would not
+// apply (header, too few fields, non-numeric ids / sizes / price) are not
+// counted; a non-numeric sequence counts as 0, as in the engine.
+class LineIndex {
+public:
+    explicit LineIndex(uint64_t every = 4096, int seq_col = 13) : every_(every ? every : 1), seq_col_(seq_col) {}
+
+    // Data line `line_no` (0-based, header excluded) starting at byte
+    // `offset` was read. Lines are observed in file order; repeats after a
+    // rewind are ignored.
+    void observe(std::streamoff offset, uint64_t line_no, const std::string& line);
+
+    struct Position {
+        std::streamoff offset = 0;   // next line to send
+        uint64_t line_no = 0;
+        bool exact = false;          // the sequence is present in the file
+        bool eof = false;            // the position is past the last record
+    };
+
+    // Positions `in` at the record after (seq, count). `data_start` is the
+    // offset of the first data line. Scans forward from the nearest entry, so
+    // it also works past the part streamed so far (only slower).
+    Position seek(std::istream& in, std::streamoff data_start, uint64_t seq, uint64_t count) const;
+
+    size_t entries() const { return entries_.size(); }
+
+    // Sequence of a line the engine would apply; false otherwise.
+    bool record_seq(const std::string& line, uint64_t& seq) const;
+
+private:
+    struct Entry {
+        std::streamoff offset;
+        uint64_t line_no;
+        uint64_t seq;
+    };
+    std::vector<Entry> entries_;
+    uint64_t every_;
+    int seq_col_;
+    uint64_t next_sample_ = 0;   // line number of the next line to record
+};
@@ -0,0 +1,190 @@
+#include "load_profile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+static std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+static std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string tok;
+    while (std::getline(ss, tok, sep)) out.push_back(trim(tok));
+    return out;
+}
+
+// "50000", "50k", "2M", "2.5M"
+static double parse_rate(const std::string& s) {
+    if (s.empty()) throw std::runtime_error("empty rate");
+    size_t used = 0;
+    double v = std::stod(s, &used);
+    std::string suf = s.substr(used);
+    if (suf == "k" || suf == "K") v *= 1e3;
+    else if (suf == "M" || suf == "m") v *= 1e6;
+    else if (!suf.empty()) throw std::runtime_error("bad rate suffix: " + s);
+    if (v < 0) throw std::runtime_error("negative rate: " + s);
+    return v;
+}
+
+// "20ms", "5s", "1m", "150us" -> seconds (bare numbers are seconds)
+static double parse_dur(const std::string& s) {
+    if (s.empty()) throw std::runtime_error("empty duration");
+    size_t used = 0;
+    double v = std::stod(s, &used);
+    std::string suf = s.substr(used);
+    if (suf.empty() || suf == "s") return v;
+    if (suf == "ms") return v * 1e-3;
+    if (suf == "us") return v * 1e-6;
+    if (suf == "ns") return v * 1e-9;
+    if (suf == "m") return v * 60.0;
+    throw std::runtime_error("bad duration suffix: " + s);
+}
+
+LoadProfile LoadProfile::parse(const std::string& spec_in, double default_rate) {
+    std::string spec = spec_in;
+    if (!spec.empty() && spec[0] == '@') {
+        std::ifstream fin(spec.substr(1));
+        if (!fin) throw std::runtime_error("cannot open profile file: " + spec.substr(1));
+        std::string line, joined;
+        while (std::getline(fin, line)) {
+            auto hash = line.find('#');
+            if (hash != std::string::npos) line.resize(hash);
+            line = trim(line);
+            if (!line.empty()) joined += line + ";";
+        }
+        spec = joined;
+    }
+
+    LoadProfile p;
+    p.default_rate_ = default_rate;
+
+    for (const auto& item : split(spec, ';')) {
+        if (item.empty()) continue;
+        auto f = split(item, ':');
+        const std::string& kind = f[0];
+
+        if (kind == "const" && f.size() == 3) {
+            Phase ph;
+            ph.kind = Phase::Const;
+            ph.a = parse_rate(f[1]);
+            ph.dur = parse_dur(f[2]);
+            p.phases_.push_back(ph);
+        } else if (kind == "ramp" && f.size() == 4) {
+            Phase ph;
+            ph.kind = Phase::Ramp;
+            ph.a = parse_rate(f[1]);
+            ph.b = parse_rate(f[2]);
+            ph.dur = parse_dur(f[3]);
+            p.phases_.push_back(ph);
+        } else if (kind == "square" && f.size() == 6) {
+            Phase ph;
+            ph.kind = Phase::Square;
+            ph.a = parse_rate(f[1]);
+            ph.b = parse_rate(f[2]);
+            ph.period = parse_dur(f[3]);
+            ph.duty = std::stod(f[4]);
+            ph.dur = parse_dur(f[5]);
+            if (ph.period <= 0 || ph.duty < 0 || ph.duty > 1) {
+                throw std::runtime_error("bad square wave: " + item);
+            }
+            p.phases_.push_back(ph);
+        } else if (kind == "burst" && f.size() == 3) {
+            // burst:RATE:LEN@EVERY[+OFF]
+            Burst b;
+            b.rate = parse_rate(f[1]);
+            auto at = f[2].find('@');
+            if (at == std::string::npos) throw std::runtime_error("burst needs LEN@EVERY: " + item);
+            b.len = parse_dur(f[2].substr(0, at));
+            std::string every = f[2].substr(at + 1);
+            auto plus = every.find('+');
+            if (plus != std::string::npos) {
+                b.offset = parse_dur(every.substr(plus + 1));
+                every.resize(plus);
+            }
+            b.every = parse_dur(every);
+            if (b.every <= 0 || b.len <= 0 || b.len > b.every) {
+                throw std::runtime_error("bad burst timing: " + item);
+            }
+            p.bursts_.push_back(b);
+        } else {
+            throw std::runtime_error("bad profile item: " + item);
+        }
+    }
+
+    for (const auto& ph : p.phases_) {
+        if (ph.dur <= 0) throw std::runtime_error("phase duration must be > 0");
+        p.cycle_ += ph.dur;
+    }
+    return p;
+}
+
+double LoadProfile::rate_at(double t) const {
+    double r = default_rate_;
+
+    if (!phases_.empty()) {
+        double u = std::fmod(t, cycle_);
+        for (const auto& ph : phases_) {
+            if (u < ph.dur) {
+                switch (ph.kind) {
+                    case Phase::Const:
+                        r = ph.a;
+                        break;
+                    case Phase::Ramp:
+                        r = ph.a + (ph.b - ph.a) * (u / ph.dur);
+                        break;
+                    case Phase::Square:
+                        r = (std::fmod(u, ph.period) < ph.duty * ph.period) ? ph.a : ph.b;
+                        break;
+                }
+                break;
+            }
+            u -= ph.dur;
+        }
+    }
+
+    // overlays: the highest active burst wins
+    for (const auto& b : bursts_) {
+        if (t < b.offset) continue;
+        if (std::fmod(t - b.offset, b.every) < b.len) r = std::max(r, b.rate);
+    }
+    return r;
+}
+
+double LoadProfile::integral(double t0, double t1) const {
+    if (t1 <= t0) return 0.0;
+    constexpr double kStep = 50e-6;
+    double sum = 0.0;
+    for (double t = t0; t < t1; t += kStep) {
+        const double dt = std::min(kStep, t1 - t);
+        sum += rate_at(t + 0.5 * dt) * dt;
+    }
+    return sum;
+}
+
+std::string LoadProfile::describe() const {
+    std::ostringstream oss;
+    if (phases_.empty()) oss << "const " << default_rate_ << "/s";
+    for (size_t i = 0; i < phases_.size(); ++i) {
+        const auto& ph = phases_[i];
+        if (i) oss << " -> ";
+        switch (ph.kind) {
+            case Phase::Const:  oss << "const " << ph.a << "/s for " << ph.dur << "s"; break;
+            case Phase::Ramp:   oss << "ramp " << ph.a << "->" << ph.b << "/s over " << ph.dur << "s"; break;
+            case Phase::Square: oss << "square " << ph.a << "/" << ph.b << "/s period " << ph.period
+                                    << "s duty " << ph.duty << " for " << ph.dur << "s"; break;
+        }
+    }
+    if (!phases_.empty()) oss << " (repeating)";
+    for (const auto& b : bursts_) {
+        oss << " + burst " << b.rate << "/s for " << b.len * 1e3 << "ms every " << b.every << "s";
+    }
+    return oss.str();
+}
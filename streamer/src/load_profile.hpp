@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Declarative send-rate profile for the streamer.
+//
+// A profile is a ';'-separated list of items. Phases run one after another and
+// the sequence repeats; overlays apply on top of whatever phase is active.
+//
+//   const:RATE:DUR                 constant rate for DUR
+//   ramp:FROM:TO:DUR               linear ramp FROM -> TO over DUR
+//   square:HI:LO:PERIOD:DUTY:DUR   square wave (DUTY in 0..1 at HI), for DUR
+//   burst:RATE:LEN@EVERY[+OFF]     overlay: RATE for LEN every EVERY (optionally offset)
+//
+// RATE accepts k/M suffixes (msgs/s), durations accept ns/us/ms/s/m.
+// Example: "const:50k:60s;burst:2M:20ms@5s"
+// "@path" loads the profile from a file (one item per line, '#' comments).
+class LoadProfile {
+public:
+    // Throws std::runtime_error on malformed input.
+    static LoadProfile parse(const std::string& spec, double default_rate);
+
+    // Target rate (msgs/s) at t seconds since start.
+    double rate_at(double t) const;
+
+    // Messages due in [t0, t1) (numerically integrated, sub-steps of 50us).
+    double integral(double t0, double t1) const;
+
+    std::string describe() const;
+
+private:
+    struct Phase {
+        enum Kind { Const, Ramp, Square } kind = Const;
+        double a = 0, b = 0;          // rate / from,to / hi,lo
+        double period = 0, duty = 0;  // square only
+        double dur = 0;
+    };
+    struct Burst {
+        double rate = 0, len = 0, every = 0, offset = 0;
+    };
+
+    std::vector<Phase> phases_;
+    std::vector<Burst> bursts_;
+    double cycle_ = 0;
+    double default_rate_ = 0;
+};
@@ -1,20 +1,108 @@
 #include <boost/asio.hpp>
+#include <poll.h>
+#include <algorithm>
+#include <charconv>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
 #include <thread>
 #include <vector>
 
+#include "load_profile.hpp"
+#include "line_index.hpp"
+
 using boost::asio::ip::tcp;
 using SteadyClock = std::chrono::steady_clock;
+using SystemClock = std::chrono::system_clock;
+
+static inline int64_t now_wall_ns() {
+    return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        SystemClock::now().time_since_epoch()).count();
+}
+
+// Append one record; with STAMP_SEND=1 a 16th column carries the wall-clock
+// send time (ns) so the engine can measure wire -> apply -> publish -> client.
+static inline void append_line(std::string& out, const std::string& line, int64_t stamp_ns) {
+    out.append(line);
+    if (stamp_ns > 0) {
+        char buf[24];
+        buf[0] = ',';
+        auto r = std::to_chars(buf + 1, buf + sizeof(buf), stamp_ns);
+        out.append(buf, r.ptr);
+    }
+    out.push_back('\n');
+}
+
+// Session handshake. Right after connecting, the engine sends one line:
+//   HELLO                        fresh replay from the top of the file
+//   RESUME <seq> <count> [<run>] continue after the count-th record with venue
+//                                sequence <seq> (the last one it applied)
+// A client that sends nothing within the timeout gets a fresh replay. <run> is
+// the streamer run the engine was fed by; a RESUME for another run (this
+// process was restarted) gets a fresh replay too. Without <run> (the engine
+// warm-started from a checkpoint) the streamer resumes by sequence.
+//
+// The streamer answers with "#SESSION <run> FRESH|RESUMED" before the data,
+// so the engine knows whether to keep its book, and sends "#END" at the end
+// of the data so the engine can tell a finished replay from a dropped
+// connection.
+struct Handshake {
+    bool resume = false;
+    uint64_t seq = 0;
+    uint64_t count = 0;
+    std::string run;
+};
+
+static std::string make_run_id() {
+    std::random_device rd;
+    const uint64_t r = ((uint64_t)rd() << 32) ^ rd() ^
+                       (uint64_t)SteadyClock::now().time_since_epoch().count();
+    char buf[17];
+    std::snprintf(buf, sizeof buf, "%016llx", (unsigned long long)r);
+    return buf;
+}
+
+static bool read_handshake(tcp::socket& sock, int timeout_ms, Handshake& hs) {
+    std::string buf;
+    const auto deadline = SteadyClock::now() + std::chrono::milliseconds(timeout_ms);
+    while (buf.find('\n') == std::string::npos && buf.size() < 256) {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - SteadyClock::now()).count();
+        if (left <= 0) return false;
+        pollfd p{sock.native_handle(), POLLIN, 0};
+        if (::poll(&p, 1, (int)left) <= 0) return false;
+        char tmp[256];
+        boost::system::error_code ec;
+        const size_t n = sock.read_some(boost::asio::buffer(tmp, sizeof tmp), ec);
+        if (ec || n == 0) return false;
+        buf.append(tmp, n);
+    }
+    unsigned long long seq = 0, count = 0;
+    char run[64] = {};
+    if (std::sscanf(buf.c_str(), "RESUME %llu %llu %63s", &seq, &count, run) >= 2) {
+        hs.resume = true;
+        hs.seq = seq;
+        hs.count = count;
+        hs.run = run;
+    }
+    return true;
+}
 
 int main(int argc, char* argv[]) {
     // 1. Parameter check
     if (argc < 5) {
         std::cerr
             << "Usage: streamer <csv_path> <port> <rate_msgs_per_sec> <loop:0|1> [max_msgs]\n"
-            << "Example: streamer CLX5_mbo.csv 9000 500000 1\n";
+            << "Example: streamer CLX5_mbo.csv 9000 500000 1\n"
+            << "Env:\n"
+            << "  STREAM_PROFILE  load profile, e.g. \"const:50k:60s;burst:2M:20ms@5s\" or @file\n"
+            << "                  (rate arg is the baseline when the profile has no phases)\n"
+            << "  SEND_LOG_PATH   CSV log of every send batch (wall_ns,elapsed_ns,batch,sent_total,target_rate)\n"
+            << "  STAMP_SEND=1    append a ts_send_ns column (wall clock) to every line\n"
+            << "  RESUME=0        exit when the client drops instead of waiting for it to resume\n";
         return 1;
     }
 
@@ -24,6 +112,33 @@ int main(int argc, char* argv[]) {
     const bool loop = std::stoi(argv[4]) != 0;
     const long long max_msgs = (argc >= 6) ? std::stoll(argv[5]) : -1;
 
+    const char* profile_env = std::getenv("STREAM_PROFILE");
+    const bool use_profile = profile_env && *profile_env;
+    LoadProfile profile;
+    if (use_profile) {
+        try {
+            profile = LoadProfile::parse(profile_env, rate);
+        } catch (const std::exception& e) {
+            std::cerr << "[streamer] Bad STREAM_PROFILE: " << e.what() << "\n";
+            return 1;
+        }
+        std::cout << "[streamer] Load profile: " << profile.describe() << "\n";
+    }
+
+    const char* stamp_env = std::getenv("STAMP_SEND");
+    const bool stamp_send = stamp_env && std::string(stamp_env) == "1";
+    if (stamp_send) std::cout << "[streamer] Stamping ts_send_ns on every line\n";
+
+    std::ofstream send_log;
+    if (const char* p = std::getenv("SEND_LOG_PATH"); p && *p) {
+        send_log.open(p, std::ios::binary | std::ios::trunc);
+        if (!send_log) {
+            std::cerr << "[streamer] Failed to open SEND_LOG_PATH: " << p << "\n";
+            return 1;
+        }
+        send_log << "wall_ns,elapsed_ns,batch,sent_total,target_rate\n";
+    }
+
     // 2. Open file
     std::ifstream fin(csv_path);
     if (!fin) {
@@ -38,27 +153,198 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    const char* resume_env = std::getenv("RESUME");
+    const bool resume_enabled = !(resume_env && std::string(resume_env) == "0");
+    const std::string run_id = make_run_id();
+    const std::streamoff data_start = (std::streamoff)header.size() + 1;
+
     // 4. Start TCP server and wait for a client connection
     boost::asio::io_context io;
     tcp::acceptor acceptor(io, tcp::endpoint(tcp::v4(), port));
 
-    std::cout << "[streamer] Listening on port " << port << "...\n";
+    std::cout << "[streamer] Listening on port " << port << " (run " << run_id << ")...\n";
     tcp::socket sock(io);
-    acceptor.accept(sock);
 
-    // Enable TCP_NODELAY (disable Nagle) for lower-latency replay
-    sock.set_option(tcp::no_delay(true));
-    std::cout << "[streamer] Client connected.\n";
+    std::string line;
+    long long sent_total = 0;
+    auto last_log = SteadyClock::now();
+    LineIndex index;                       // filled in by next_line as lines go out
+    std::streamoff line_off = data_start;  // byte offset of the next line
+    uint64_t line_no = 0;                  // data lines read since the top of the file
+
+    auto rewind = [&]() {
+        fin.clear();
+        fin.seekg(0);
+        std::getline(fin, header);
+        line_off = data_start;
+        line_no = 0;
+    };
+
+    // Accept a client and position the file from its handshake.
+    auto accept_client = [&]() {
+        acceptor.accept(sock);
+
+        // Enable TCP_NODELAY (disable Nagle) for lower-latency replay
+        sock.set_option(tcp::no_delay(true));
+
+        Handshake hs;
+        read_handshake(sock, 500, hs);
+        bool resumed = false;
+        if (hs.resume && !hs.run.empty() && hs.run != run_id) {
+            std::cout << "[streamer] Client asked to resume run " << hs.run << ", this is run " << run_id
+                      << ": fresh replay\n";
+        } else if (hs.resume) {
+            const auto t0 = SteadyClock::now();
+            const LineIndex::Position p = index.seek(fin, data_start, hs.seq, hs.count);
+            line_off = p.offset;
+            line_no = p.line_no;
+            sent_total = (long long)p.line_no;
+            resumed = true;
+            std::cout << "[streamer] Client resumed after seq " << hs.seq << " (+" << hs.count << ") -> line "
+                      << p.line_no << (p.eof ? " (end of data)" : "")
+                      << (p.exact ? "" : " (sequence not in file, next one)") << " in "
+                      << std::chrono::duration<double, std::milli>(SteadyClock::now() - t0).count() << " ms\n";
+        }
+        if (!resumed) {
+            std::cout << "[streamer] Client connected.\n";
+            if (sent_total > 0 || line_no > 0) {
+                // fresh replay requested mid-file
+                rewind();
+                sent_total = 0;
+            }
+        }
+
+        const std::string hello = "#SESSION " + run_id + (resumed ? " RESUMED\n" : " FRESH\n");
+        boost::system::error_code ec;
+        boost::asio::write(sock, boost::asio::buffer(hello), ec);
+    };
+
+    // Write a batch. If the client is gone and RESUME is on, wait for it to
+    // reconnect instead: the batch is dropped (false) and the file position
+    // follows the new handshake.
+    auto send = [&](const std::string& buf) -> bool {
+        try {
+            boost::asio::write(sock, boost::asio::buffer(buf));
+            return true;
+        } catch (const std::exception& e) {
+            if (!resume_enabled) throw;
+            std::cout << "[streamer] Client lost (" << e.what() << "), waiting for it to resume...\n";
+            boost::system::error_code ec;
+            sock.close(ec);
+            accept_client();
+            return false;
+        }
+    };
+
+    accept_client();
 
     // Pre-allocate send buffer (8MB)
     std::string out;
     out.reserve(8 * 1024 * 1024);
 
-    std::string line;
-    long long sent_total = 0;
-    auto last_log = SteadyClock::now();
+    // Read the next data line, rewinding in loop mode. False on EOF / failure.
+    auto read_line = [&]() -> bool {
+        if (!std::getline(fin, line)) return false;
+        index.observe(line_off, line_no, line);
+        line_off += (std::streamoff)line.size() + 1;
+        ++line_no;
+        return true;
+    };
+    auto next_line = [&]() -> bool {
+        if (read_line()) return true;
+        if (!loop) {
+            std::cout << "[streamer] EOF reached.\n";
+            return false;
+        }
+        // Replay mode: rewind file and skip header again
+        rewind();
+        if (!read_line()) {
+            std::cerr << "[streamer] Replay failed (empty after rewind)\n";
+            return false;
+        }
+        return true;
+    };
+
+    // 5a. Profile mode: fine-grained pacing against the integrated target rate.
+    // Each iteration sends every message that has come due since the start
+    // (so bursts of 2M msg/s for 20ms really go out in ~20ms), then sleeps
+    // until the next message is due (at most 1ms, so rate changes are seen).
+    if (use_profile) {
+        constexpr long long kMaxBatch = 65536;
+        const auto t0 = SteadyClock::now();
+        double credit = 0.0;   // messages due but not yet sent
+        double t_prev = 0.0;
+        long long sent_at_log = 0;
+        double due_at_log = 0.0;
+        double due_total = 0.0;
+
+        try {
+            while (true) {
+                if (max_msgs >= 0 && sent_total >= max_msgs) goto done;
+
+                const auto now = SteadyClock::now();
+                const double t = std::chrono::duration<double>(now - t0).count();
+                const double due = profile.integral(t_prev, t);
+                credit += due;
+                due_total += due;
+                t_prev = t;
+
+                long long n = std::min<long long>((long long)credit, kMaxBatch);
+                if (max_msgs >= 0) n = std::min(n, max_msgs - sent_total);
 
-    // 5. Main loop
+                if (n <= 0) {
+                    const double r = profile.rate_at(t);
+                    double wait = (r > 0.0) ? (1.0 - credit) / r : 1e-3;
+                    wait = std::min(wait, 1e-3);
+                    if (wait > 100e-6) {
+                        std::this_thread::sleep_for(std::chrono::duration<double>(wait - 50e-6));
+                    } else {
+                        std::this_thread::yield();
+                    }
+                    continue;
+                }
+
+                out.clear();
+                long long batch = 0;
+                bool eof = false;
+                const int64_t stamp = stamp_send ? now_wall_ns() : 0;
+                while (batch < n) {
+                    if (!next_line()) { eof = true; break; }
+                    append_line(out, line, stamp);
+                    ++batch;
+                }
+                const bool delivered = out.empty() || send(out);
+                out.clear();
+                credit -= (double)batch;
+                if (!delivered) continue;   // resumed: position comes from the handshake
+                sent_total += batch;
+
+                if (send_log && batch > 0) {
+                    const auto wall_ns = now_wall_ns();
+                    const auto el_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        SteadyClock::now() - t0).count();
+                    send_log << wall_ns << ',' << el_ns << ',' << batch << ','
+                             << sent_total << ',' << (long long)profile.rate_at(t) << '\n';
+                }
+                if (eof) goto done;
+
+                if (std::chrono::duration_cast<std::chrono::milliseconds>(now - last_log).count() >= 1000) {
+                    std::cout << "[streamer] sent_total=" << sent_total
+                              << " last_window=" << (sent_total - sent_at_log)
+                              << " (target " << (long long)(due_total - due_at_log)
+                              << ", backlog " << (long long)credit << ")\n";
+                    last_log = now;
+                    sent_at_log = sent_total;
+                    due_at_log = due_total;
+                }
+            }
+        } catch (std::exception& e) {
+            std::cerr << "[streamer] Exception: " << e.what() << "\n";
+        }
+        goto done;
+    }
+
+    // 5b. Fixed-rate mode: one-second windows of up to `rate` messages
     try {
         while (true) {
             auto sec_start = SteadyClock::now();
@@ -70,38 +356,25 @@ int main(int argc, char* argv[]) {
             while (sent_this_sec < rate) {
                 if (max_msgs >= 0 && sent_total >= max_msgs) goto done;
 
-                if (!std::getline(fin, line)) {
-                    if (!loop) {
-                        std::cout << "[streamer] EOF reached.\n";
-                        goto done;
-                    }
-                    // Replay mode: rewind file and skip header again
-                    fin.clear();
-                    fin.seekg(0);
-                    std::getline(fin, header);
-                    if (!std::getline(fin, line)) {
-                        std::cerr << "[streamer] Replay failed (empty after rewind)\n";
-                        goto done;
-                    }
-                }
+                if (!next_line()) goto done;
 
                 // Append to buffer
-                out.append(line);
-                out.push_back('\n');
+                append_line(out, line, stamp_send ? now_wall_ns() : 0);
 
                 ++sent_this_sec;
                 ++sent_total;
 
                 // If the buffer grows too large (6MB), flush early to avoid excessive memory usage
                 if (out.size() >= 6 * 1024 * 1024) {
-                    boost::asio::write(sock, boost::asio::buffer(out));
+                    send(out);
                     out.clear();
                 }
             }
 
             // End of the 1-second window: send any remaining data
             if (!out.empty()) {
-                boost::asio::write(sock, boost::asio::buffer(out));
+                send(out);
+                out.clear();
             }
 
             if (max_msgs >= 0 && sent_total >= max_msgs) goto done;
@@ -131,8 +404,10 @@ done:
     // Key fix: graceful shutdown
     // ==========================================
 
-    // 1) Make sure any remaining data in the string buffer is flushed
-    if (!out.empty()) {
+    // 1) Make sure any remaining data in the string buffer is flushed, then
+    // mark the end of the replay
+    out += "#END\n";
+    {
         try {
             boost::asio::write(sock, boost::asio::buffer(out));
         } catch (...) {
@@ -140,6 +415,8 @@ done:
         }
     }
 
+    if (send_log) send_log.flush();
+
     std::cout << "[streamer] All messages sent. Total=" << sent_total << "\n";
     std::cout << "[streamer] Shutting down socket...\n";
 
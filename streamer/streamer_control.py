@@ -26,6 +26,7 @@ class StartReq(BaseModel):
     rate: int = DEFAULT_RATE
     loop: int = 1                   # 1 = loop forever, 0 = once
     max_msgs: Optional[int] = None  # optional
+    profile: Optional[str] = None   # optional STREAM_PROFILE, e.g. "burst:2M:20ms@5s"
 
 @app.get("/health")
 def health():
@@ -94,7 +95,10 @@ def start(req: StartReq):
 
         try:
             # inherit stdout/stderr for local dev visibility
-            _proc = subprocess.Popen(cmd)
+            env = os.environ.copy()
+            if req.profile:
+                env["STREAM_PROFILE"] = req.profile
+            _proc = subprocess.Popen(cmd, env=env)
         except Exception as e:
             _proc = None
             raise HTTPException(500, f"Failed to start streamer: {e}")
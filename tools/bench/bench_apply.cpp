@@ -1,29 +1,31 @@
+#include "bench_common.hpp"
+#include "mbo/csv_chunk_parser.hpp"
 #include "mbo/csv_parser.hpp"
 #include "mbo/mbo_order_book.hpp"
+#include "mbo/book_arena.hpp"
 
 #include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <fstream>
+#include <memory>
 #include <iostream>
 #include <string>
 #include <vector>
 
 using Clock = std::chrono::steady_clock;
 
-static uint64_t percentile(std::vector<uint64_t>& v, double p) {
-    if (v.empty()) return 0;
-    std::sort(v.begin(), v.end());
-    size_t idx = (size_t)((p / 100.0) * (v.size() - 1));
-    return v[idx];
-}
-
 int main(int argc, char** argv) {
     std::string path = "CLX5_mbo.csv";
     int warmup = 50'000;
     long long max_msgs = -1;        // -1 = all
     int sample_every = 10;          // 每 N 筆記一次 latency，降低量測 overhead
     std::string symbol = "";        // optional: set book symbol
+    std::string json_out;           // optional: append one JSON result line
+    long long arena_orders = 0;     // >0: book nodes from a pre-faulted BookArena
+    std::string arena_pages = "thp";
+    int parallel_parse = 0;         // >0: mmap chunk parser on N threads feeds the book in order
+    size_t chunk_kb = 4096;
 
     for (int i = 1; i < argc; ++i) {
         std::string a = argv[i];
@@ -32,10 +34,17 @@ int main(int argc, char** argv) {
         else if (a == "--max" && i + 1 < argc) max_msgs = std::stoll(argv[++i]);
         else if (a == "--sample_every" && i + 1 < argc) sample_every = std::stoi(argv[++i]);
         else if (a == "--symbol" && i + 1 < argc) symbol = argv[++i];
+        else if (a == "--json" && i + 1 < argc) json_out = argv[++i];
+        else if (a == "--arena_orders" && i + 1 < argc) arena_orders = std::stoll(argv[++i]);
+        else if (a == "--arena_pages" && i + 1 < argc) arena_pages = argv[++i];
+        else if (a == "--parallel_parse" && i + 1 < argc) parallel_parse = std::max(0, std::stoi(argv[++i]));
+        else if (a == "--chunk_kb" && i + 1 < argc) chunk_kb = (size_t)std::max(1, std::stoi(argv[++i]));
         else if (a == "--help") {
             std::cout
                 << "Usage: bench_apply [--path CLX5_mbo.csv] [--warmup N] [--max N]\n"
-                << "                  [--sample_every K] [--symbol SYM]\n";
+                << "                  [--sample_every K] [--symbol SYM] [--json out.jsonl]\n"
+                << "                  [--arena_orders N] [--arena_pages thp|hugetlb|4k]\n"
+                << "                  [--parallel_parse N] [--chunk_kb 4096]\n";
             return 0;
         }
     }
@@ -53,53 +62,105 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    MboOrderBook book(symbol);
-
-    // --- warmup ---
-    int warmed = 0;
-    MboEvent e{};
-    while (warmed < warmup && std::getline(fin, line)) {
-        if (parse_mbo_csv_line(line, e)) {
-            book.apply(e);
-            ++warmed;
-        }
-        if (max_msgs >= 0 && warmed >= max_msgs) break;
+    std::unique_ptr<mbo::BookArena> arena;
+    if (arena_orders > 0) {
+        mbo::BookArenaOptions ao;
+        ao.bytes = mbo::book_arena_bytes_for_orders((size_t)arena_orders);
+        ao.pages = arena_pages == "hugetlb" ? mbo::ArenaPages::Hugetlb
+                 : arena_pages == "4k"      ? mbo::ArenaPages::Normal
+                                            : mbo::ArenaPages::Thp;
+        arena = std::make_unique<mbo::BookArena>(ao);
+        if (!arena->error().empty()) std::cerr << "[bench_apply] arena: " << arena->error() << "\n";
+        if (!arena->ok()) arena.reset();
     }
 
-    // --- measure ---
-    std::vector<uint64_t> lat_ns;
-    lat_ns.reserve(200000);
+    MboOrderBook book(symbol, arena.get(), arena ? (size_t)arena_orders : 0);
 
+    // Warmup, then measure. Events come from the line-by-line reader or, with
+    // --parallel_parse, in file order from the chunk parser's reorder buffer;
+    // either way the measured time covers parsing + apply on this thread.
+    int warmed = 0;
     uint64_t processed = 0;
-    auto t0 = Clock::now();
-
-    while (std::getline(fin, line)) {
-        if (max_msgs >= 0 && (long long)(processed + warmed) >= max_msgs) break;
-
-        if (!parse_mbo_csv_line(line, e)) continue;
+    bool measuring = false;
+    mbo::HdrHistogram lat_ns;
+    mbo::PerfCounters pc;
+    mbo::PerfSample pc0;
+    Clock::time_point t0;
+
+    // false once --max events have been applied
+    auto step = [&](const MboEvent& ev) -> bool {
+        if (max_msgs >= 0 && (long long)(processed + warmed) >= max_msgs) return false;
+        if (!measuring) {
+            if (warmed < warmup) {
+                book.apply(ev);
+                ++warmed;
+                return true;
+            }
+            // hardware counters around the whole measured loop (if permitted)
+            if (pc.available()) pc.start();
+            pc0 = pc.read();
+            measuring = true;
+            t0 = Clock::now();
+        }
 
         bool sample = (sample_every <= 1) || ((processed % (uint64_t)sample_every) == 0);
 
         Clock::time_point s;
         if (sample) s = Clock::now();
 
-        book.apply(e);
+        book.apply(ev);
 
         if (sample) {
             uint64_t dt = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - s).count();
-            lat_ns.push_back(dt);
+            lat_ns.record(dt);
         }
 
         ++processed;
+        return true;
+    };
+
+    MboEvent e{};
+    mbo::ParallelCsvStats pst;
+    if (parallel_parse > 0) {
+        fin.close();
+        mbo::ParallelCsvOptions po;
+        po.threads = (unsigned)parallel_parse;
+        po.chunk_bytes = chunk_kb << 10;
+        std::string err;
+        const bool ok = mbo::parse_csv_file_parallel(path, po, [&](const mbo::MboRecord* recs, size_t n) {
+            for (size_t k = 0; k < n; ++k) {
+                mbo::book_event_from_record(recs[k], e);
+                if (!step(e)) return false;
+            }
+            return true;
+        }, err, &pst);
+        if (!ok) {
+            std::cerr << "[bench_apply] " << err << "\n";
+            return 1;
+        }
+    } else {
+        while (std::getline(fin, line)) {
+            if (!parse_mbo_csv_line(line, e)) continue;
+            if (!step(e)) break;
+        }
+    }
+    if (!measuring) {
+        if (pc.available()) pc.start();
+        pc0 = pc.read();
+        t0 = Clock::now();
     }
 
     uint64_t total_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+
+    mbo::PerfTotals perf;
+    perf.add(pc0, pc.read(), processed);
+    pc.stop();
     double secs = (double)total_ns / 1e9;
     double mps = (secs > 0) ? (processed / secs) : 0.0;
 
-    uint64_t p50 = percentile(lat_ns, 50);
-    uint64_t p95 = percentile(lat_ns, 95);
-    uint64_t p99 = percentile(lat_ns, 99);
+    uint64_t p50 = lat_ns.value_at_percentile(50);
+    uint64_t p95 = lat_ns.value_at_percentile(95);
+    uint64_t p99 = lat_ns.value_at_percentile(99);
 
     std::cout << "Warmup applied: " << warmed << "\n";
     std::cout << "Measured applied: " << processed << "\n";
@@ -108,6 +169,47 @@ int main(int argc, char** argv) {
     std::cout << "Apply latency (us): p50=" << (p50/1000.0)
               << " p95=" << (p95/1000.0)
               << " p99=" << (p99/1000.0) << "\n";
+    if (arena) std::cout << "Book arena: " << arena->to_json() << "\n";
+    if (parallel_parse > 0) {
+        std::cout << "Parallel parse: " << pst.threads << " thread(s), " << pst.chunks << " chunk(s), "
+                  << "parse " << pst.parse_ms << " ms summed, applier waited " << pst.wait_ms << " ms\n";
+    }
+    if (pc.available()) {
+        std::cout << "Perf per event:";
+        for (int i = 0; i < mbo::kPerfEventCount; ++i) {
+            auto ev = (mbo::PerfEvent)i;
+            if (pc.has(ev)) std::cout << " " << mbo::perf_event_name(ev) << "=" << perf.per_item(ev);
+        }
+        std::cout << "\n";
+    } else {
+        std::cout << "Perf counters unavailable: " << pc.error() << "\n";
+    }
+
+    if (!json_out.empty()) {
+        bench::Options o;
+        o.path = path;
+        o.warmup = 0;
+        o.json_out = json_out;
+
+        bench::Result r;
+        r.bench = "apply";
+        r.variant = parallel_parse > 0 ? (arena ? "parallel_parse_apply_arena" : "parallel_parse_apply")
+                  : arena             ? "parse_apply_arena"
+                                      : "parse_apply";
+        r.items_per_rep = processed;
+        r.rep_ns.push_back(total_ns);
+        r.op_hist = std::move(lat_ns);
+        if (pc.available()) r.perf_json = perf.to_json(pc);
+        r.add("warmup_events", warmed);
+        r.add("sample_every", sample_every);
+        if (arena) r.add("arena_orders", arena_orders);
+        if (parallel_parse > 0) {
+            r.add("parse_threads", pst.threads);
+            r.add("chunk_kb", (double)chunk_kb);
+            r.add("consumer_wait_ms", pst.wait_ms);
+        }
+        bench::emit(r, o);
+    }
 
     // optional: print one BBO JSON at end (sanity check)
     // std::cout << book.to_json_bbo() << "\n";
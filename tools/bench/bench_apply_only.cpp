@@ -0,0 +1,81 @@
+// Apply-only benchmark: events are parsed up front into an in-memory array,
+// so the timed loop measures MboOrderBook::apply and nothing else.
+//
+// --steady: one arena-backed book is kept across reps; each rep clears it
+// (an 'R' event) and replays the stream. The warmup reps size the order
+// index and fill the arena's free lists, so the timed reps see steady-state
+// apply only, not the node allocations of building a fresh book. This is
+// the variant the allocation gate (make bench-alloc-check) runs.
+#include "bench_common.hpp"
+#include "mbo/book_arena.hpp"
+#include "mbo/mbo_order_book.hpp"
+
+#include <memory>
+
+int main(int argc, char** argv) {
+    bench::Options o;
+    int sample_every = 0; // 0 = no per-op timing (pure throughput)
+    bool steady = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (bench::parse_common_arg(i, argc, argv, o)) continue;
+        std::string a = argv[i];
+        if (a == "--sample_every" && i + 1 < argc) sample_every = std::stoi(argv[++i]);
+        else if (a == "--steady") steady = true;
+        else if (a == "--help") {
+            bench::print_common_usage("bench_apply_only", " [--sample_every K] [--steady]");
+            return 0;
+        }
+    }
+
+    std::vector<MboEvent> events;
+    if (!bench::load_events(o, events)) return 1;
+
+    if (steady) {
+        if (o.warmup < 1) o.warmup = 1;   // the warm pass is what makes it steady
+        mbo::BookArenaOptions ao;
+        ao.bytes = mbo::book_arena_bytes_for_orders(events.size());   // resting orders <= events
+        mbo::BookArena arena(ao);
+        if (!arena.ok()) {
+            std::cerr << "[bench_apply_only] arena: " << arena.error() << "\n";
+            return 1;
+        }
+        MboOrderBook book(o.symbol, &arena, events.size());
+        MboEvent clear{};
+        clear.action = 'R';
+        auto r = bench::run("apply_only", "steady", o, [&](bench::Result&) -> uint64_t {
+            book.apply(clear);
+            for (const auto& e : events) book.apply(e);
+            bench::do_not_optimize(book);
+            return (uint64_t)events.size();
+        });
+        r.add("arena_overflow", (double)arena.overflow_allocs());
+        bench::emit(r, o);
+        return bench::exit_code();
+    }
+
+    // Each rep replays the whole stream into a fresh book.
+    auto r = bench::run("apply_only", sample_every > 0 ? "sampled" : "throughput", o,
+                        [&](bench::Result& res) -> uint64_t {
+        MboOrderBook book(o.symbol);
+        if (sample_every <= 0) {
+            for (const auto& e : events) book.apply(e);
+        } else {
+            uint64_t n = 0;
+            for (const auto& e : events) {
+                if ((n++ % (uint64_t)sample_every) == 0) {
+                    auto s = bench::Clock::now();
+                    book.apply(e);
+                    res.op_hist.record(bench::elapsed_ns(s, bench::Clock::now()));
+                } else {
+                    book.apply(e);
+                }
+            }
+        }
+        bench::do_not_optimize(book);
+        return (uint64_t)events.size();
+    });
+
+    bench::emit(r, o);
+    return bench::exit_code();
+}
@@ -0,0 +1,109 @@
+// Checkpoint benchmark: encode / decode the binary book checkpoint against the
+// replay it replaces. The input book is the state at the end of the CSV, or a
+// synthetic deep book (--orders N over --levels L per side). --arena decodes
+// into a book on a pre-faulted THP arena, as the engine does with
+// BOOK_ARENA_ORDERS set.
+#include "bench_common.hpp"
+#include "mbo/book_arena.hpp"
+#include "mbo/book_checkpoint.hpp"
+#include "mbo/mbo_order_book.hpp"
+
+#include <memory>
+
+int main(int argc, char** argv) {
+    bench::Options o;
+    o.reps = 10;
+    long long synth_orders = 0;  // 0 = book from the CSV replay
+    int synth_levels = 500;
+    bool use_arena = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (bench::parse_common_arg(i, argc, argv, o)) continue;
+        std::string a = argv[i];
+        if (a == "--orders" && i + 1 < argc) synth_orders = std::stoll(argv[++i]);
+        else if (a == "--levels" && i + 1 < argc) synth_levels = std::max(1, std::stoi(argv[++i]));
+        else if (a == "--arena") use_arena = true;
+        else if (a == "--help") {
+            bench::print_common_usage("bench_checkpoint", " [--orders N] [--levels L] [--arena]");
+            return 0;
+        }
+    }
+
+    const std::string sym = o.symbol.empty() ? "CLX5" : o.symbol;
+    std::vector<MboEvent> events;
+    if (synth_orders > 0) {
+        // adds only, spread round-robin over L levels per side around 65.0000
+        events.reserve((size_t)synth_orders);
+        for (long long k = 0; k < synth_orders; ++k) {
+            MboEvent e;
+            e.action = 'A';
+            e.side = (k & 1) ? 'A' : 'B';
+            const int64_t lvl = (k / 2) % synth_levels;
+            e.price = (e.side == 'B') ? 650000 - 1 - lvl : 650000 + lvl;
+            e.size = 1 + (int32_t)(k % 7);
+            e.order_id = 1'000'000 + k;
+            e.sequence = (uint64_t)k;
+            events.push_back(std::move(e));
+        }
+    } else if (!bench::load_events(o, events)) {
+        return 1;
+    }
+
+    // reference: rebuild by replaying every event
+    MboOrderBook book(sym);
+    auto replay = bench::run("checkpoint", "replay", o, [&](bench::Result&) -> uint64_t {
+        book = MboOrderBook(sym);
+        for (const auto& e : events) book.apply(e);
+        bench::do_not_optimize(book);
+        return (uint64_t)events.size();
+    });
+    replay.add("orders", (double)book.order_count());
+    bench::emit(replay, o);
+
+    mbo::CheckpointMeta meta;
+    meta.symbol = sym;
+    meta.applied = events.size();
+    meta.last_seq = events.empty() ? 0 : events.back().sequence;
+    meta.seq_count = 1;
+
+    std::string img;
+    mbo::CheckpointStats cs;
+    auto enc = bench::run("checkpoint", "encode", o, [&](bench::Result&) -> uint64_t {
+        mbo::encode_book_checkpoint(book, meta, img, &cs);
+        bench::do_not_optimize(img);
+        return cs.orders;
+    });
+    enc.add("bytes", (double)cs.bytes);
+    bench::emit(enc, o);
+
+    std::unique_ptr<mbo::BookArena> arena;
+    if (use_arena) {
+        mbo::BookArenaOptions ao;
+        ao.bytes = mbo::book_arena_bytes_for_orders(cs.orders);
+        arena = std::make_unique<mbo::BookArena>(ao);
+        if (!arena->error().empty()) std::cerr << "[bench_checkpoint] arena: " << arena->error() << "\n";
+        if (!arena->ok()) arena.reset();
+    }
+
+    MboOrderBook restored;
+    auto dec = bench::run("checkpoint", arena ? "decode_arena" : "decode", o, [&](bench::Result&) -> uint64_t {
+        restored = MboOrderBook("", arena.get(), cs.orders);
+        mbo::CheckpointMeta m;
+        std::string err;
+        if (!mbo::decode_book_checkpoint(img.data(), img.size(), restored, m, err)) {
+            std::cerr << "[bench_checkpoint] decode failed: " << err << "\n";
+            bench::failed_flag() = true;
+        }
+        bench::do_not_optimize(restored);
+        return restored.order_count();
+    });
+    dec.add("bytes", (double)cs.bytes);
+    bench::emit(dec, o);
+
+    // round trip must reproduce the full book
+    if (restored.to_json(1'000'000) != book.to_json(1'000'000)) {
+        std::cerr << "[bench_checkpoint] FAIL: restored book differs from the original\n";
+        bench::failed_flag() = true;
+    }
+    return bench::exit_code();
+}
@@ -0,0 +1,316 @@
+#pragma once
+// Shared harness for the tools/bench/* benchmarks.
+//
+// Every benchmark follows the same shape:
+//   - load the input fully into memory before timing (no disk I/O in the loop)
+//   - run `warmup` untimed repetitions, then `reps` timed repetitions
+//   - emit one JSON line per measured variant (stdout, or appended to --json)
+//   - hardware counters (cycles, instructions, cache/branch/TLB misses) are
+//     read around every timed rep when perf_event_open is permitted
+//   - per-operation latencies go into a log-linear HdrHistogram (O(1) record,
+//     no per-sample storage), summarised as op_* fields
+//   - in ALLOC_COUNT=1 builds, heap allocations per item are reported and
+//     --max_allocs_per_item turns them into a pass/fail gate
+//
+// so results from different stages can be compared side by side and diffed
+// across commits.
+
+#include "mbo/alloc_counter.hpp"
+#include "mbo/csv_parser.hpp"
+#include "mbo/hdr_histogram.hpp"
+#include "mbo/mbo_event.hpp"
+#include "mbo/mbo_record.hpp"
+#include "mbo/perf_counters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string path = "CLX5_mbo.csv";
+    int warmup = 2;           // untimed repetitions
+    int reps = 10;            // timed repetitions
+    long long max = -1;       // -1 = all input lines
+    std::string json_out;     // empty => stdout
+    std::string symbol;       // optional book symbol
+    bool perf = true;         // read hardware counters around timed reps
+    double max_allocs_per_item = -1;  // < 0 = no allocation gate
+    int hist_digits = 3;      // op latency histogram precision (significant digits)
+};
+
+// Set when a variant exceeds its allocation budget; mains return exit_code().
+inline bool& failed_flag() {
+    static bool failed = false;
+    return failed;
+}
+
+inline int exit_code() { return failed_flag() ? 3 : 0; }
+
+inline void print_common_usage(const char* prog, const char* extra = "") {
+    std::cout
+        << "Usage: " << prog << " [--path CLX5_mbo.csv] [--warmup N] [--reps N] [--max N]\n"
+        << "       [--json out.jsonl] [--symbol SYM] [--no_perf] [--max_allocs_per_item X]\n"
+        << "       [--hist_digits 3]"
+        << extra << "\n";
+}
+
+// Consume one common flag at argv[i]. Returns true if it was recognised.
+inline bool parse_common_arg(int& i, int argc, char** argv, Options& o) {
+    std::string a = argv[i];
+    if (a == "--path" && i + 1 < argc) { o.path = argv[++i]; return true; }
+    if (a == "--warmup" && i + 1 < argc) { o.warmup = std::stoi(argv[++i]); return true; }
+    if (a == "--reps" && i + 1 < argc) { o.reps = std::stoi(argv[++i]); return true; }
+    if (a == "--max" && i + 1 < argc) { o.max = std::stoll(argv[++i]); return true; }
+    if (a == "--json" && i + 1 < argc) { o.json_out = argv[++i]; return true; }
+    if (a == "--symbol" && i + 1 < argc) { o.symbol = argv[++i]; return true; }
+    if (a == "--no_perf") { o.perf = false; return true; }
+    if (a == "--max_allocs_per_item" && i + 1 < argc) {
+        o.max_allocs_per_item = std::stod(argv[++i]);
+        return true;
+    }
+    if (a == "--hist_digits" && i + 1 < argc) { o.hist_digits = std::stoi(argv[++i]); return true; }
+    return false;
+}
+
+// Read CSV data lines into memory (header skipped, '\r' stripped).
+inline bool load_lines(const Options& o, std::vector<std::string>& out) {
+    std::ifstream fin(o.path);
+    if (!fin) {
+        std::cerr << "[bench] Failed to open: " << o.path << "\n";
+        return false;
+    }
+    std::string line;
+    if (!std::getline(fin, line)) {
+        std::cerr << "[bench] Empty file: " << o.path << "\n";
+        return false;
+    }
+    out.clear();
+    while (std::getline(fin, line)) {
+        if (o.max >= 0 && (long long)out.size() >= o.max) break;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        out.push_back(std::move(line));
+    }
+    return true;
+}
+
+// Pre-parse lines into an in-memory event array (parse errors dropped).
+inline std::vector<MboEvent> parse_all(const std::vector<std::string>& lines) {
+    std::vector<MboEvent> events;
+    events.reserve(lines.size());
+    MboEvent e{};
+    for (const auto& l : lines) {
+        if (parse_mbo_csv_line(l, e)) events.push_back(e);
+    }
+    return events;
+}
+
+// Load an in-memory event array from either a CSV (parsed up front) or a
+// binary ".mbob" file produced by tools/gen/mbo_gen.
+inline bool load_events(const Options& o, std::vector<MboEvent>& out) {
+    out.clear();
+    if (mbo::is_mbo_record_path(o.path)) {
+        std::vector<mbo::MboRecord> recs;
+        if (!mbo::read_mbo_records(o.path, recs)) return false;
+        if (o.max >= 0 && (long long)recs.size() > o.max) recs.resize((size_t)o.max);
+        out.resize(recs.size());
+        for (size_t i = 0; i < recs.size(); ++i) mbo::event_from_record(recs[i], out[i]);
+        return true;
+    }
+    std::vector<std::string> lines;
+    if (!load_lines(o, lines)) return false;
+    out = parse_all(lines);
+    return true;
+}
+
+inline uint64_t elapsed_ns(Clock::time_point s, Clock::time_point f) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(f - s).count();
+}
+
+// Nearest-rank percentile over a copy (inputs are small: one value per rep / sample).
+inline uint64_t percentile(std::vector<uint64_t> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    size_t idx = (size_t)((p / 100.0) * (double)(v.size() - 1));
+    return v[idx];
+}
+
+struct Result {
+    std::string bench;
+    std::string variant;
+    uint64_t items_per_rep = 0;
+    std::vector<uint64_t> rep_ns;   // wall time of each timed rep
+    mbo::HdrHistogram op_hist;      // optional per-operation latencies (all timed reps)
+
+    // extra numeric fields appended to the JSON line
+    std::vector<std::pair<std::string, double>> extra;
+
+    // hardware counters summed over timed reps; empty if unavailable / disabled
+    std::string perf_json;
+
+    // heap allocations over timed reps (ALLOC_COUNT=1 builds only)
+    mbo::AllocTotals alloc;
+
+    void add(const std::string& k, double v) { extra.emplace_back(k, v); }
+};
+
+// Counters are opened per variant; report once per process if they are missing.
+inline void warn_perf_unavailable(const mbo::PerfCounters& pc) {
+    static bool warned = false;
+    if (warned) return;
+    warned = true;
+    std::cerr << "[bench] perf counters unavailable (" << pc.error()
+              << "); check /proc/sys/kernel/perf_event_paranoid\n";
+}
+
+// Run `fn` warmup+reps times. `fn(Result&)` performs one full repetition and
+// returns the number of items it processed; it may record samples into op_hist.
+template <typename F>
+Result run(const std::string& bench, const std::string& variant, const Options& o, F&& fn) {
+    Result r;
+    r.bench = bench;
+    r.variant = variant;
+    r.op_hist = mbo::HdrHistogram(o.hist_digits);
+
+    Result scratch;
+    for (int i = 0; i < o.warmup; ++i) {
+        scratch.op_hist.reset();
+        fn(scratch);
+    }
+
+    mbo::PerfCounters pc;
+    mbo::PerfTotals totals;
+    const bool perf = o.perf && pc.available();
+    if (o.perf && !pc.available()) warn_perf_unavailable(pc);
+    if (perf) pc.start();
+
+    r.rep_ns.reserve((size_t)std::max(o.reps, 1));
+    for (int i = 0; i < std::max(o.reps, 1); ++i) {
+        mbo::PerfSample c0;
+        if (perf) c0 = pc.read();
+        mbo::AllocCounts a0;
+        if constexpr (mbo::kAllocCounting) a0 = mbo::thread_alloc_counts();
+        auto s = Clock::now();
+        uint64_t items = fn(r);
+        auto f = Clock::now();
+        if constexpr (mbo::kAllocCounting) r.alloc.add(a0, mbo::thread_alloc_counts(), items);
+        if (perf) totals.add(c0, pc.read(), items);
+        r.rep_ns.push_back(elapsed_ns(s, f));
+        r.items_per_rep = items;
+    }
+
+    if (perf) {
+        pc.stop();
+        r.perf_json = totals.to_json(pc);
+    }
+    return r;
+}
+
+inline void emit(const Result& r, const Options& o) {
+    const double items = (double)std::max<uint64_t>(r.items_per_rep, 1);
+    const uint64_t rep_min = percentile(r.rep_ns, 0);
+    const uint64_t rep_p50 = percentile(r.rep_ns, 50);
+    const uint64_t rep_max = percentile(r.rep_ns, 100);
+    double rep_mean = 0.0;
+    for (auto v : r.rep_ns) rep_mean += (double)v;
+    if (!r.rep_ns.empty()) rep_mean /= (double)r.rep_ns.size();
+
+    std::ostringstream js;
+    js.precision(12);
+    js << "{\"bench\":\"" << r.bench << "\""
+       << ",\"variant\":\"" << r.variant << "\""
+       << ",\"path\":\"" << o.path << "\""
+       << ",\"warmup\":" << o.warmup
+       << ",\"reps\":" << r.rep_ns.size()
+       << ",\"items\":" << r.items_per_rep
+       << ",\"ns_per_item_min\":" << (double)rep_min / items
+       << ",\"ns_per_item_p50\":" << (double)rep_p50 / items
+       << ",\"ns_per_item_mean\":" << rep_mean / items
+       << ",\"ns_per_item_max\":" << (double)rep_max / items
+       << ",\"items_per_s_p50\":" << (rep_p50 > 0 ? items * 1e9 / (double)rep_p50 : 0.0);
+
+    const mbo::HdrHistogram& h = r.op_hist;
+    if (h.count() > 0) {
+        js << ",\"op_samples\":" << h.count()
+           << ",\"op_min_ns\":" << h.min()
+           << ",\"op_mean_ns\":" << h.mean()
+           << ",\"op_p50_ns\":" << h.value_at_percentile(50)
+           << ",\"op_p95_ns\":" << h.value_at_percentile(95)
+           << ",\"op_p99_ns\":" << h.value_at_percentile(99)
+           << ",\"op_p999_ns\":" << h.value_at_percentile(99.9)
+           << ",\"op_max_ns\":" << h.max();
+    }
+    for (const auto& kv : r.extra) {
+        js << ",\"" << kv.first << "\":" << kv.second;
+    }
+    if (!r.perf_json.empty()) js << ",\"perf\":" << r.perf_json;
+    if constexpr (mbo::kAllocCounting) js << ",\"alloc\":" << r.alloc.to_json();
+    js << ",\"rep_ns\":[";
+    for (size_t i = 0; i < r.rep_ns.size(); ++i) {
+        if (i) js << ",";
+        js << r.rep_ns[i];
+    }
+    js << "]}";
+
+    // human-readable summary on stderr, machine-readable line on stdout / file
+    std::cerr << "[" << r.bench << (r.variant.empty() ? "" : "/") << r.variant << "] "
+              << "items=" << r.items_per_rep
+              << " ns/item p50=" << (double)rep_p50 / items
+              << " min=" << (double)rep_min / items
+              << " max=" << (double)rep_max / items;
+    if (h.count() > 0) {
+        std::cerr << " | op p50=" << h.value_at_percentile(50)
+                  << " p99=" << h.value_at_percentile(99) << " ns";
+    }
+    if constexpr (mbo::kAllocCounting) {
+        std::cerr << " | allocs/item=" << r.alloc.allocs_per_item();
+    }
+    std::cerr << "\n";
+
+    // allocation gate (only meaningful when counting is compiled in)
+    if (o.max_allocs_per_item >= 0) {
+        if (!mbo::kAllocCounting) {
+            std::cerr << "[bench] FAIL: --max_allocs_per_item needs an ALLOC_COUNT=1 build\n";
+            failed_flag() = true;
+        } else if (r.alloc.allocs_per_item() > o.max_allocs_per_item) {
+            std::cerr << "[bench] FAIL: " << r.bench << "/" << r.variant << " allocates "
+                      << r.alloc.allocs_per_item() << " per item (budget "
+                      << o.max_allocs_per_item << ")\n";
+            failed_flag() = true;
+        }
+    }
+
+    if (o.json_out.empty()) {
+        std::cout << js.str() << "\n";
+        return;
+    }
+    std::ofstream ofs(o.json_out, std::ios::binary | std::ios::app);
+    if (!ofs) {
+        std::cerr << "[bench] failed to open json output: " << o.json_out << "\n";
+        std::cout << js.str() << "\n";
+        return;
+    }
+    ofs << js.str() << "\n";
+}
+
+// Keep the optimiser from discarding benchmark work.
+template <typename T>
+inline void do_not_optimize(const T& v) {
+#if defined(__GNUG__) || defined(__clang__)
+    asm volatile("" : : "g"(&v) : "memory");
+#else
+    (void)v;
+#endif
+}
+
+} // namespace bench
@@ -0,0 +1,362 @@
+#!/usr/bin/env python3
+"""
+Benchmark regression tracker.
+
+Runs a benchmark target N times, stores named baselines, and compares a new
+set of runs against a baseline with confidence intervals so that run-to-run
+noise is not mistaken for a regression (or an improvement).
+
+Targets:
+  apply       tools/bench/bench_apply        (parse + apply, per-op percentiles)
+  apply_only  tools/bench/bench_apply_only   (apply over pre-parsed events)
+  replay      streamer + tcp_main_ws over TCP (engine replay mode, bench line)
+
+Usage:
+  bench_compare.py baseline <name> [--target apply] [--runs 10]
+  bench_compare.py compare  <name> [--runs 10] [--threshold 5]
+  bench_compare.py import   <name> --jsonl frontend/public/benchmarks.jsonl [--last 10]
+  bench_compare.py show     <name>
+
+Exit codes: 0 = no regression, 1 = regression beyond threshold, 2 = usage / run error.
+"""
+
+import argparse
+import json
+import math
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+REPO_ROOT = Path(__file__).resolve().parents[2]
+BENCH_DIR = REPO_ROOT / "tools" / "bench"
+DEFAULT_BASELINE_DIR = BENCH_DIR / "baselines"
+DEFAULT_CSV = BENCH_DIR / "CLX5_mbo.csv"
+
+# ---- metric definitions ----
+# name -> (source key in the JSON line, higher_is_better)
+BENCH_METRICS = {
+    "throughput": ("items_per_s_p50", True),
+    "p50": ("op_p50_ns", False),
+    "p95": ("op_p95_ns", False),
+    "p99": ("op_p99_ns", False),
+}
+
+ENGINE_METRICS = {
+    "throughput": ("throughput_msgs_per_s", True),
+    "p50": ("apply_p50_us", False),
+    "p95": ("apply_p95_us", False),
+    "p99": ("apply_p99_us", False),
+}
+
+TARGET_METRICS = {
+    "apply": BENCH_METRICS,
+    "apply_only": BENCH_METRICS,
+    "replay": ENGINE_METRICS,
+}
+
+# two-sided 95% Student-t critical values by degrees of freedom
+_T95 = {
+    1: 12.706, 2: 4.303, 3: 3.182, 4: 2.776, 5: 2.571, 6: 2.447, 7: 2.365,
+    8: 2.306, 9: 2.262, 10: 2.228, 12: 2.179, 15: 2.131, 20: 2.086,
+    25: 2.060, 30: 2.042, 40: 2.021, 60: 2.000, 120: 1.980,
+}
+
+
+def t95(df: float) -> float:
+    if df <= 0 or math.isnan(df):
+        return float("inf")
+    for k in sorted(_T95):
+        if df <= k:
+            return _T95[k]
+    return 1.960
+
+
+# ---- running targets ----
+
+def _read_last_json_line(path: Path) -> dict:
+    lines = [l for l in path.read_text().splitlines() if l.strip()]
+    if not lines:
+        raise RuntimeError(f"no output in {path}")
+    return json.loads(lines[-1])
+
+
+def run_bench_binary(name: str, csv: Path, extra: list) -> dict:
+    binary = BENCH_DIR / name
+    if not binary.exists():
+        raise RuntimeError(f"{binary} not found (run: make bench)")
+    with tempfile.TemporaryDirectory() as td:
+        out = Path(td) / "out.jsonl"
+        cmd = [str(binary), "--path", str(csv), "--json", str(out)] + extra
+        subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        return _read_last_json_line(out)
+
+
+def run_engine_replay(csv: Path, port: int, ws_port: int, depth: int, snapshot_every: int) -> dict:
+    streamer = REPO_ROOT / "streamer" / "streamer"
+    engine = REPO_ROOT / "tcp_main_ws"
+    for b in (streamer, engine):
+        if not b.exists():
+            raise RuntimeError(f"{b} not found (run: make && make -C streamer)")
+
+    with tempfile.TemporaryDirectory() as td:
+        bench_log = Path(td) / "bench.jsonl"
+        env = dict(os.environ)
+        env.update({
+            "MAX_SESSIONS": "1",
+            "FEED_ENABLED": "0",
+            "BENCH_LOG_PATH": str(bench_log),
+            "PG_CONNINFO": "",
+        })
+
+        # replay once, as fast as the streamer can push
+        sp = subprocess.Popen(
+            [str(streamer), str(csv), str(port), "100000000", "0"],
+            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL,
+        )
+        try:
+            time.sleep(0.3)
+            subprocess.run(
+                [str(engine), "127.0.0.1", str(port), str(ws_port),
+                 str(depth), str(snapshot_every), "-1", "50"],
+                env=env, check=True, timeout=300,
+                stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL,
+            )
+        finally:
+            sp.terminate()
+            try:
+                sp.wait(timeout=5)
+            except subprocess.TimeoutExpired:
+                sp.kill()
+        return _read_last_json_line(bench_log)
+
+
+def run_target(args) -> dict:
+    csv = Path(args.csv).resolve()
+    if args.target == "apply":
+        return run_bench_binary("bench_apply", csv, ["--warmup", str(args.warmup_events)])
+    if args.target == "apply_only":
+        return run_bench_binary("bench_apply_only", csv, ["--sample_every", "1", "--reps", "3"])
+    if args.target == "replay":
+        return run_engine_replay(csv, args.port, args.ws_port, args.depth, args.snapshot_every)
+    raise RuntimeError(f"unknown target {args.target}")
+
+
+def extract(target: str, line: dict) -> dict:
+    out = {}
+    for name, (key, _) in TARGET_METRICS[target].items():
+        if key in line:
+            out[name] = float(line[key])
+    return out
+
+
+def collect(args, runs: int) -> list:
+    samples = []
+    for i in range(runs):
+        line = run_target(args)
+        m = extract(args.target, line)
+        samples.append(m)
+        print(f"[bench_compare] run {i + 1}/{runs}: "
+              + " ".join(f"{k}={v:.4g}" for k, v in m.items()), file=sys.stderr)
+    return samples
+
+
+# ---- baseline storage ----
+
+def baseline_path(args, name: str) -> Path:
+    return Path(args.baseline_dir) / f"{name}.json"
+
+
+def git_rev() -> str:
+    try:
+        return subprocess.run(
+            ["git", "-C", str(REPO_ROOT), "rev-parse", "--short", "HEAD"],
+            capture_output=True, text=True, check=True,
+        ).stdout.strip()
+    except Exception:
+        return ""
+
+
+def save_baseline(args, name: str, samples: list, source: str) -> None:
+    path = baseline_path(args, name)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    doc = {
+        "name": name,
+        "target": args.target,
+        "source": source,
+        "git": git_rev(),
+        "created_unix": int(time.time()),
+        "runs": samples,
+    }
+    path.write_text(json.dumps(doc, indent=2) + "\n")
+    print(f"[bench_compare] saved baseline '{name}' ({len(samples)} runs) -> {path}")
+
+
+def load_baseline(args, name: str) -> dict:
+    path = baseline_path(args, name)
+    if not path.exists():
+        raise RuntimeError(f"baseline not found: {path}")
+    return json.loads(path.read_text())
+
+
+# ---- statistics ----
+
+def summarize(xs: list) -> tuple:
+    n = len(xs)
+    mean = statistics.fmean(xs)
+    sd = statistics.stdev(xs) if n > 1 else 0.0
+    half = t95(n - 1) * sd / math.sqrt(n) if n > 1 else float("inf")
+    return n, mean, sd, half
+
+
+def welch_diff_ci(a: list, b: list) -> tuple:
+    """95% CI of mean(b) - mean(a) (Welch)."""
+    na, ma, sa, _ = summarize(a)
+    nb, mb, sb, _ = summarize(b)
+    va, vb = sa * sa / na, sb * sb / nb
+    se = math.sqrt(va + vb)
+    diff = mb - ma
+    if se == 0.0:
+        return diff, diff, diff
+    df_den = 0.0
+    if na > 1:
+        df_den += va * va / (na - 1)
+    if nb > 1:
+        df_den += vb * vb / (nb - 1)
+    df = (va + vb) ** 2 / df_den if df_den > 0 else float("nan")
+    h = t95(df) * se
+    return diff, diff - h, diff + h
+
+
+def compare(target: str, base_runs: list, cur_runs: list, threshold_pct: float) -> bool:
+    regressed = False
+    print(f"{'metric':<11} {'baseline':>22} {'current':>22} {'change':>9} {'95% CI of change':>22}  verdict")
+    for name, (_, higher_better) in TARGET_METRICS[target].items():
+        a = [r[name] for r in base_runs if name in r]
+        b = [r[name] for r in cur_runs if name in r]
+        if len(a) < 2 or len(b) < 2:
+            print(f"{name:<11} (need >= 2 runs on both sides)")
+            continue
+
+        _, ma, _, ha = summarize(a)
+        _, mb, _, hb = summarize(b)
+        diff, lo, hi = welch_diff_ci(a, b)
+        rel = 100.0 * diff / ma if ma else 0.0
+        rel_lo = 100.0 * lo / ma if ma else 0.0
+        rel_hi = 100.0 * hi / ma if ma else 0.0
+
+        # express "worse" as a positive number in either direction
+        worse = -rel if higher_better else rel
+        worse_ci_near = -rel_hi if higher_better else rel_lo  # CI bound closest to "no change"
+
+        if worse > threshold_pct and worse_ci_near > 0:
+            verdict = "REGRESSION"
+            regressed = True
+        elif -worse > threshold_pct and (rel_lo > 0 if higher_better else rel_hi < 0):
+            verdict = "improved"
+        elif (lo <= 0 <= hi):
+            verdict = "noise"
+        else:
+            verdict = "ok"
+
+        print(f"{name:<11} {ma:>12.4g} ±{ha:<9.3g} {mb:>12.4g} ±{hb:<9.3g} {rel:>+8.2f}% "
+              f"[{rel_lo:>+8.2f}%,{rel_hi:>+8.2f}%]  {verdict}")
+    return regressed
+
+
+# ---- commands ----
+
+def cmd_baseline(args) -> int:
+    samples = collect(args, args.runs)
+    save_baseline(args, args.name, samples, source="run")
+    return 0
+
+
+def cmd_compare(args) -> int:
+    base = load_baseline(args, args.name)
+    args.target = base.get("target", args.target)
+    samples = collect(args, args.runs)
+    print(f"baseline '{args.name}' (git {base.get('git') or '?'}, {len(base['runs'])} runs)"
+          f" vs current (git {git_rev() or '?'}, {len(samples)} runs), target={args.target},"
+          f" threshold={args.threshold}%")
+    regressed = compare(args.target, base["runs"], samples, args.threshold)
+    if args.save_as:
+        save_baseline(args, args.save_as, samples, source="run")
+    return 1 if regressed else 0
+
+
+def cmd_import(args) -> int:
+    # Engine bench lines (BENCH_LOG_PATH) become a 'replay' baseline
+    args.target = "replay"
+    lines = [json.loads(l) for l in Path(args.jsonl).read_text().splitlines() if l.strip()]
+    # session summaries only; BENCH_INTERVAL_S lines carry "type":"interval"
+    lines = [l for l in lines if l.get("type", "session") == "session" and l.get("processed", 0) > 0]
+    if args.last:
+        lines = lines[-args.last:]
+    if not lines:
+        print("[bench_compare] no usable bench lines", file=sys.stderr)
+        return 2
+    save_baseline(args, args.name, [extract("replay", l) for l in lines], source=str(args.jsonl))
+    return 0
+
+
+def cmd_show(args) -> int:
+    base = load_baseline(args, args.name)
+    print(f"baseline '{base['name']}' target={base['target']} git={base.get('git')} runs={len(base['runs'])}")
+    for name in TARGET_METRICS[base["target"]]:
+        xs = [r[name] for r in base["runs"] if name in r]
+        if xs:
+            n, mean, sd, half = summarize(xs)
+            print(f"  {name:<11} mean={mean:.4g} sd={sd:.3g} 95%CI=±{half:.3g} (n={n})")
+    return 0
+
+
+def main() -> int:
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--baseline-dir", default=str(DEFAULT_BASELINE_DIR))
+    p.add_argument("--csv", default=str(DEFAULT_CSV))
+    p.add_argument("--target", choices=sorted(TARGET_METRICS), default="apply")
+    p.add_argument("--runs", type=int, default=10)
+    p.add_argument("--warmup-events", type=int, default=5000, help="bench_apply --warmup")
+    p.add_argument("--port", type=int, default=19500, help="replay: streamer port")
+    p.add_argument("--ws-port", type=int, default=19580, help="replay: engine WS port")
+    p.add_argument("--depth", type=int, default=50)
+    p.add_argument("--snapshot-every", type=int, default=1000)
+
+    sub = p.add_subparsers(dest="cmd", required=True)
+    s = sub.add_parser("baseline", help="run N times and store as a named baseline")
+    s.add_argument("name")
+    s.set_defaults(func=cmd_baseline)
+
+    s = sub.add_parser("compare", help="run N times and compare against a baseline")
+    s.add_argument("name")
+    s.add_argument("--threshold", type=float, default=5.0, help="regression threshold in percent")
+    s.add_argument("--save-as", default="", help="also store the new runs as a baseline")
+    s.set_defaults(func=cmd_compare)
+
+    s = sub.add_parser("import", help="make a replay baseline from existing engine bench lines")
+    s.add_argument("name")
+    s.add_argument("--jsonl", required=True)
+    s.add_argument("--last", type=int, default=0)
+    s.set_defaults(func=cmd_import)
+
+    s = sub.add_parser("show", help="print a stored baseline")
+    s.add_argument("name")
+    s.set_defaults(func=cmd_show)
+
+    args = p.parse_args()
+    if args.runs < 2 and args.cmd in ("baseline", "compare"):
+        print("[bench_compare] --runs must be >= 2 for confidence intervals", file=sys.stderr)
+        return 2
+    try:
+        return args.func(args)
+    except (RuntimeError, subprocess.CalledProcessError, subprocess.TimeoutExpired) as e:
+        print(f"[bench_compare] error: {e}", file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
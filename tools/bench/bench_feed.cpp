@@ -0,0 +1,64 @@
+// Feed writer benchmark: JsonlWriter::write_feed throughput for the snapshot
+// feed (frontend/public/snapshots_feed.jsonl in the engine).
+#include "bench_common.hpp"
+#include "mbo/jsonl_writer.hpp"
+#include "mbo/mbo_order_book.hpp"
+
+#include <cstdio>
+#include <filesystem>
+
+int main(int argc, char** argv) {
+    bench::Options o;
+    int iters = 20'000; // lines per rep
+    int depth = 50;
+    std::string out_path = "/tmp/bench_feed.jsonl";
+
+    for (int i = 1; i < argc; ++i) {
+        if (bench::parse_common_arg(i, argc, argv, o)) continue;
+        std::string a = argv[i];
+        if (a == "--iters" && i + 1 < argc) iters = std::stoi(argv[++i]);
+        else if (a == "--depth" && i + 1 < argc) depth = std::stoi(argv[++i]);
+        else if (a == "--out" && i + 1 < argc) out_path = argv[++i];
+        else if (a == "--help") {
+            bench::print_common_usage("bench_feed", " [--iters N] [--depth D] [--out /tmp/bench_feed.jsonl]");
+            return 0;
+        }
+    }
+
+    std::vector<MboEvent> events;
+    if (!bench::load_events(o, events)) return 1;
+    const std::string sym = o.symbol.empty() ? "CLX5" : o.symbol;
+    MboOrderBook book(sym);
+    for (const auto& e : events) book.apply(e);
+
+    mbo::FeedLine fl;
+    fl.ts_us = 1'758'742'200'000'000;
+    fl.symbol = sym;
+    fl.depth = depth;
+    fl.book_json = book.to_json(depth);
+
+    // truncate per rep so the file does not grow across reps
+    uint64_t bytes = 0;
+    auto r = bench::run("feed", "write_feed", o, [&](bench::Result&) -> uint64_t {
+        {
+            mbo::JsonlWriter w(out_path, /*append=*/false);
+            for (int k = 0; k < iters; ++k) {
+                fl.processed = k;
+                w.write_feed(fl);
+            }
+            w.flush();
+        }
+        std::error_code ec;
+        bytes = (uint64_t)std::filesystem::file_size(out_path, ec);
+        return (uint64_t)iters;
+    });
+
+    const double p50_s = (double)bench::percentile(r.rep_ns, 50) / 1e9;
+    r.add("book_bytes", (double)fl.book_json.size());
+    r.add("bytes_per_rep", (double)bytes);
+    r.add("mb_per_s_p50", p50_s > 0 ? (double)bytes / 1e6 / p50_s : 0.0);
+    bench::emit(r, o);
+
+    std::remove(out_path.c_str());
+    return bench::exit_code();
+}
@@ -0,0 +1,128 @@
+// Event journal benchmark.
+//   write:  stage + commit in --batch sized chunks (one socket read each) and
+//           flush, i.e. until the writer thread has copied everything into the
+//           mapped segments; "producer_ns_per_item" is the ingest-side share
+//   replay: JournalReader + replay_journal into a fresh book, against applying
+//           the same events from memory (apply)
+// Segments are --segment_records long (small by default, to exercise rotation)
+// and go to a scratch directory under /tmp that is removed at exit.
+#include "bench_common.hpp"
+#include "mbo/event_journal.hpp"
+#include "mbo/mbo_order_book.hpp"
+#include "mbo/timestamp.hpp"
+
+#include <cstdlib>
+#include <unistd.h>
+
+static void remove_segments(const std::string& dir) {
+    std::vector<mbo::JournalSegment> segs;
+    std::string err;
+    if (mbo::list_journal_segments(dir, segs, err)) {
+        for (const auto& s : segs) ::unlink(s.path.c_str());
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::Options o;
+    size_t batch = 256;
+    size_t segment_records = 1u << 16;
+
+    for (int i = 1; i < argc; ++i) {
+        if (bench::parse_common_arg(i, argc, argv, o)) continue;
+        std::string a = argv[i];
+        if (a == "--batch" && i + 1 < argc) batch = std::max(1, std::stoi(argv[++i]));
+        else if (a == "--segment_records" && i + 1 < argc) segment_records = std::max(1LL, std::stoll(argv[++i]));
+        else if (a == "--help") {
+            bench::print_common_usage("bench_journal", " [--batch 256] [--segment_records 65536]");
+            return 0;
+        }
+    }
+
+    std::vector<MboEvent> events;
+    if (!bench::load_events(o, events)) return 1;
+    std::vector<mbo::MboRecord> recs(events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        int64_t recv_ns = 0, event_ns = 0;
+        mbo::parse_iso8601_ns(events[i].ts_recv, recv_ns);
+        mbo::parse_iso8601_ns(events[i].ts_event, event_ns);
+        mbo::record_from_event(events[i], recv_ns, event_ns, recs[i]);
+    }
+
+    char tmpl[] = "/tmp/bench_journal_XXXXXX";
+    if (!::mkdtemp(tmpl)) {
+        std::cerr << "[bench_journal] mkdtemp failed\n";
+        return 1;
+    }
+    const std::string dir = tmpl;
+    mbo::EventJournalOptions jo;
+    jo.dir = dir;
+    jo.segment_records = segment_records;
+    jo.sync_on_rotate = false;   // measures the append path, not the disk
+
+    // ---- write ----
+    uint64_t producer_ns = 0, segments = 0;
+    auto wr = bench::run("journal", "write", o, [&](bench::Result&) -> uint64_t {
+        remove_segments(dir);
+        mbo::EventJournal j;
+        std::string err;
+        if (!j.open(jo, err)) {
+            std::cerr << "[bench_journal] " << err << "\n";
+            bench::failed_flag() = true;
+            return 0;
+        }
+        const auto t0 = bench::Clock::now();
+        for (size_t i = 0; i < recs.size(); ++i) {
+            j.stage() = recs[i];
+            if ((i + 1) % batch == 0) j.commit();
+        }
+        j.commit();
+        producer_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(bench::Clock::now() - t0).count();
+        j.flush();
+        segments = j.segments_opened();
+        bench::do_not_optimize(j);
+        return (uint64_t)recs.size();
+    });
+    wr.add("producer_ns_per_item", recs.empty() ? 0.0 : (double)producer_ns / (double)recs.size());
+    wr.add("segments", (double)segments);
+    wr.add("batch", (double)batch);
+    bench::emit(wr, o);
+
+    // the journal from the last write rep stays on disk for the replay
+    mbo::JournalReader reader;
+    std::string err;
+    if (!reader.open(dir, err) || reader.end_index() != recs.size()) {
+        std::cerr << "[bench_journal] FAIL: journal holds " << reader.end_index() << " of " << recs.size()
+                  << " records " << err << "\n";
+        bench::failed_flag() = true;
+    }
+
+    // ---- replay vs in-memory apply ----
+    const std::string sym = o.symbol.empty() ? "CLX5" : o.symbol;
+    MboOrderBook replayed(sym);
+    auto rp = bench::run("journal", "replay", o, [&](bench::Result&) -> uint64_t {
+        replayed = MboOrderBook(sym);
+        const uint64_t n = mbo::replay_journal(reader, replayed);
+        bench::do_not_optimize(replayed);
+        return n;
+    });
+    rp.add("segments", (double)reader.segments().size());
+    bench::emit(rp, o);
+
+    MboOrderBook applied(sym);
+    auto ap = bench::run("journal", "apply", o, [&](bench::Result&) -> uint64_t {
+        applied = MboOrderBook(sym);
+        for (const auto& e : events) applied.apply(e);
+        bench::do_not_optimize(applied);
+        return (uint64_t)events.size();
+    });
+    bench::emit(ap, o);
+
+    if (replayed.to_json(1'000'000) != applied.to_json(1'000'000)) {
+        std::cerr << "[bench_journal] FAIL: replayed book differs from the applied one\n";
+        bench::failed_flag() = true;
+    }
+
+    remove_segments(dir);
+    ::rmdir(dir.c_str());
+    return bench::exit_code();
+}
@@ -0,0 +1,145 @@
+// Parse-only benchmark: CSV line -> MboEvent, no book involved.
+//
+// Variants:
+//   csv_line     parse_mbo_csv_line over pre-read lines (std::string fields)
+//   csv_record   parse_mbo_csv_record over the same lines (string_view, POD out)
+//   chunked      the same lines, joined into one buffer outside the timed
+//                loop, through parse_csv_buffer_parallel (chunks + reorder
+//                buffer) on --threads parser threads; each rep includes
+//                starting and joining the parser threads
+// Before timing, csv_record output is checked against csv_line +
+// record_from_event, and chunked against csv_record.
+#include "bench_common.hpp"
+#include "mbo/csv_chunk_parser.hpp"
+
+#include <cstring>
+
+static bool same_record(const mbo::MboRecord& a, const mbo::MboRecord& b) {
+    return std::memcmp(&a, &b, sizeof(mbo::MboRecord)) == 0;
+}
+
+static void add_throughput(bench::Result& r, uint64_t bytes) {
+    double p50_s = (double)bench::percentile(r.rep_ns, 50) / 1e9;
+    r.add("bytes_per_rep", (double)bytes);
+    r.add("mb_per_s_p50", p50_s > 0 ? (double)bytes / 1e6 / p50_s : 0.0);
+}
+
+int main(int argc, char** argv) {
+    bench::Options o;
+    unsigned threads = 0;
+    size_t chunk_kb = 4096;
+    for (int i = 1; i < argc; ++i) {
+        if (bench::parse_common_arg(i, argc, argv, o)) continue;
+        std::string a = argv[i];
+        if (a == "--threads" && i + 1 < argc) threads = (unsigned)std::max(0, std::stoi(argv[++i]));
+        else if (a == "--chunk_kb" && i + 1 < argc) chunk_kb = (size_t)std::max(1, std::stoi(argv[++i]));
+        else if (a == "--help") {
+            bench::print_common_usage("bench_parse", " [--threads N] [--chunk_kb 4096]");
+            return 0;
+        }
+    }
+
+    std::vector<std::string> lines;
+    if (!bench::load_lines(o, lines)) return 1;
+
+    uint64_t bytes = 0;
+    for (const auto& l : lines) bytes += l.size() + 1;
+
+    // equivalence: the POD parser must accept and produce exactly what the
+    // line parser + record_from_event do
+    std::vector<mbo::MboRecord> ref;
+    ref.reserve(lines.size());
+    {
+        MboEvent e{};
+        mbo::MboRecord a, b;
+        uint64_t mismatches = 0;
+        for (const auto& l : lines) {
+            const bool ok_a = parse_mbo_csv_line(l, e) && mbo::record_from_event(e, a);
+            const bool ok_b = mbo::parse_mbo_csv_record(l, b);
+            if (ok_a != ok_b || (ok_a && !same_record(a, b))) ++mismatches;
+            if (ok_b) ref.push_back(b);
+        }
+        if (mismatches) {
+            std::cerr << "[bench_parse] csv_record differs from csv_line on " << mismatches << " line(s)\n";
+            bench::failed_flag() = true;
+        }
+    }
+
+    uint64_t failed = 0;
+    auto r = bench::run("parse", "csv_line", o, [&](bench::Result&) -> uint64_t {
+        MboEvent e{};
+        uint64_t ok = 0;
+        failed = 0;
+        for (const auto& l : lines) {
+            if (parse_mbo_csv_line(l, e)) ++ok;
+            else ++failed;
+            bench::do_not_optimize(e);
+        }
+        return ok + failed;
+    });
+    add_throughput(r, bytes);
+    r.add("parse_failed", (double)failed);
+    bench::emit(r, o);
+
+    auto rr = bench::run("parse", "csv_record", o, [&](bench::Result&) -> uint64_t {
+        mbo::MboRecord rec;
+        uint64_t ok = 0;
+        failed = 0;
+        for (const auto& l : lines) {
+            if (mbo::parse_mbo_csv_record(l, rec)) ++ok;
+            else ++failed;
+            bench::do_not_optimize(rec);
+        }
+        return ok + failed;
+    });
+    add_throughput(rr, bytes);
+    rr.add("parse_failed", (double)failed);
+    bench::emit(rr, o);
+
+    // the loaded lines (no header, --max applied) as one CSV buffer
+    std::string buf;
+    buf.reserve(bytes);
+    for (const auto& l : lines) {
+        buf += l;
+        buf += '\n';
+    }
+
+    mbo::ParallelCsvOptions po;
+    po.threads = threads;
+    po.chunk_bytes = chunk_kb << 10;
+    {
+        size_t at = 0;
+        uint64_t mismatches = 0;
+        mbo::parse_csv_buffer_parallel(buf.data(), buf.size(), po, [&](const mbo::MboRecord* recs, size_t n) {
+            for (size_t k = 0; k < n; ++k, ++at) {
+                if (at >= ref.size() || !same_record(recs[k], ref[at])) ++mismatches;
+            }
+            return true;
+        });
+        if (mismatches || at != ref.size()) {
+            std::cerr << "[bench_parse] chunked differs from csv_record: " << mismatches << " mismatch(es), "
+                      << at << "/" << ref.size() << " record(s)\n";
+            bench::failed_flag() = true;
+        }
+    }
+
+    mbo::ParallelCsvStats st;
+    auto rc = bench::run("parse", "chunked", o, [&](bench::Result&) -> uint64_t {
+        uint64_t n_recs = 0;
+        mbo::parse_csv_buffer_parallel(buf.data(), buf.size(), po, [&](const mbo::MboRecord* recs, size_t n) {
+            n_recs += n;
+            bench::do_not_optimize(recs);
+            return true;
+        }, &st);
+        return n_recs;
+    });
+    add_throughput(rc, st.bytes);
+    rc.add("parse_failed", (double)st.bad_lines);
+    rc.add("threads", (double)st.threads);
+    rc.add("chunks", (double)st.chunks);
+    rc.add("chunk_kb", (double)chunk_kb);
+    rc.add("consumer_wait_ms", st.wait_ms);
+    rc.add("parse_ms_summed", st.parse_ms);
+    bench::emit(rc, o);
+    return bench::exit_code();
+}
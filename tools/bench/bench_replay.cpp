@@ -0,0 +1,111 @@
+// End-to-end replay benchmark: the engine's per-line pipeline without the
+// socket. The CSV is held in memory and fed in fixed-size chunks through the
+// same carry/newline framing as tcp_main_ws, then parse -> apply -> every
+// `snapshot_every` events: to_json + publish + top_of_book + feed write.
+#include "bench_common.hpp"
+#include "mbo/jsonl_writer.hpp"
+#include "mbo/mbo_order_book.hpp"
+#include "mbo/snapshot_store.hpp"
+
+#include <cstdio>
+
+int main(int argc, char** argv) {
+    bench::Options o;
+    o.reps = 5;
+    int depth = 50;
+    int64_t snapshot_every = 1000;
+    size_t chunk = 1 << 16;
+    bool feed = true;
+    std::string feed_path = "/tmp/bench_replay_feed.jsonl";
+
+    for (int i = 1; i < argc; ++i) {
+        if (bench::parse_common_arg(i, argc, argv, o)) continue;
+        std::string a = argv[i];
+        if (a == "--depth" && i + 1 < argc) depth = std::stoi(argv[++i]);
+        else if (a == "--snapshot_every" && i + 1 < argc) snapshot_every = std::stoll(argv[++i]);
+        else if (a == "--chunk" && i + 1 < argc) chunk = (size_t)std::stoull(argv[++i]);
+        else if (a == "--no_feed") feed = false;
+        else if (a == "--feed_path" && i + 1 < argc) feed_path = argv[++i];
+        else if (a == "--help") {
+            bench::print_common_usage("bench_replay",
+                " [--depth D] [--snapshot_every N] [--chunk BYTES] [--no_feed] [--feed_path P]");
+            return 0;
+        }
+    }
+    if (chunk == 0) chunk = 1;
+
+    std::vector<std::string> lines;
+    if (!bench::load_lines(o, lines)) return 1;
+    std::string wire;
+    for (const auto& l : lines) { wire.append(l); wire.push_back('\n'); }
+    lines.clear();
+    lines.shrink_to_fit();
+
+    uint64_t snapshots = 0;
+    auto r = bench::run("replay", "in_memory", o, [&](bench::Result&) -> uint64_t {
+        MboOrderBook book(o.symbol);
+        std::string book_symbol = o.symbol;
+        bool has_symbol = !o.symbol.empty();
+
+        mbo::JsonlWriter feed_writer;
+        if (feed) feed_writer.open(feed_path, /*append=*/false);
+
+        std::string carry;
+        carry.reserve(chunk * 2);
+        MboEvent e;
+        int64_t processed = 0;
+        snapshots = 0;
+
+        for (size_t off = 0; off < wire.size(); off += chunk) {
+            carry.append(wire, off, chunk);
+
+            std::size_t pos = 0;
+            while (true) {
+                std::size_t nl = carry.find('\n', pos);
+                if (nl == std::string::npos) {
+                    carry.erase(0, pos);
+                    break;
+                }
+                std::string line = carry.substr(pos, nl - pos);
+                pos = nl + 1;
+
+                if (!parse_mbo_csv_line(line, e)) continue;
+                if (!has_symbol && !e.symbol.empty()) {
+                    book_symbol = e.symbol;
+                    book = MboOrderBook(e.symbol);
+                    has_symbol = true;
+                }
+                book.apply(e);
+                ++processed;
+
+                if (snapshot_every > 0 && (processed % snapshot_every == 0)) {
+                    std::string book_json = book.to_json(depth);
+                    publish_snapshot(book_symbol, book_json);
+                    TopOfBook tob = book.top_of_book();
+                    bench::do_not_optimize(tob);
+                    if (feed_writer.is_open()) {
+                        mbo::FeedLine fl;
+                        fl.ts_us = 1;
+                        fl.symbol = book_symbol;
+                        fl.processed = processed;
+                        fl.depth = depth;
+                        fl.book_json = book_json;
+                        feed_writer.write_feed(fl);
+                    }
+                    ++snapshots;
+                }
+            }
+        }
+        feed_writer.flush();
+        return (uint64_t)processed;
+    });
+
+    r.add("depth", depth);
+    r.add("snapshot_every", (double)snapshot_every);
+    r.add("snapshots_per_rep", (double)snapshots);
+    r.add("chunk_bytes", (double)chunk);
+    bench::emit(r, o);
+
+    if (feed) std::remove(feed_path.c_str());
+    return bench::exit_code();
+}
@@ -0,0 +1,71 @@
+// Snapshot rendering benchmark: to_json at several depths, plus the BBO views,
+// over the book state reached at the end of the input.
+#include "bench_common.hpp"
+#include "mbo/mbo_order_book.hpp"
+
+int main(int argc, char** argv) {
+    bench::Options o;
+    o.reps = 20;
+    int iters = 200; // renders per rep
+    std::vector<int> depths{1, 5, 10, 50, 200};
+
+    for (int i = 1; i < argc; ++i) {
+        if (bench::parse_common_arg(i, argc, argv, o)) continue;
+        std::string a = argv[i];
+        if (a == "--iters" && i + 1 < argc) iters = std::stoi(argv[++i]);
+        else if (a == "--depths" && i + 1 < argc) {
+            depths.clear();
+            std::stringstream ss(argv[++i]);
+            std::string tok;
+            while (std::getline(ss, tok, ',')) if (!tok.empty()) depths.push_back(std::stoi(tok));
+        } else if (a == "--help") {
+            bench::print_common_usage("bench_snapshot", " [--iters N] [--depths 1,5,10,50,200]");
+            return 0;
+        }
+    }
+
+    std::vector<MboEvent> events;
+    if (!bench::load_events(o, events)) return 1;
+
+    MboOrderBook book(o.symbol.empty() ? "CLX5" : o.symbol);
+    for (const auto& e : events) book.apply(e);
+
+    for (int d : depths) {
+        size_t bytes = 0;
+        auto r = bench::run("snapshot", "to_json_d" + std::to_string(d), o,
+                            [&](bench::Result&) -> uint64_t {
+            for (int k = 0; k < iters; ++k) {
+                std::string s = book.to_json(d);
+                bytes = s.size();
+                bench::do_not_optimize(s);
+            }
+            return (uint64_t)iters;
+        });
+        r.add("depth", d);
+        r.add("json_bytes", (double)bytes);
+        bench::emit(r, o);
+    }
+
+    {
+        auto r = bench::run("snapshot", "to_json_bbo", o, [&](bench::Result&) -> uint64_t {
+            for (int k = 0; k < iters; ++k) {
+                std::string s = book.to_json_bbo();
+                bench::do_not_optimize(s);
+            }
+            return (uint64_t)iters;
+        });
+        bench::emit(r, o);
+    }
+
+    {
+        auto r = bench::run("snapshot", "top_of_book", o, [&](bench::Result&) -> uint64_t {
+            for (int k = 0; k < iters; ++k) {
+                TopOfBook t = book.top_of_book();
+                bench::do_not_optimize(t);
+            }
+            return (uint64_t)iters;
+        });
+        bench::emit(r, o);
+    }
+    return bench::exit_code();
+}
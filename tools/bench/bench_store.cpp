@@ -0,0 +1,53 @@
+// Snapshot store benchmark: single-threaded publish/load cost of the
+// symbol -> latest-JSON store shared between the engine and WS threads.
+#include "bench_common.hpp"
+#include "mbo/mbo_order_book.hpp"
+#include "mbo/snapshot_store.hpp"
+
+int main(int argc, char** argv) {
+    bench::Options o;
+    int iters = 100'000; // operations per rep
+    int depth = 50;
+
+    for (int i = 1; i < argc; ++i) {
+        if (bench::parse_common_arg(i, argc, argv, o)) continue;
+        std::string a = argv[i];
+        if (a == "--iters" && i + 1 < argc) iters = std::stoi(argv[++i]);
+        else if (a == "--depth" && i + 1 < argc) depth = std::stoi(argv[++i]);
+        else if (a == "--help") {
+            bench::print_common_usage("bench_store", " [--iters N] [--depth D]");
+            return 0;
+        }
+    }
+
+    // A realistic payload: the final book rendered at the engine's depth.
+    std::vector<MboEvent> events;
+    if (!bench::load_events(o, events)) return 1;
+    const std::string sym = o.symbol.empty() ? "CLX5" : o.symbol;
+    MboOrderBook book(sym);
+    for (const auto& e : events) book.apply(e);
+    const std::string payload = book.to_json(depth);
+
+    {
+        // includes the string copy the engine pays when it publishes book_json
+        auto r = bench::run("store", "publish", o, [&](bench::Result&) -> uint64_t {
+            for (int k = 0; k < iters; ++k) publish_snapshot(sym, payload);
+            return (uint64_t)iters;
+        });
+        r.add("payload_bytes", (double)payload.size());
+        bench::emit(r, o);
+    }
+
+    {
+        auto r = bench::run("store", "load", o, [&](bench::Result&) -> uint64_t {
+            for (int k = 0; k < iters; ++k) {
+                auto p = load_snapshot(sym);
+                bench::do_not_optimize(p);
+            }
+            return (uint64_t)iters;
+        });
+        r.add("payload_bytes", (double)payload.size());
+        bench::emit(r, o);
+    }
+    return bench::exit_code();
+}
@@ -0,0 +1,255 @@
+// Snapshot store contention benchmark: publishers at a configurable rate
+// against N reader threads hammering load_snapshot(symbol), the way the
+// engine thread and thousands of WS sessions share the store.
+//
+// One JSON line per (store, readers) variant:
+//   - op_p*_ns          publisher latency (publish only; the payload copy is
+//                       made outside the timed region)
+//   - items_per_s_p50   reader loads per second (all readers)
+//   - reader_load_p*_ns sampled reader load latency
+//   - reader_*_per_load hardware counters summed over reader threads; L1d /
+//                       LLC misses per load expose cache-line ping-pong on
+//                       shared lock words and refcounts
+//   - "perf"            counters of publisher 0 (the main thread)
+//
+// New SnapshotStore implementations only need a make_snapshot_store() kind to
+// show up here via --stores.
+#include "bench_common.hpp"
+#include "mbo/mbo_order_book.hpp"
+#include "mbo/snapshot_store.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+using bench::Clock;
+
+std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string tok;
+    while (std::getline(ss, tok, ',')) {
+        if (!tok.empty()) out.push_back(tok);
+    }
+    return out;
+}
+
+struct alignas(64) ReaderState {
+    uint64_t loads = 0;
+    mbo::HdrHistogram lat;
+    mbo::PerfTotals perf;
+    bool perf_ok = false;
+};
+
+struct Config {
+    int publishers = 1;
+    double pub_rate = 0.0;  // publishes/s per publisher, 0 = as fast as possible
+    int symbols = 1;
+    double duration_s = 0.5;
+    int sample_every = 64;
+    bool perf = true;
+};
+
+// Publish to `syms` round-robin until `deadline`, pacing at cfg.pub_rate.
+void publisher_loop(SnapshotStore& store, const std::vector<std::string>& syms,
+                    const std::string& payload, const Config& cfg, Clock::time_point deadline,
+                    mbo::HdrHistogram* lat, uint64_t& publishes) {
+    const auto t0 = Clock::now();
+    uint64_t k = 0;
+    while (true) {
+        auto now = Clock::now();
+        if (now >= deadline) break;
+        if (cfg.pub_rate > 0.0) {
+            const auto due = t0 + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>((double)k / cfg.pub_rate));
+            if (now < due) {
+                if (due - now > std::chrono::microseconds(200)) {
+                    std::this_thread::sleep_for(due - now - std::chrono::microseconds(100));
+                }
+                continue;
+            }
+        }
+        std::string s = payload;
+        const std::string& sym = syms[k % syms.size()];
+        auto a = Clock::now();
+        store.publish(sym, std::move(s));
+        auto b = Clock::now();
+        if (lat) lat->record(bench::elapsed_ns(a, b));
+        ++k;
+    }
+    publishes += k;
+}
+
+void reader_loop(const SnapshotStore& store, const std::vector<std::string>& syms, const Config& cfg,
+                 const std::atomic<bool>& stop, ReaderState& st) {
+    mbo::PerfCounters pc;
+    st.perf_ok = cfg.perf && pc.available();
+    mbo::PerfSample c0;
+    if (st.perf_ok) {
+        pc.start();
+        c0 = pc.read();
+    }
+
+    uint64_t n = 0;
+    size_t si = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        const std::string& sym = syms[si];
+        if (++si == syms.size()) si = 0;
+        if (cfg.sample_every > 0 && n % (uint64_t)cfg.sample_every == 0) {
+            auto a = Clock::now();
+            auto p = store.load(sym);
+            auto b = Clock::now();
+            bench::do_not_optimize(p);
+            st.lat.record(bench::elapsed_ns(a, b));
+        } else {
+            auto p = store.load(sym);
+            bench::do_not_optimize(p);
+        }
+        ++n;
+    }
+    st.loads += n;
+
+    if (st.perf_ok) {
+        st.perf.add(c0, pc.read(), n);
+        pc.stop();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options o;
+    o.warmup = 1;
+    o.reps = 5;
+    Config cfg;
+    std::vector<std::string> stores{"shared_mutex", "atomic"};
+    std::vector<int> readers{1, 2, 4, 8};
+    int depth = 50;
+
+    for (int i = 1; i < argc; ++i) {
+        if (bench::parse_common_arg(i, argc, argv, o)) continue;
+        std::string a = argv[i];
+        if (a == "--stores" && i + 1 < argc) stores = split_list(argv[++i]);
+        else if (a == "--readers" && i + 1 < argc) {
+            readers.clear();
+            for (const auto& t : split_list(argv[++i])) readers.push_back(std::stoi(t));
+        }
+        else if (a == "--publishers" && i + 1 < argc) cfg.publishers = std::max(1, std::stoi(argv[++i]));
+        else if (a == "--pub_rate" && i + 1 < argc) cfg.pub_rate = std::stod(argv[++i]);
+        else if (a == "--symbols" && i + 1 < argc) cfg.symbols = std::max(1, std::stoi(argv[++i]));
+        else if (a == "--duration" && i + 1 < argc) cfg.duration_s = std::stod(argv[++i]);
+        else if (a == "--sample_every" && i + 1 < argc) cfg.sample_every = std::stoi(argv[++i]);
+        else if (a == "--depth" && i + 1 < argc) depth = std::stoi(argv[++i]);
+        else if (a == "--help") {
+            bench::print_common_usage("bench_store_contention",
+                " [--stores shared_mutex,atomic] [--readers 1,2,4,8]\n"
+                "       [--publishers N] [--pub_rate PER_S] [--symbols N] [--duration S]\n"
+                "       [--sample_every N] [--depth D]");
+            return 0;
+        }
+    }
+    cfg.perf = o.perf;
+
+    // A realistic payload: the final book rendered at the engine's depth.
+    std::vector<MboEvent> events;
+    if (!bench::load_events(o, events)) return 1;
+    const std::string base = o.symbol.empty() ? "CLX5" : o.symbol;
+    MboOrderBook book(base);
+    for (const auto& e : events) book.apply(e);
+    const std::string payload = book.to_json(depth);
+
+    std::vector<std::string> syms;
+    for (int s = 0; s < cfg.symbols; ++s) syms.push_back(s == 0 ? base : base + "_" + std::to_string(s));
+
+    for (const auto& kind : stores) {
+        auto store = make_snapshot_store(kind);
+        if (!store) {
+            std::cerr << "[bench] unknown store: " << kind << "\n";
+            return 1;
+        }
+        for (const auto& s : syms) store->publish(s, payload);
+
+        for (int nr : readers) {
+            std::vector<ReaderState> rs((size_t)nr);
+            uint64_t publishes = 0;
+            int call = 0;
+
+            auto r = bench::run("store_contention", std::string(kind) + "/r" + std::to_string(nr), o,
+                                [&](bench::Result& res) -> uint64_t {
+                const bool timed = ++call > o.warmup;
+                std::vector<ReaderState> tmp((size_t)nr);
+                std::vector<ReaderState>& st = timed ? rs : tmp;
+                std::vector<uint64_t> reader_before(st.size());
+                for (size_t i = 0; i < st.size(); ++i) reader_before[i] = st[i].loads;
+
+                std::atomic<bool> stop{false};
+                std::vector<std::thread> threads;
+                for (int t = 0; t < nr; ++t) {
+                    threads.emplace_back(reader_loop, std::cref(*store), std::cref(syms), std::cref(cfg),
+                                         std::cref(stop), std::ref(st[(size_t)t]));
+                }
+
+                const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                                         std::chrono::duration<double>(cfg.duration_s));
+                std::vector<uint64_t> extra_pubs((size_t)cfg.publishers, 0);
+                std::vector<std::thread> pubs;
+                for (int p = 1; p < cfg.publishers; ++p) {
+                    pubs.emplace_back([&, p] {
+                        publisher_loop(*store, syms, payload, cfg, deadline, nullptr, extra_pubs[(size_t)p]);
+                    });
+                }
+                uint64_t pub0 = 0;
+                publisher_loop(*store, syms, payload, cfg, deadline, &res.op_hist, pub0);
+                for (auto& t : pubs) t.join();
+                stop.store(true);
+                for (auto& t : threads) t.join();
+
+                if (timed) {
+                    publishes += pub0;
+                    for (auto v : extra_pubs) publishes += v;
+                }
+                uint64_t loads = 0;
+                for (size_t i = 0; i < st.size(); ++i) loads += st[i].loads - reader_before[i];
+                return loads;
+            });
+
+            // aggregate reader samples / counters over timed reps
+            mbo::HdrHistogram lat(o.hist_digits);
+            mbo::PerfTotals rperf;
+            bool rperf_ok = false;
+            uint64_t loads = 0;
+            for (auto& s : rs) {
+                loads += s.loads;
+                lat.merge(s.lat);
+                if (s.perf_ok) {
+                    rperf_ok = true;
+                    for (int e = 0; e < mbo::kPerfEventCount; ++e) rperf.v[e] += s.perf.v[e];
+                    rperf.items += s.perf.items;
+                }
+            }
+            double timed_s = 0.0;
+            for (auto ns : r.rep_ns) timed_s += (double)ns / 1e9;
+
+            r.add("readers", nr);
+            r.add("publishers", cfg.publishers);
+            r.add("pub_rate", cfg.pub_rate);
+            r.add("symbols", cfg.symbols);
+            r.add("payload_bytes", (double)payload.size());
+            r.add("publishes_per_s", timed_s > 0 ? (double)publishes / timed_s : 0.0);
+            r.add("reader_loads_per_s", timed_s > 0 ? (double)loads / timed_s : 0.0);
+            r.add("reader_loads_per_s_per_thread", timed_s > 0 ? (double)loads / timed_s / nr : 0.0);
+            r.add("reader_load_p50_ns", (double)lat.value_at_percentile(50));
+            r.add("reader_load_p99_ns", (double)lat.value_at_percentile(99));
+            r.add("reader_load_p999_ns", (double)lat.value_at_percentile(99.9));
+            r.add("reader_load_max_ns", (double)lat.max());
+            if (rperf_ok) {
+                r.add("reader_cycles_per_load", rperf.per_item(mbo::PerfEvent::Cycles));
+                r.add("reader_l1d_misses_per_load", rperf.per_item(mbo::PerfEvent::L1dMisses));
+                r.add("reader_llc_misses_per_load", rperf.per_item(mbo::PerfEvent::LlcMisses));
+            }
+            bench::emit(r, o);
+        }
+    }
+    return bench::exit_code();
+}
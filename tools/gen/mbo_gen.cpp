@@ -0,0 +1,669 @@
+// Synthetic MBO workload generator.
+//
+// Produces arbitrarily long MBO streams in the same shapes the rest of the
+// repo consumes:
+//   - csv  : Databento CSV layout (streamer, bench_* --path)
+//   - mbob : fixed-size MboRecord binary (bench_* --path x.mbob)
+//   - dbn  : uncompressed DBN v3, MBO schema
+//
+// The model is deliberately simple but every knob that stresses the engine is
+// exposed: number of instruments, resting orders per book, how far from the
+// mid new orders land, order lifetimes (which order a cancel hits), action mix,
+// price random walk, order-id patterns, and bursty inter-arrival times.
+#include "mbo/mbo_record.hpp"
+#include "mbo/timestamp.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using SteadyClock = std::chrono::steady_clock;
+
+struct GenConfig {
+    std::string out_path = "synthetic_mbo.csv";
+    std::string format;               // csv | mbob | dbn (default: from extension)
+    uint64_t events = 1'000'000;
+    int instruments = 1;
+    uint64_t seed = 42;
+
+    // book shape
+    uint64_t orders = 5'000;          // target resting orders per instrument
+    int depth = 50;                   // new orders land within this many ticks of the touch
+    double base_px = 64.83;
+    double tick = 0.01;
+
+    // action mix (add = remainder)
+    double cancel_ratio = 0.45;
+    double modify_ratio = 0.10;
+    double trade_ratio = 0.02;
+
+    // lifetimes (in events of the same instrument) decide which order a cancel hits
+    std::string lifetime = "exp";     // exp | pareto | uniform
+    double mean_life = 2'000.0;
+    double pareto_alpha = 1.5;
+
+    // price random walk of the mid
+    double walk_sigma = 0.5;          // ticks per step
+    uint64_t walk_every = 100;        // events between steps
+
+    // order ids
+    std::string id_pattern = "seq";   // seq | stride | random | reuse
+    uint64_t id_stride = 1'000'003;
+
+    // timestamps: base rate with optional periodic bursts
+    double rate = 50'000.0;           // events / s outside bursts
+    double burst_rate = 0.0;          // events / s inside bursts (0 = no bursts)
+    double burst_every_ms = 5'000.0;
+    double burst_len_ms = 20.0;
+    int64_t start_ns = 0;             // default: 2025-09-24T19:30:00Z
+
+    std::string symbol_prefix = "SYN";
+};
+
+static void usage(const char* prog) {
+    std::cerr
+        << "Usage: " << prog << " [--out synthetic_mbo.csv] [--format csv|mbob|dbn] [--events N]\n"
+        << "  [--instruments K] [--seed S] [--orders N] [--depth D] [--base_px 64.83] [--tick 0.01]\n"
+        << "  [--cancel_ratio 0.45] [--modify_ratio 0.10] [--trade_ratio 0.02]\n"
+        << "  [--lifetime exp|pareto|uniform] [--mean_life EVENTS] [--pareto_alpha A]\n"
+        << "  [--walk_sigma TICKS] [--walk_every N]\n"
+        << "  [--ids seq|stride|random|reuse] [--id_stride N]\n"
+        << "  [--rate EV_PER_S] [--burst RATE:EVERY_MS:LEN_MS] [--start 2025-09-24T19:30:00Z]\n"
+        << "  [--symbol_prefix SYN]\n"
+        << "Example (100M events, 4 books of 250k orders, 2M/s bursts for 20ms every 5s):\n"
+        << "  " << prog << " --out big.csv --events 100000000 --instruments 4 --orders 250000 \\\n"
+        << "      --rate 50000 --burst 2000000:5000:20\n";
+}
+
+static bool parse_args(int argc, char** argv, GenConfig& c) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("missing value for " + a);
+            return argv[++i];
+        };
+        if (a == "--out") c.out_path = next();
+        else if (a == "--format") c.format = next();
+        else if (a == "--events") c.events = std::stoull(next());
+        else if (a == "--instruments") c.instruments = std::stoi(next());
+        else if (a == "--seed") c.seed = std::stoull(next());
+        else if (a == "--orders") c.orders = std::stoull(next());
+        else if (a == "--depth") c.depth = std::stoi(next());
+        else if (a == "--base_px") c.base_px = std::stod(next());
+        else if (a == "--tick") c.tick = std::stod(next());
+        else if (a == "--cancel_ratio") c.cancel_ratio = std::stod(next());
+        else if (a == "--modify_ratio") c.modify_ratio = std::stod(next());
+        else if (a == "--trade_ratio") c.trade_ratio = std::stod(next());
+        else if (a == "--lifetime") c.lifetime = next();
+        else if (a == "--mean_life") c.mean_life = std::stod(next());
+        else if (a == "--pareto_alpha") c.pareto_alpha = std::stod(next());
+        else if (a == "--walk_sigma") c.walk_sigma = std::stod(next());
+        else if (a == "--walk_every") c.walk_every = std::stoull(next());
+        else if (a == "--ids") c.id_pattern = next();
+        else if (a == "--id_stride") c.id_stride = std::stoull(next());
+        else if (a == "--rate") c.rate = std::stod(next());
+        else if (a == "--burst") {
+            std::string v = next();
+            if (std::sscanf(v.c_str(), "%lf:%lf:%lf", &c.burst_rate, &c.burst_every_ms, &c.burst_len_ms) != 3) {
+                std::cerr << "[mbo_gen] bad --burst (want RATE:EVERY_MS:LEN_MS): " << v << "\n";
+                return false;
+            }
+        } else if (a == "--start") {
+            if (!mbo::parse_iso8601_ns(next(), c.start_ns)) {
+                std::cerr << "[mbo_gen] bad --start timestamp\n";
+                return false;
+            }
+        } else if (a == "--symbol_prefix") c.symbol_prefix = next();
+        else if (a == "--help" || a == "-h") { usage(argv[0]); std::exit(0); }
+        else {
+            std::cerr << "[mbo_gen] unknown arg: " << a << "\n";
+            return false;
+        }
+    }
+
+    if (c.format.empty()) {
+        auto ends_with = [&](const char* ext) {
+            std::string e(ext);
+            return c.out_path.size() >= e.size() &&
+                   c.out_path.compare(c.out_path.size() - e.size(), e.size(), e) == 0;
+        };
+        c.format = ends_with(".mbob") ? "mbob" : ends_with(".dbn") ? "dbn" : "csv";
+    }
+    if (c.format != "csv" && c.format != "mbob" && c.format != "dbn") {
+        std::cerr << "[mbo_gen] unknown format: " << c.format << "\n";
+        return false;
+    }
+    if (c.instruments < 1) c.instruments = 1;
+    if (c.depth < 1) c.depth = 1;
+    if (c.rate <= 0) c.rate = 1;
+    if (c.start_ns == 0) mbo::parse_iso8601_ns("2025-09-24T19:30:00Z", c.start_ns);
+    if (c.cancel_ratio + c.modify_ratio + c.trade_ratio > 0.95) {
+        std::cerr << "[mbo_gen] cancel+modify+trade ratios leave no room for adds\n";
+        return false;
+    }
+    return true;
+}
+
+// ----------------------- Output sinks -----------------------
+
+class Sink {
+public:
+    explicit Sink(std::FILE* f) : f_(f) { buf_.reserve(kBuf + 512); }
+    virtual ~Sink() = default;
+    virtual void begin(const GenConfig&, const std::vector<std::string>&, const std::vector<int32_t>&) {}
+    virtual void write(const mbo::MboRecord& r) = 0;
+    virtual void end(int64_t /*last_ts_ns*/) { flush(); }
+
+protected:
+    static constexpr size_t kBuf = 4 << 20;
+
+    void put(const void* p, size_t n) {
+        buf_.append((const char*)p, n);
+        if (buf_.size() >= kBuf) flush();
+    }
+    void flush() {
+        if (!buf_.empty()) std::fwrite(buf_.data(), 1, buf_.size(), f_);
+        buf_.clear();
+    }
+
+    std::FILE* f_;
+    std::string buf_;
+};
+
+// to_chars + trailing separator; the bound leaves room for the separator
+template <typename T>
+static inline char* put_num(char* p, char* end, T v, char sep = ',') {
+    auto res = std::to_chars(p, end - 1, v);
+    *res.ptr = sep;
+    return res.ptr + 1;
+}
+
+class CsvSink : public Sink {
+public:
+    using Sink::Sink;
+
+    void begin(const GenConfig&, const std::vector<std::string>&, const std::vector<int32_t>&) override {
+        static const char hdr[] =
+            "ts_recv,ts_event,rtype,publisher_id,instrument_id,action,side,price,size,"
+            "channel_id,order_id,flags,ts_in_delta,sequence,symbol\n";
+        put(hdr, sizeof(hdr) - 1);
+    }
+
+    void write(const mbo::MboRecord& r) override {
+        char line[256];
+        char* p = line;
+        char* const e = line + sizeof(line);
+
+        p += mbo::format_iso8601_ns(r.ts_recv_ns, p); *p++ = ',';
+        p += mbo::format_iso8601_ns(r.ts_event_ns, p); *p++ = ',';
+        p = put_num(p, e, (unsigned)r.rtype);
+        p = put_num(p, e, (unsigned)r.publisher_id);
+        p = put_num(p, e, r.instrument_id);
+        *p++ = r.action; *p++ = ',';
+        *p++ = r.side; *p++ = ',';
+
+        // book fixed-point 1e-4 -> "64.830000000" (9 decimals, like the export)
+        int64_t px = r.price;
+        if (px < 0) { *p++ = '-'; px = -px; }
+        p = put_num(p, e, px / 10000, '.');
+        int64_t frac = px % 10000;
+        for (int k = 3; k >= 0; --k) { p[k] = (char)('0' + frac % 10); frac /= 10; }
+        p += 4;
+        std::memcpy(p, "00000,", 6); p += 6;
+
+        p = put_num(p, e, r.size);
+        p = put_num(p, e, (unsigned)r.channel_id);
+        p = put_num(p, e, r.order_id);
+        p = put_num(p, e, r.flags);
+        p = put_num(p, e, r.ts_in_delta);
+        p = put_num(p, e, r.sequence);
+        const size_t sl = strnlen(r.symbol, sizeof(r.symbol));
+        std::memcpy(p, r.symbol, sl); p += sl;
+        *p++ = '\n';
+
+        put(line, (size_t)(p - line));
+    }
+};
+
+class MbobSink : public Sink {
+public:
+    using Sink::Sink;
+
+    void begin(const GenConfig&, const std::vector<std::string>&, const std::vector<int32_t>&) override {
+        mbo::MboFileHeader h;
+        put(&h, sizeof(h));
+    }
+
+    void write(const mbo::MboRecord& r) override { put(&r, sizeof(r)); }
+};
+
+// Uncompressed DBN v3 (MBO schema), laid out like Databento's own files.
+class DbnSink : public Sink {
+public:
+    using Sink::Sink;
+
+    void begin(const GenConfig& c, const std::vector<std::string>& symbols,
+               const std::vector<int32_t>& ids) override {
+        constexpr size_t kSym = 71; // symbol_cstr_len in v3
+
+        std::string m;
+        auto u8 = [&](uint8_t v) { m.push_back((char)v); };
+        auto u16 = [&](uint16_t v) { m.append((const char*)&v, 2); };
+        auto u32 = [&](uint32_t v) { m.append((const char*)&v, 4); };
+        auto u64 = [&](uint64_t v) { m.append((const char*)&v, 8); };
+        auto cstr = [&](const std::string& s, size_t n) {
+            std::string f(n, '\0');
+            std::memcpy(&f[0], s.data(), std::min(s.size(), n - 1));
+            m += f;
+        };
+
+        cstr("SYNTH", 16);                    // dataset
+        u16(0);                               // schema = mbo
+        end_offset_ = 8 + m.size() + 8;       // where "end" lives, patched in end()
+        u64((uint64_t)c.start_ns);            // start
+        u64(UINT64_MAX);                      // end (undef until end())
+        u64(0);                               // limit
+        u8(1);                                // stype_in = raw_symbol
+        u8(0);                                // stype_out = instrument_id
+        u8(0);                                // ts_out
+        u16((uint16_t)kSym);
+        m.append(53, '\0');                   // reserved
+        u32(0);                               // schema_definition_length
+
+        u32((uint32_t)symbols.size());
+        for (const auto& s : symbols) cstr(s, kSym);
+        u32(0);                               // partial
+        u32(0);                               // not_found
+
+        const uint32_t d0 = yyyymmdd(c.start_ns);
+        const uint32_t d1 = yyyymmdd(c.start_ns + 86'400'000'000'000LL);
+        u32((uint32_t)symbols.size());        // mappings
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            cstr(symbols[i], kSym);
+            u32(1);
+            u32(d0);
+            u32(d1);
+            cstr(std::to_string(ids[i]), kSym);
+        }
+        while (m.size() % 8) m.push_back('\0');
+
+        const char magic[4] = {'D', 'B', 'N', 3};
+        const uint32_t len = (uint32_t)m.size();
+        put(magic, 4);
+        put(&len, 4);
+        put(m.data(), m.size());
+    }
+
+    void write(const mbo::MboRecord& r) override {
+#pragma pack(push, 1)
+        struct DbnMbo {
+            uint8_t length;        // in 4-byte units
+            uint8_t rtype;
+            uint16_t publisher_id;
+            uint32_t instrument_id;
+            uint64_t ts_event;
+            uint64_t order_id;
+            int64_t price;         // 1e-9
+            uint32_t size;
+            uint8_t flags;
+            uint8_t channel_id;
+            char action;
+            char side;
+            uint64_t ts_recv;
+            int32_t ts_in_delta;
+            uint32_t sequence;
+        } d;
+#pragma pack(pop)
+        static_assert(sizeof(DbnMbo) == 56, "DBN MBO record is 56 bytes");
+
+        d.length = sizeof(DbnMbo) / 4;
+        d.rtype = r.rtype;
+        d.publisher_id = r.publisher_id;
+        d.instrument_id = (uint32_t)r.instrument_id;
+        d.ts_event = (uint64_t)r.ts_event_ns;
+        d.order_id = (uint64_t)r.order_id;
+        d.price = r.price * 100'000; // 1e-4 -> 1e-9
+        d.size = (uint32_t)r.size;
+        d.flags = (uint8_t)r.flags;
+        d.channel_id = r.channel_id;
+        d.action = r.action;
+        d.side = r.side;
+        d.ts_recv = (uint64_t)r.ts_recv_ns;
+        d.ts_in_delta = r.ts_in_delta;
+        d.sequence = (uint32_t)r.sequence;
+        put(&d, sizeof(d));
+    }
+
+    void end(int64_t last_ts_ns) override {
+        flush();
+        const uint64_t e = (uint64_t)last_ts_ns + 1;
+        if (std::fseek(f_, (long)end_offset_, SEEK_SET) == 0) {
+            std::fwrite(&e, sizeof(e), 1, f_);
+        }
+        std::fseek(f_, 0, SEEK_END);
+    }
+
+private:
+    static uint32_t yyyymmdd(int64_t ns) {
+        const std::string iso = mbo::iso8601_ns(ns);
+        return (uint32_t)std::stoul(iso.substr(0, 4) + iso.substr(5, 2) + iso.substr(8, 2));
+    }
+
+    size_t end_offset_ = 0;
+};
+
+// ----------------------- Book model -----------------------
+
+struct LiveOrder {
+    int64_t id;
+    int64_t px_ticks;
+    int32_t size;
+    char side;
+};
+
+struct Instrument {
+    int32_t instrument_id = 0;
+    std::string symbol;
+    int64_t mid_ticks = 0;
+    uint64_t sequence = 0;
+    uint64_t local_events = 0;
+
+    std::vector<LiveOrder> live;                     // swap-remove
+    std::unordered_map<int64_t, size_t> pos;         // id -> index in live
+    // (expiry, id) min-heap; stale entries are skipped lazily
+    std::priority_queue<std::pair<uint64_t, int64_t>,
+                        std::vector<std::pair<uint64_t, int64_t>>,
+                        std::greater<>> expiry;
+    std::vector<int64_t> free_ids;                   // --ids reuse: cancelled ids, LIFO
+};
+
+class Generator {
+public:
+    Generator(const GenConfig& c, Sink& sink)
+        : c_(c), sink_(sink), rng_(c.seed) {
+        tick_1e4_ = std::max<int64_t>(1, llround(c.tick * 10000.0));
+        const int64_t base_ticks = llround(c.base_px / c.tick);
+
+        books_.resize((size_t)c.instruments);
+        for (int i = 0; i < c.instruments; ++i) {
+            auto& b = books_[(size_t)i];
+            b.instrument_id = 1000 + i;
+            b.symbol = c.symbol_prefix + std::to_string(i);
+            b.mid_ticks = base_ticks + i * 10;
+            b.live.reserve((size_t)std::min<uint64_t>(c.orders + 1024, 1u << 26));
+            b.pos.reserve((size_t)std::min<uint64_t>(c.orders + 1024, 1u << 26));
+            symbols_.push_back(b.symbol);
+            ids_.push_back(b.instrument_id);
+        }
+        next_id_ = 8'000'000'000'000LL;
+        ts_ns_ = c.start_ns;
+    }
+
+    void run() {
+        sink_.begin(c_, symbols_, ids_);
+
+        auto t0 = SteadyClock::now();
+        uint64_t emitted = 0;
+        while (emitted < c_.events) {
+            auto& b = books_[(size_t)(c_.instruments == 1 ? 0 : pick(c_.instruments))];
+            emitted += step(b, c_.events - emitted);
+
+            if (emitted / 10'000'000 != progress_) {
+                progress_ = emitted / 10'000'000;
+                double s = std::chrono::duration<double>(SteadyClock::now() - t0).count();
+                std::cerr << "[mbo_gen] " << emitted << " events (" << (uint64_t)(emitted / s) << " ev/s)\n";
+            }
+        }
+        sink_.end(ts_ns_);
+
+        double secs = std::chrono::duration<double>(SteadyClock::now() - t0).count();
+        uint64_t live = 0;
+        for (const auto& b : books_) live += b.live.size();
+        std::cerr << "[mbo_gen] wrote " << emitted << " events to " << c_.out_path
+                  << " (" << c_.format << ") in " << secs << " s\n"
+                  << "[mbo_gen] adds=" << n_add_ << " cancels=" << n_cancel_
+                  << " modifies=" << n_modify_ << " trades=" << n_trade_
+                  << " resting_at_end=" << live << " max_resting=" << max_live_ << "\n";
+    }
+
+private:
+    uint64_t pick(uint64_t n) { return std::uniform_int_distribution<uint64_t>(0, n - 1)(rng_); }
+    double uni() { return std::uniform_real_distribution<double>(0.0, 1.0)(rng_); }
+
+    uint64_t sample_life() {
+        const double m = std::max(1.0, c_.mean_life);
+        if (c_.lifetime == "uniform") return 1 + pick((uint64_t)(2 * m));
+        if (c_.lifetime == "pareto") {
+            // heavy tail: most orders die fast, a few rest for a very long time
+            const double a = std::max(1.01, c_.pareto_alpha);
+            const double xm = m * (a - 1.0) / a;
+            return 1 + (uint64_t)(xm / std::pow(1.0 - uni(), 1.0 / a));
+        }
+        return 1 + (uint64_t)std::exponential_distribution<double>(1.0 / m)(rng_);
+    }
+
+    int64_t new_order_id(Instrument& b) {
+        if (c_.id_pattern == "stride") return next_id_ += (int64_t)c_.id_stride;
+        if (c_.id_pattern == "random") {
+            int64_t id;
+            do { id = (int64_t)(rng_() >> 1); } while (b.pos.count(id));
+            return id;
+        }
+        if (c_.id_pattern == "reuse" && !b.free_ids.empty()) {
+            int64_t id = b.free_ids.back();
+            b.free_ids.pop_back();
+            if (!b.pos.count(id)) return id;
+        }
+        return ++next_id_;
+    }
+
+    void advance_time() {
+        double r = c_.rate;
+        if (c_.burst_rate > 0) {
+            const double every = c_.burst_every_ms * 1e6;
+            const double t = std::fmod((double)(ts_ns_ - c_.start_ns), every);
+            if (t < c_.burst_len_ms * 1e6) r = c_.burst_rate;
+        }
+        ts_ns_ += 1 + (int64_t)std::exponential_distribution<double>(r / 1e9)(rng_);
+    }
+
+    mbo::MboRecord base(Instrument& b, char action, char side) {
+        advance_time();
+        mbo::MboRecord r;
+        r.ts_event_ns = ts_ns_;
+        r.ts_in_delta = 10'000 + (int32_t)pick(15'000);
+        // capture time is monotonic like a real ts_recv-ordered export
+        last_recv_ns_ = std::max(last_recv_ns_ + 1, ts_ns_ + r.ts_in_delta + (int64_t)pick(500));
+        r.ts_recv_ns = last_recv_ns_;
+        r.publisher_id = 1;
+        r.instrument_id = b.instrument_id;
+        r.action = action;
+        r.side = side;
+        r.flags = 128;
+        r.sequence = ++b.sequence;
+        set_record_symbol(r, b.symbol);
+        return r;
+    }
+
+    void emit(const mbo::MboRecord& r) { sink_.write(r); }
+
+    void remove_live(Instrument& b, size_t idx) {
+        const int64_t id = b.live[idx].id;
+        b.pos.erase(id);
+        if (idx + 1 != b.live.size()) {
+            b.live[idx] = b.live.back();
+            b.pos[b.live[idx].id] = idx;
+        }
+        b.live.pop_back();
+        if (c_.id_pattern == "reuse") b.free_ids.push_back(id);
+    }
+
+    uint64_t do_add(Instrument& b) {
+        const char side = (uni() < 0.5) ? 'B' : 'A';
+        // distance from the touch: mostly near, geometric-ish tail out to `depth`
+        const int64_t off = std::min<int64_t>(
+            c_.depth - 1, (int64_t)std::exponential_distribution<double>(4.0 / c_.depth)(rng_));
+        const int64_t px = (side == 'B') ? b.mid_ticks - 1 - off : b.mid_ticks + 1 + off;
+
+        LiveOrder o{new_order_id(b), std::max<int64_t>(1, px), 1 + (int32_t)pick(20), side};
+        b.pos[o.id] = b.live.size();
+        b.live.push_back(o);
+        b.expiry.emplace(b.local_events + sample_life(), o.id);
+        max_live_ = std::max<uint64_t>(max_live_, b.live.size());
+
+        auto r = base(b, 'A', side);
+        r.order_id = o.id;
+        r.price = o.px_ticks * tick_1e4_;
+        r.size = o.size;
+        emit(r);
+        ++n_add_;
+        return 1;
+    }
+
+    // cancel the live order whose lifetime ends first
+    uint64_t do_cancel(Instrument& b) {
+        while (!b.expiry.empty()) {
+            auto [exp, id] = b.expiry.top();
+            b.expiry.pop();
+            auto it = b.pos.find(id);
+            if (it == b.pos.end()) continue; // already gone
+            (void)exp;
+
+            const LiveOrder o = b.live[it->second];
+            remove_live(b, it->second);
+
+            auto r = base(b, 'C', o.side);
+            r.order_id = o.id;
+            r.price = o.px_ticks * tick_1e4_;
+            r.size = o.size;
+            emit(r);
+            ++n_cancel_;
+            return 1;
+        }
+        return do_add(b);
+    }
+
+    uint64_t do_modify(Instrument& b) {
+        if (b.live.empty()) return do_add(b);
+        LiveOrder& o = b.live[(size_t)pick(b.live.size())];
+        if (uni() < 0.5) {
+            o.size = 1 + (int32_t)pick(20);                       // size change
+        } else {
+            const int64_t d = 1 + (int64_t)pick(3);               // price change, lose priority
+            o.px_ticks = std::max<int64_t>(1, o.side == 'B' ? o.px_ticks - d : o.px_ticks + d);
+        }
+        auto r = base(b, 'M', o.side);
+        r.order_id = o.id;
+        r.price = o.px_ticks * tick_1e4_;
+        r.size = o.size;
+        emit(r);
+        ++n_modify_;
+        return 1;
+    }
+
+    // trade print + fill + (partial) cancel of the resting order
+    uint64_t do_trade(Instrument& b, uint64_t budget) {
+        if (b.live.empty() || budget < 3) return do_add(b);
+        const size_t idx = (size_t)pick(b.live.size());
+        LiveOrder o = b.live[idx];
+        const int32_t fill = 1 + (int32_t)pick((uint64_t)o.size);
+
+        auto t = base(b, 'T', o.side == 'B' ? 'A' : 'B');
+        t.price = o.px_ticks * tick_1e4_;
+        t.size = fill;
+        emit(t);
+
+        auto f = base(b, 'F', o.side);
+        f.order_id = o.id;
+        f.price = t.price;
+        f.size = fill;
+        emit(f);
+
+        auto c = base(b, 'C', o.side);
+        c.order_id = o.id;
+        c.price = t.price;
+        c.size = fill;
+        emit(c);
+
+        if (fill >= o.size) remove_live(b, idx);
+        else b.live[idx].size -= fill;
+        ++n_trade_;
+        return 3;
+    }
+
+    uint64_t step(Instrument& b, uint64_t budget) {
+        b.local_events++;
+        if (c_.walk_every > 0 && (b.local_events % c_.walk_every) == 0 && c_.walk_sigma > 0) {
+            const double d = std::normal_distribution<double>(0.0, c_.walk_sigma)(rng_);
+            b.mid_ticks = std::max<int64_t>(c_.depth + 2, b.mid_ticks + llround(d));
+        }
+
+        // keep the book near its target size; the action mix applies in between
+        const uint64_t n = b.live.size();
+        if (n < c_.orders * 9 / 10 || n == 0) return do_add(b);
+        if (n > c_.orders * 11 / 10 + 1) return do_cancel(b);
+
+        const double u = uni();
+        if (u < c_.cancel_ratio) return do_cancel(b);
+        if (u < c_.cancel_ratio + c_.modify_ratio) return do_modify(b);
+        if (u < c_.cancel_ratio + c_.modify_ratio + c_.trade_ratio) return do_trade(b, budget);
+        return do_add(b);
+    }
+
+    const GenConfig& c_;
+    Sink& sink_;
+    std::mt19937_64 rng_;
+    std::vector<Instrument> books_;
+    std::vector<std::string> symbols_;
+    std::vector<int32_t> ids_;
+    int64_t tick_1e4_ = 100;
+    int64_t next_id_ = 0;
+    int64_t ts_ns_ = 0;
+    int64_t last_recv_ns_ = 0;
+    uint64_t progress_ = 0;
+    uint64_t max_live_ = 0;
+    uint64_t n_add_ = 0, n_cancel_ = 0, n_modify_ = 0, n_trade_ = 0;
+};
+
+int main(int argc, char** argv) {
+    GenConfig cfg;
+    try {
+        if (!parse_args(argc, argv, cfg)) {
+            usage(argv[0]);
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[mbo_gen] " << e.what() << "\n";
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::FILE* f = std::fopen(cfg.out_path.c_str(), "wb");
+    if (!f) {
+        std::cerr << "[mbo_gen] failed to open: " << cfg.out_path << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<Sink> sink;
+    if (cfg.format == "mbob") sink = std::make_unique<MbobSink>(f);
+    else if (cfg.format == "dbn") sink = std::make_unique<DbnSink>(f);
+    else sink = std::make_unique<CsvSink>(f);
+
+    Generator gen(cfg, *sink);
+    gen.run();
+    sink.reset();
+    std::fclose(f);
+    return 0;
+}
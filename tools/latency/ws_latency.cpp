@@ -0,0 +1,250 @@
+// ws_latency: end-to-end wire -> WebSocket latency probe.
+//
+// Subscribes to tcp_main_ws like the frontend does and, for every frame,
+// reads the publish metadata the engine prefixes to each snapshot:
+//
+//   {"seq":..,"ts_pub_ns":..,"ts_send_ns":..,"ts_apply_ns":..,"symbol":..}
+//
+// ts_send_ns is only present when the streamer runs with STAMP_SEND=1.
+// Reported distributions (all wall clock, so run everything on one host):
+//
+//   send_apply    ts_apply_ns - ts_send_ns   (streamer write -> book updated)
+//   send_publish  ts_pub_ns   - ts_send_ns   (-> snapshot published to the store)
+//   send_client   recv        - ts_send_ns   (-> frame received by this client)
+//   pub_client    recv        - ts_pub_ns    (WS push staleness)
+//
+// send_client is additionally reported corrected for coordinated omission:
+// the client expects one frame every push_ms, so a sample of v > push_ms also
+// stands in for the frames that could not be delivered while it was stuck
+// (v - push_ms, v - 2*push_ms, ...), as HdrHistogram's
+// recordValueWithExpectedInterval does. Distributions are mbo::HdrHistogram
+// (3 significant digits), so long runs stay constant-memory.
+//
+// Usage:
+//   ws_latency [--host 127.0.0.1] [--port 8080] [--symbol CLX5] [--depth 10]
+//              [--push_ms 50] [--duration 30] [--frames N] [--json out.jsonl]
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include "mbo/hdr_histogram.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+using boost::asio::ip::tcp;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    std::string symbol = "CLX5";
+    int depth = 10;
+    int push_ms = 50;
+    double duration_s = 30.0;
+    long long frames = -1;   // -1 = until duration elapses / server closes
+    std::string json_out;    // empty => stdout
+};
+
+static void usage(const char* prog) {
+    std::cout
+        << "Usage: " << prog << " [--host 127.0.0.1] [--port 8080] [--symbol CLX5] [--depth 10]\n"
+        << "       [--push_ms 50] [--duration 30] [--frames N] [--json out.jsonl]\n";
+}
+
+static inline int64_t now_wall_ns() {
+    using namespace std::chrono;
+    return (int64_t)duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// Metadata sits at the front of the frame; only scan that prefix.
+static bool find_i64(const std::string& s, const char* key, int64_t& out) {
+    const size_t lim = std::min<size_t>(s.size(), 256);
+    const size_t klen = std::strlen(key);
+    for (size_t i = 0; i + klen + 3 < lim; ++i) {
+        if (s[i] == '"' && s.compare(i + 1, klen, key) == 0 && s[i + 1 + klen] == '"' &&
+            s[i + 2 + klen] == ':') {
+            out = std::strtoll(s.c_str() + i + 3 + klen, nullptr, 10);
+            return true;
+        }
+    }
+    return false;
+}
+
+struct Dist {
+    std::string name;
+    mbo::HdrHistogram h;
+
+    void add(int64_t ns) { if (ns >= 0) h.record((uint64_t)ns); }
+
+    // coordinated-omission corrected record (expected interval in ns)
+    void add_corrected(int64_t ns, int64_t interval) {
+        add(ns);
+        if (interval <= 0) return;
+        for (int64_t missing = ns - interval; missing >= interval; missing -= interval) add(missing);
+    }
+
+    double pct_us(double p) const { return (double)h.value_at_percentile(p) / 1e3; }
+
+    void to_json(std::ostream& os) const {
+        os << "\"" << name << "\":{\"samples\":" << h.count();
+        if (h.count() > 0) {
+            os << ",\"p50_us\":" << pct_us(50)
+               << ",\"p90_us\":" << pct_us(90)
+               << ",\"p99_us\":" << pct_us(99)
+               << ",\"p999_us\":" << pct_us(99.9)
+               << ",\"max_us\":" << (double)h.max() / 1e3;
+        }
+        os << "}";
+    }
+
+    void print(std::ostream& os) const {
+        os << "  " << name << ": n=" << h.count();
+        if (h.count() > 0) {
+            os << " p50=" << pct_us(50) << "us p99=" << pct_us(99)
+               << "us p99.9=" << pct_us(99.9) << "us max=" << (double)h.max() / 1e3 << "us";
+        }
+        os << "\n";
+    }
+};
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--host" && i + 1 < argc) o.host = argv[++i];
+        else if (a == "--port" && i + 1 < argc) o.port = std::stoi(argv[++i]);
+        else if (a == "--symbol" && i + 1 < argc) o.symbol = argv[++i];
+        else if (a == "--depth" && i + 1 < argc) o.depth = std::stoi(argv[++i]);
+        else if (a == "--push_ms" && i + 1 < argc) o.push_ms = std::stoi(argv[++i]);
+        else if (a == "--duration" && i + 1 < argc) o.duration_s = std::stod(argv[++i]);
+        else if (a == "--frames" && i + 1 < argc) o.frames = std::stoll(argv[++i]);
+        else if (a == "--json" && i + 1 < argc) o.json_out = argv[++i];
+        else { usage(argv[0]); return (a == "--help" || a == "-h") ? 0 : 1; }
+    }
+
+    Dist send_apply{"send_apply", mbo::HdrHistogram()};
+    Dist send_publish{"send_publish", mbo::HdrHistogram()};
+    Dist send_client{"send_client", mbo::HdrHistogram()};
+    Dist send_client_co{"send_client_co", mbo::HdrHistogram()};
+    Dist pub_client{"pub_client", mbo::HdrHistogram()};
+
+    long long frames = 0, unstamped = 0, seq_restarts = 0;
+    int64_t last_seq = -1;
+    uint64_t bytes = 0;
+
+    try {
+        boost::asio::io_context ioc;
+        tcp::resolver resolver(ioc);
+        websocket::stream<beast::tcp_stream> ws(ioc);
+
+        auto results = resolver.resolve(o.host, std::to_string(o.port));
+        beast::get_lowest_layer(ws).connect(results);
+        beast::get_lowest_layer(ws).socket().set_option(tcp::no_delay(true));
+        ws.handshake(o.host, "/");
+
+        std::ostringstream sub;
+        sub << "{\"type\":\"subscribe\",\"symbol\":\"" << o.symbol << "\",\"depth\":" << o.depth
+            << ",\"push_ms\":" << o.push_ms << "}";
+        ws.text(true);
+        ws.write(boost::asio::buffer(sub.str()));
+        std::cerr << "[ws_latency] subscribed " << sub.str() << "\n";
+
+        const int64_t interval_ns = (int64_t)o.push_ms * 1'000'000;
+        const auto deadline = std::chrono::steady_clock::now() +
+                              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double>(o.duration_s));
+        // the tcp_stream deadline only applies to async operations, so each
+        // read is an async_read driven to completion: a quiet server can't
+        // hold the tool past --duration
+        beast::get_lowest_layer(ws).expires_at(deadline);
+
+        beast::flat_buffer buf;
+        std::string msg;
+        while (o.frames < 0 || frames < o.frames) {
+            if (std::chrono::steady_clock::now() >= deadline) break;
+            buf.clear();
+            beast::error_code ec;
+            ws.async_read(buf, [&](beast::error_code e, std::size_t) { ec = e; });
+            ioc.restart();
+            ioc.run();
+            const int64_t recv_ns = now_wall_ns();
+            if (ec) {
+                if (ec != beast::error::timeout && ec != websocket::error::closed) {
+                    std::cerr << "[ws_latency] read: " << ec.message() << "\n";
+                }
+                break;
+            }
+            msg = beast::buffers_to_string(buf.data());
+            bytes += msg.size();
+
+            int64_t seq = 0, pub_ns = 0, send_ns = 0, apply_ns = 0;
+            if (!find_i64(msg, "seq", seq) || !find_i64(msg, "ts_pub_ns", pub_ns)) continue; // ack etc.
+            ++frames;
+            if (last_seq >= 0 && seq < last_seq) seq_restarts++;  // engine started a new session
+            last_seq = seq;
+
+            pub_client.add(recv_ns - pub_ns);
+            if (!find_i64(msg, "ts_send_ns", send_ns) || send_ns <= 0) { ++unstamped; continue; }
+            find_i64(msg, "ts_apply_ns", apply_ns);
+
+            send_apply.add(apply_ns - send_ns);
+            send_publish.add(pub_ns - send_ns);
+            send_client.add(recv_ns - send_ns);
+            send_client_co.add_corrected(recv_ns - send_ns, interval_ns);
+        }
+
+        beast::error_code ec;
+        beast::get_lowest_layer(ws).expires_never();
+        ws.close(websocket::close_code::normal, ec);
+    } catch (const std::exception& e) {
+        std::cerr << "[ws_latency] " << e.what() << "\n";
+        if (frames == 0) return 1;
+    }
+
+    std::cerr << "[ws_latency] frames=" << frames << " unstamped=" << unstamped
+              << " bytes=" << bytes << "\n";
+    for (Dist* d : {&send_apply, &send_publish, &send_client, &send_client_co, &pub_client}) {
+        d->print(std::cerr);
+    }
+    if (frames > 0 && unstamped == frames) {
+        std::cerr << "[ws_latency] no ts_send_ns in frames; run the streamer with STAMP_SEND=1\n";
+    }
+
+    std::ostringstream js;
+    js.precision(12);
+    js << "{\"tool\":\"ws_latency\",\"ts_wall_us\":" << now_wall_ns() / 1000
+       << ",\"symbol\":\"" << o.symbol << "\",\"push_ms\":" << o.push_ms
+       << ",\"frames\":" << frames << ",\"unstamped\":" << unstamped
+       << ",\"seq_restarts\":" << seq_restarts
+       << ",\"bytes\":" << bytes << ",";
+    send_apply.to_json(js);      js << ",";
+    send_publish.to_json(js);    js << ",";
+    send_client.to_json(js);     js << ",";
+    send_client_co.to_json(js);  js << ",";
+    pub_client.to_json(js);
+    js << "}";
+
+    if (o.json_out.empty()) {
+        std::cout << js.str() << "\n";
+    } else {
+        std::ofstream ofs(o.json_out, std::ios::binary | std::ios::app);
+        if (!ofs) {
+            std::cerr << "[ws_latency] failed to open json output: " << o.json_out << "\n";
+            std::cout << js.str() << "\n";
+        } else {
+            ofs << js.str() << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,383 @@
+// ws_load: native high-fanout WebSocket load generator for tcp_main_ws.
+//
+// Native counterpart of test/ws_load/ws_load_test.py that scales to tens of
+// thousands of subscriptions: every client is an async Beast session on a
+// shared io_context pool, so the generator itself is not the bottleneck.
+//
+// Each client connects, sends the same subscribe message the frontend sends
+//   {"type":"subscribe","symbol":..,"depth":..,"push_ms":..}
+// and reads frames for --duration seconds. Symbol / depth / push_ms are
+// assigned round-robin from the given lists to build subscription mixes.
+//
+// Per round (one JSON line, appended to --out):
+//   connect time (TCP connect + WS handshake), messages, bytes, msg rate,
+//   staleness = receive wall time - frame ts_pub_ns (engine publish time),
+//   seq_repeats = frames whose seq did not advance (same snapshot resent).
+//
+// Usage:
+//   ws_load [--host 127.0.0.1] [--port 8080] [--path /] [--clients 10,100,1000]
+//           [--symbols CLX5] [--depths 10] [--push_ms 50] [--duration 15]
+//           [--ramp 5] [--threads N] [--out test/ws_load/ws_load_results.jsonl]
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+using SteadyClock = std::chrono::steady_clock;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    std::string path = "/";
+    std::vector<int> rounds{10, 100, 1000};
+    std::vector<std::string> symbols{"CLX5"};
+    std::vector<int> depths{10};
+    std::vector<int> push_ms{50};
+    double duration_s = 15.0;
+    double ramp_s = 5.0;
+    int threads = 0;  // 0 => hardware_concurrency
+    std::string out = "test/ws_load/ws_load_results.jsonl";
+};
+
+static void usage(const char* prog) {
+    std::cout
+        << "Usage: " << prog << " [--host 127.0.0.1] [--port 8080] [--path /] [--clients 10,100,1000]\n"
+        << "       [--symbols CLX5,...] [--depths 10,50] [--push_ms 50,100] [--duration 15]\n"
+        << "       [--ramp 5] [--threads N] [--out test/ws_load/ws_load_results.jsonl]\n";
+}
+
+static std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string tok;
+    while (std::getline(ss, tok, ',')) {
+        if (!tok.empty()) out.push_back(tok);
+    }
+    return out;
+}
+
+static std::vector<int> split_ints(const std::string& s) {
+    std::vector<int> out;
+    for (const auto& t : split_list(s)) out.push_back(std::stoi(t));
+    return out;
+}
+
+static inline int64_t now_wall_ns() {
+    using namespace std::chrono;
+    return (int64_t)duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// Metadata sits at the front of the frame (see make_ws_frame in tcp_main_ws).
+static bool find_i64(const char* s, size_t n, const char* key, int64_t& out) {
+    const size_t lim = std::min<size_t>(n, 256);
+    const size_t klen = std::strlen(key);
+    for (size_t i = 0; i + klen + 3 < lim; ++i) {
+        if (s[i] == '"' && std::memcmp(s + i + 1, key, klen) == 0 && s[i + 1 + klen] == '"' &&
+            s[i + 2 + klen] == ':') {
+            out = std::strtoll(s + i + 3 + klen, nullptr, 10);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Written only from the owning session's strand; read after the pool joins.
+struct ClientStats {
+    bool ok = false;
+    std::string err;
+    double connect_ms = 0.0;
+    uint64_t msgs = 0;
+    uint64_t bytes = 0;
+    uint64_t seq_repeats = 0;
+    int64_t last_seq = -1;
+    std::vector<uint32_t> stale_us;
+};
+
+class Client : public std::enable_shared_from_this<Client> {
+public:
+    Client(net::io_context& ioc, const tcp::resolver::results_type& eps, const Options& o,
+           std::string subscribe, ClientStats& st)
+        : ws_(net::make_strand(ioc)), timer_(ws_.get_executor()), eps_(eps), o_(o),
+          subscribe_(std::move(subscribe)), st_(st) {}
+
+    void start(SteadyClock::duration delay) {
+        timer_.expires_after(delay);
+        timer_.async_wait(beast::bind_front_handler(&Client::on_start, shared_from_this()));
+    }
+
+private:
+    websocket::stream<beast::tcp_stream> ws_;
+    net::steady_timer timer_;
+    const tcp::resolver::results_type& eps_;
+    const Options& o_;
+    std::string subscribe_;
+    ClientStats& st_;
+    SteadyClock::time_point t0_;
+    beast::flat_buffer buf_;
+
+    void fail(const char* what, beast::error_code ec) {
+        st_.ok = false;
+        st_.err = std::string(what) + ": " + ec.message();
+        timer_.cancel();
+    }
+
+    void on_start(beast::error_code ec) {
+        if (ec) return;
+        t0_ = SteadyClock::now();
+        beast::get_lowest_layer(ws_).expires_after(std::chrono::seconds(10));
+        beast::get_lowest_layer(ws_).async_connect(
+            eps_, beast::bind_front_handler(&Client::on_connect, shared_from_this()));
+    }
+
+    void on_connect(beast::error_code ec, const tcp::endpoint&) {
+        if (ec) return fail("connect", ec);
+        beast::get_lowest_layer(ws_).socket().set_option(tcp::no_delay(true));
+        ws_.async_handshake(o_.host, o_.path,
+                            beast::bind_front_handler(&Client::on_handshake, shared_from_this()));
+    }
+
+    void on_handshake(beast::error_code ec) {
+        if (ec) return fail("handshake", ec);
+        st_.connect_ms = std::chrono::duration<double, std::milli>(SteadyClock::now() - t0_).count();
+
+        // Hand timeouts over to the websocket layer; the round deadline ends the read loop.
+        beast::get_lowest_layer(ws_).expires_never();
+        ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::client));
+
+        st_.ok = true;
+        timer_.expires_after(std::chrono::duration_cast<SteadyClock::duration>(
+            std::chrono::duration<double>(o_.duration_s)));
+        timer_.async_wait(beast::bind_front_handler(&Client::on_deadline, shared_from_this()));
+
+        ws_.text(true);
+        ws_.async_write(net::buffer(subscribe_),
+                        beast::bind_front_handler(&Client::on_subscribed, shared_from_this()));
+    }
+
+    void on_subscribed(beast::error_code ec, std::size_t) {
+        if (ec) return fail("subscribe", ec);
+        do_read();
+    }
+
+    void do_read() {
+        ws_.async_read(buf_, beast::bind_front_handler(&Client::on_read, shared_from_this()));
+    }
+
+    void on_read(beast::error_code ec, std::size_t n) {
+        if (ec) {
+            if (ec != net::error::operation_aborted && ec != websocket::error::closed) fail("read", ec);
+            return;
+        }
+        const int64_t recv_ns = now_wall_ns();
+        st_.msgs++;
+        st_.bytes += n;
+
+        const auto data = buf_.cdata();
+        const char* p = static_cast<const char*>(data.data());
+        int64_t seq = 0, pub_ns = 0;
+        if (find_i64(p, data.size(), "seq", seq) && find_i64(p, data.size(), "ts_pub_ns", pub_ns)) {
+            if (seq == st_.last_seq) st_.seq_repeats++;
+            st_.last_seq = seq;
+            const int64_t stale = recv_ns - pub_ns;
+            if (stale >= 0) st_.stale_us.push_back((uint32_t)std::min<int64_t>(stale / 1000, UINT32_MAX));
+        }
+        buf_.consume(buf_.size());
+        do_read();
+    }
+
+    void on_deadline(beast::error_code ec) {
+        if (ec) return;
+        beast::error_code ignore;
+        beast::get_lowest_layer(ws_).socket().shutdown(tcp::socket::shutdown_both, ignore);
+        beast::get_lowest_layer(ws_).socket().close(ignore);
+    }
+};
+
+template <typename T>
+static double pct(std::vector<T>& v, double p) {
+    if (v.empty()) return 0.0;
+    size_t idx = (size_t)((p / 100.0) * (double)(v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + (ptrdiff_t)idx, v.end());
+    return (double)v[idx];
+}
+
+static std::string join(const std::vector<std::string>& v) {
+    std::string s;
+    for (size_t i = 0; i < v.size(); ++i) s += (i ? "," : "") + v[i];
+    return s;
+}
+
+static std::string join(const std::vector<int>& v) {
+    std::string s;
+    for (size_t i = 0; i < v.size(); ++i) s += (i ? "," : "") + std::to_string(v[i]);
+    return s;
+}
+
+// Tens of thousands of sockets need more than the usual 1024 descriptors.
+static void raise_fd_limit(int want) {
+    rlimit rl{};
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0) return;
+    if (rl.rlim_cur >= (rlim_t)want) return;
+    rl.rlim_cur = std::min<rlim_t>(rl.rlim_max, (rlim_t)want);
+    setrlimit(RLIMIT_NOFILE, &rl);
+    getrlimit(RLIMIT_NOFILE, &rl);
+    if (rl.rlim_cur < (rlim_t)want) {
+        std::cerr << "[ws_load] warning: RLIMIT_NOFILE=" << rl.rlim_cur
+                  << " < " << want << " (raise the hard limit for large rounds)\n";
+    }
+}
+
+static std::string run_round(const Options& o, int n) {
+    net::io_context ioc;
+    tcp::resolver resolver(ioc);
+    const auto eps = resolver.resolve(o.host, std::to_string(o.port));
+
+    std::vector<ClientStats> stats((size_t)n);
+    for (int i = 0; i < n; ++i) {
+        const std::string& sym = o.symbols[(size_t)i % o.symbols.size()];
+        const int depth = o.depths[(size_t)(i / o.symbols.size()) % o.depths.size()];
+        const int push = o.push_ms[(size_t)i % o.push_ms.size()];
+        std::ostringstream sub;
+        sub << "{\"type\":\"subscribe\",\"symbol\":\"" << sym << "\",\"depth\":" << depth
+            << ",\"push_ms\":" << push << "}";
+        const double delay_s = (n > 1) ? o.ramp_s * (double)i / (double)(n - 1) : 0.0;
+        std::make_shared<Client>(ioc, eps, o, sub.str(), stats[(size_t)i])
+            ->start(std::chrono::duration_cast<SteadyClock::duration>(std::chrono::duration<double>(delay_s)));
+    }
+
+    const int threads = o.threads > 0 ? o.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    const auto t0 = SteadyClock::now();
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back([&] { ioc.run(); });
+    ioc.run();
+    for (auto& t : pool) t.join();
+    const double wall_s = std::chrono::duration<double>(SteadyClock::now() - t0).count();
+
+    // aggregate
+    int ok = 0, fail = 0;
+    uint64_t msgs = 0, bytes = 0, repeats = 0;
+    std::vector<double> connect_ms;
+    std::vector<uint32_t> stale;
+    std::string sample_error;
+    for (auto& s : stats) {
+        if (!s.ok) {
+            ++fail;
+            if (sample_error.empty()) sample_error = s.err;
+            continue;
+        }
+        ++ok;
+        msgs += s.msgs;
+        bytes += s.bytes;
+        repeats += s.seq_repeats;
+        connect_ms.push_back(s.connect_ms);
+        stale.insert(stale.end(), s.stale_us.begin(), s.stale_us.end());
+        std::vector<uint32_t>().swap(s.stale_us);
+    }
+
+    const double d = o.duration_s;
+    std::ostringstream js;
+    js.precision(12);
+    js << "{\"tool\":\"ws_load\",\"ts_wall_s\":" << (double)now_wall_ns() / 1e9
+       << ",\"clients\":" << n << ",\"ok\":" << ok << ",\"fail\":" << fail
+       << ",\"threads\":" << threads << ",\"duration_s\":" << d << ",\"round_wall_s\":" << wall_s
+       << ",\"symbols\":\"" << join(o.symbols) << "\",\"depths\":\"" << join(o.depths)
+       << "\",\"push_ms\":\"" << join(o.push_ms) << "\""
+       << ",\"total_msgs\":" << msgs << ",\"total_bytes\":" << bytes
+       << ",\"total_mps\":" << (d > 0 ? (double)msgs / d : 0.0)
+       << ",\"total_mbps\":" << (d > 0 ? (double)bytes * 8.0 / (d * 1e6) : 0.0)
+       << ",\"avg_msgs_per_client\":" << (ok ? (double)msgs / ok : 0.0)
+       << ",\"seq_repeats\":" << repeats
+       << ",\"connect_p50_ms\":" << pct(connect_ms, 50)
+       << ",\"connect_p95_ms\":" << pct(connect_ms, 95)
+       << ",\"connect_p99_ms\":" << pct(connect_ms, 99)
+       << ",\"connect_max_ms\":" << pct(connect_ms, 100)
+       << ",\"stale_samples\":" << stale.size()
+       << ",\"stale_p50_ms\":" << pct(stale, 50) / 1e3
+       << ",\"stale_p90_ms\":" << pct(stale, 90) / 1e3
+       << ",\"stale_p99_ms\":" << pct(stale, 99) / 1e3
+       << ",\"stale_max_ms\":" << pct(stale, 100) / 1e3
+       << ",\"sample_error\":";
+    if (sample_error.empty()) js << "null";
+    else js << "\"" << sample_error << "\"";
+    js << "}";
+
+    std::cout << "clients=" << n << " ok=" << ok << " fail=" << fail
+              << " total_mps=" << (d > 0 ? (double)msgs / d : 0.0)
+              << " Mbps=" << (d > 0 ? (double)bytes * 8.0 / (d * 1e6) : 0.0)
+              << " connect_p50=" << pct(connect_ms, 50) << "ms p99=" << pct(connect_ms, 99) << "ms"
+              << " stale_p50=" << pct(stale, 50) / 1e3 << "ms p99=" << pct(stale, 99) / 1e3 << "ms\n";
+    return js.str();
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            if (a == "--host" && i + 1 < argc) o.host = argv[++i];
+            else if (a == "--port" && i + 1 < argc) o.port = std::stoi(argv[++i]);
+            else if (a == "--path" && i + 1 < argc) o.path = argv[++i];
+            else if (a == "--clients" && i + 1 < argc) o.rounds = split_ints(argv[++i]);
+            else if (a == "--symbols" && i + 1 < argc) o.symbols = split_list(argv[++i]);
+            else if (a == "--depths" && i + 1 < argc) o.depths = split_ints(argv[++i]);
+            else if (a == "--push_ms" && i + 1 < argc) o.push_ms = split_ints(argv[++i]);
+            else if (a == "--duration" && i + 1 < argc) o.duration_s = std::stod(argv[++i]);
+            else if (a == "--ramp" && i + 1 < argc) o.ramp_s = std::stod(argv[++i]);
+            else if (a == "--threads" && i + 1 < argc) o.threads = std::stoi(argv[++i]);
+            else if (a == "--out" && i + 1 < argc) o.out = argv[++i];
+            else { usage(argv[0]); return (a == "--help" || a == "-h") ? 0 : 1; }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[ws_load] bad argument: " << e.what() << "\n";
+        return 1;
+    }
+    if (o.rounds.empty() || o.symbols.empty() || o.depths.empty() || o.push_ms.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    raise_fd_limit(*std::max_element(o.rounds.begin(), o.rounds.end()) + 64);
+
+    std::filesystem::path op(o.out);
+    std::error_code ec;
+    if (op.has_parent_path()) std::filesystem::create_directories(op.parent_path(), ec);
+    std::ofstream ofs(o.out, std::ios::binary | std::ios::app);
+    if (!ofs) {
+        std::cerr << "[ws_load] failed to open output: " << o.out << "\n";
+        return 1;
+    }
+
+    std::cout << "WS load test -> ws://" << o.host << ":" << o.port << o.path << "\n"
+              << "Results will be written to: " << o.out << "\n";
+    for (int n : o.rounds) {
+        try {
+            ofs << run_round(o, n) << "\n";
+            ofs.flush();
+        } catch (const std::exception& e) {
+            std::cerr << "[ws_load] round " << n << " failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}